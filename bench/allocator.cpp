@@ -0,0 +1,140 @@
+#include "allocator.h"
+#include "hash.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// replays the allocations imgui makes in a frame, vectors growing by
+// doubling and mostly thrown away at the end of the frame, through malloc
+// and through the allocator
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Allocator {
+        void *(*alloc)(size_t);
+        void (*free)(void*);
+    };
+
+    // returns how many allocations and frees it made
+    size_t replay(const Allocator& allocator, int frames, size_t vectorsPerFrame) {
+        struct Vector {
+            void *data = nullptr;
+            size_t capacity = 0;
+        };
+
+        size_t ops = 0;
+        std::vector<Vector> kept;
+        std::vector<Vector> frame(vectorsPerFrame);
+
+        for (int f = 0; f < frames; f++) {
+            for (size_t i = 0; i < vectorsPerFrame; i++) {
+                // mostly small, a few large ones like vertex buffers
+                uint32_t bits = mix32(uint32_t(f) * 7919u + uint32_t(i));
+                size_t size = (bits & 0xff) == 0 ? 16 * 1024 + (bits >> 16) : 8 + ((bits >> 8) & 0x3ff);
+
+                Vector& v = frame[i];
+                for (size_t capacity = 8; capacity < size; capacity *= 2) {
+                    void *data = allocator.alloc(capacity);
+                    if (v.data != nullptr) {
+                        std::memcpy(data, v.data, v.capacity);
+                        allocator.free(v.data);
+                    }
+                    v = { data, capacity };
+                    ops += 2;
+                }
+            }
+
+            // a few vectors outlive the frame, the way window state does
+            for (size_t i = 0; i < vectorsPerFrame; i++) {
+                if (mix32(uint32_t(i) ^ uint32_t(f) << 16) % 64 == 0) {
+                    kept.push_back(frame[i]);
+                } else {
+                    allocator.free(frame[i].data);
+                    ops += 1;
+                }
+                frame[i] = {};
+            }
+
+            if (kept.size() > 4096) {
+                for (size_t i = 0; i < kept.size(); i += 2) {
+                    allocator.free(kept[i].data);
+                    ops += 1;
+                    kept[i] = kept.back();
+                    kept.pop_back();
+                }
+            }
+        }
+
+        for (auto& v : kept) {
+            allocator.free(v.data);
+        }
+        return ops;
+    }
+
+    void report(const char *name, const Allocator& allocator, int frames, size_t vectors) {
+        auto start = Clock::now();
+        size_t ops = replay(allocator, frames, vectors);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::cout << name << ": " << seconds * 1000.0 / frames << " ms/frame, "
+                  << seconds / double(ops) * 1e9 << " ns/op" << std::endl;
+    }
+
+    // the font build: workers allocate and free at the same time as each
+    // other, and hand blocks to the main thread to free
+    void reportThreaded(int frames, size_t vectors, unsigned threadCount) {
+        Allocator pooled = { allocatorAlloc, allocatorFree };
+
+        std::vector<std::vector<void*>> handed(threadCount);
+        std::vector<size_t> ops(threadCount);
+        std::vector<std::thread> threads;
+
+        auto start = Clock::now();
+        for (unsigned t = 0; t < threadCount; t++) {
+            threads.emplace_back([&, t] {
+                ops[t] = replay(pooled, frames, vectors);
+                for (size_t i = 0; i < vectors; i++) {
+                    handed[t].push_back(allocatorAlloc(8 + (mix32(uint32_t(i)) & 0x3ff)));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        size_t total = 0;
+        for (unsigned t = 0; t < threadCount; t++) {
+            for (void *ptr : handed[t]) {
+                allocatorFree(ptr);
+            }
+            total += ops[t] + handed[t].size() * 2;
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::cout << "allocator x" << threadCount << " threads: " << seconds * 1000.0 / frames << " ms/frame, "
+                  << seconds / double(total) * 1e9 << " ns/op" << std::endl;
+    }
+}
+
+int main(int argc, const char **argv) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 1000;
+    size_t vectors = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000;
+
+    Allocator system = { std::malloc, std::free };
+    Allocator pooled = { allocatorAlloc, allocatorFree };
+
+    report("malloc", system, frames, vectors);
+    report("allocator", pooled, frames, vectors);
+    reportThreaded(frames / 4, vectors, 4);
+
+    AllocatorStats stats = allocatorStats();
+    size_t live = stats.tags[size_t(AllocTag::eOther)].liveCount;
+    std::cout << "allocator reserved " << double(stats.smallReserved + stats.heapReserved) / (1024.0 * 1024.0)
+              << " MB, " << live << " blocks still live" << std::endl;
+    return live == 0 ? 0 : 1;
+}
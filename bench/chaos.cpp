@@ -0,0 +1,52 @@
+#include "chaos.h"
+#include "parallel.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// compares the serial reference generator against the parallel walkers
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    template<typename F>
+    double measure(F&& fn) {
+        auto start = Clock::now();
+        fn();
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    void report(const char *name, size_t points, double seconds) {
+        std::cout << name << ": " << points << " points in " << seconds * 1000.0 << " ms ("
+                  << (double(points) / seconds) / 1e6 << " Mpoints/s)" << std::endl;
+    }
+}
+
+int main(int argc, const char **argv) {
+    size_t points = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+    unsigned threads = defaultThreadCount();
+
+    std::vector<Vertex2> reference;
+    double serial = measure([&] { reference = makeSierpinski(points, true); });
+    report("makeSierpinski", reference.size(), serial);
+
+    std::vector<Vertex2> first(points);
+    std::vector<Vertex2> second(points);
+
+    for (unsigned count : { 1u, threads }) {
+        ChaosParams params = { .seed = 1234, .threads = count, .blending = true };
+        double parallel = measure([&] { generateSierpinski(first, params); });
+
+        std::string name = "generateSierpinski x" + std::to_string(count);
+        report(name.c_str(), first.size(), parallel);
+
+        generateSierpinski(second, params);
+        if (std::memcmp(first.data(), second.data(), first.size() * sizeof(Vertex2)) != 0) {
+            std::cout << "Output differs between runs with " << count << " threads" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
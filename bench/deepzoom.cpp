@@ -0,0 +1,73 @@
+#include "chaos.h"
+#include "deepzoom.h"
+#include "hash.h"
+#include "parallel.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// deep zoom point throughput at increasing zoom against the float walkers
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    template<typename F>
+    double measure(F&& fn) {
+        auto start = Clock::now();
+        fn();
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // somewhere on the attractor to zoom in on, walked in doubles so it
+    // stays on it until about 1e14
+    Camera2D focus(std::span<const AffineMap> maps, double zoom) {
+        MapPicker picker(maps);
+        CounterStream stream = makeCounterStream(99, 0);
+
+        double x = 0.0, y = 0.0;
+        for (uint32_t i = 0; i < 1000; i++) {
+            const auto& map = maps[picker.pick(stream.at(i))];
+            double nx = map.a * x + map.b * y + map.e;
+            y = map.c * x + map.d * y + map.f;
+            x = nx;
+        }
+        return { x, y, zoom };
+    }
+}
+
+int main(int argc, const char **argv) {
+    size_t points = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+    unsigned threads = defaultThreadCount();
+
+    std::vector<Vertex2> first(points);
+    std::vector<Vertex2> second(points);
+
+    ChaosParams params = { .seed = 1234, .threads = threads, .blending = true };
+    double baseline = measure([&] { generateSierpinski(first, params); });
+    std::cout << "generateSierpinski x" << threads << ": " << points << " points in " << baseline * 1000.0 << " ms ("
+              << (double(points) / baseline) / 1e6 << " Mpoints/s)" << std::endl;
+
+    for (const auto& preset : ifsPresets()) {
+        for (double zoom : { 1.0, 1e4, 1e8, 1e12 }) {
+            Camera2D camera = focus(preset.maps, zoom);
+
+            std::vector<DeepCell> cells;
+            size_t kept = 0;
+            double find = measure([&] { cells = findDeepCells(preset.maps, camera); });
+            double generate = measure([&] { kept = generateDeepPoints(first, preset.maps, cells, params); });
+
+            std::cout << preset.name << " at " << zoom << "x: " << cells.size() << " cells in " << find * 1000.0
+                      << " ms, " << kept << " of " << points << " points on screen in " << generate * 1000.0 << " ms ("
+                      << (double(points) / generate) / 1e6 << " Mpoints/s)" << std::endl;
+
+            size_t again = generateDeepPoints(second, preset.maps, cells, params);
+            if (again != kept || std::memcmp(first.data(), second.data(), kept * sizeof(Vertex2)) != 0) {
+                std::cout << "Output differs between runs at " << zoom << "x" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
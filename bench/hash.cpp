@@ -0,0 +1,187 @@
+#include "hash.h"
+
+#include "imgui/imgui.h"
+#include "imgui/imgui_internal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// ImHashStr and ImHashData against the byte at a time crc they replaced,
+// over labels of a few lengths, with and without a ### in them. every id
+// is checked against the old code first since saved state depends on them.
+// then literal labels hashed at compile time against ImHashStr on the same
+// labels
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // the crc table imgui builds the others from, reconstructed so the old
+    // loop can run here
+    struct Crc32Table {
+        uint32_t entries[256];
+
+        Crc32Table() {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; bit++) {
+                    crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+                }
+                entries[i] = crc;
+            }
+        }
+    };
+
+    const Crc32Table gTable;
+
+    // what ImHashStr was, one byte and one table lookup at a time
+    ImGuiID oldHashStr(const char *str, size_t size, ImGuiID seed) {
+        seed = ~seed;
+        uint32_t crc = seed;
+        const auto *data = reinterpret_cast<const unsigned char*>(str);
+        if (size != 0) {
+            while (size-- != 0) {
+                unsigned char c = *data++;
+                if (c == '#' && size >= 2 && data[0] == '#' && data[1] == '#') {
+                    crc = seed;
+                }
+                crc = (crc >> 8) ^ gTable.entries[(crc & 0xff) ^ c];
+            }
+        } else {
+            while (unsigned char c = *data++) {
+                if (c == '#' && data[0] == '#' && data[1] == '#') {
+                    crc = seed;
+                }
+                crc = (crc >> 8) ^ gTable.entries[(crc & 0xff) ^ c];
+            }
+        }
+        return ~crc;
+    }
+
+    ImGuiID oldHashData(const void *bytes, size_t size, ImGuiID seed) {
+        uint32_t crc = ~seed;
+        const auto *data = static_cast<const unsigned char*>(bytes);
+        while (size-- != 0) {
+            crc = (crc >> 8) ^ gTable.entries[(crc & 0xff) ^ *data++];
+        }
+        return ~crc;
+    }
+
+    // ImHashStr and ImHashData are in imgui.cpp and never inlined into the
+    // loops below, the old code is called through pointers the compiler
+    // cant see through so both are timed the same way
+    using HashStrFunc = ImGuiID (*)(const char*, size_t, ImGuiID);
+    using HashDataFunc = ImGuiID (*)(const void*, size_t, ImGuiID);
+    HashStrFunc volatile gOldHashStr = oldHashStr;
+    HashDataFunc volatile gOldHashData = oldHashData;
+
+    // labels like the ones widgets hash, letters, digits and spaces
+    std::vector<std::string> makeLabels(size_t count, size_t length, bool tripleHash) {
+        static const char kAlphabet[] = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+        std::vector<std::string> labels(count);
+        for (size_t i = 0; i < count; i++) {
+            std::string& label = labels[i];
+            for (size_t c = 0; c < length; c++) {
+                label += kAlphabet[mix32(uint32_t(i * 131 + c)) % (sizeof(kAlphabet) - 1)];
+            }
+            if (tripleHash && length >= 6) {
+                label.replace(length / 2, 3, "###");
+            }
+        }
+        return labels;
+    }
+
+    volatile ImGuiID gSink = 0;
+
+    // the best of a few rounds, short hashes are easily drowned out by noise
+    template<typename F>
+    double nanosecondsPer(size_t count, int repeats, F&& fn) {
+        double best = 0.0;
+        for (int round = 0; round < 5; round++) {
+            auto start = Clock::now();
+            for (int r = 0; r < repeats; r++) {
+                fn();
+            }
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / double(count * size_t(repeats));
+            best = round == 0 ? ns : std::min(best, ns);
+        }
+        return best;
+    }
+
+    // the sort of labels widgets are given as literals
+    constexpr ImGuiLiteralID kLiterals[] = {
+        "OK", "Cancel", "Restart", "Reset View", "Export CSV", "Export Trace",
+        "Settings##panel", "Profiler", "Show Overlay", "Background Colour",
+        "Label###fixed", "##hidden", "###", "####", "a ### b ### c",
+        "Iterations per frame", "A label long enough to take a few blocks of eight"
+    };
+
+    bool runLiterals() {
+        constexpr size_t kCount = sizeof(kLiterals) / sizeof(kLiterals[0]);
+
+        for (const auto& lit : kLiterals) {
+            for (ImGuiID seed : { 0u, 1u, 0xffffffffu, mix32(uint32_t(lit.HashedLen)) }) {
+                if (ImHashLiteral(lit, seed) != ImHashStr(lit.Str, 0, seed)) {
+                    std::cout << "Literal hash mismatch for \"" << lit.Str << "\"" << std::endl;
+                    return false;
+                }
+            }
+        }
+
+        // seeds vary like the id stack does, so nothing gets hoisted out
+        constexpr int kRepeats = 20'000;
+        ImGuiID sum = 0;
+        double str = nanosecondsPer(kCount, kRepeats, [&] { for (const auto& lit : kLiterals) { sum = ImHashStr(lit.Str, 0, sum); } });
+        double literal = nanosecondsPer(kCount, kRepeats, [&] { for (const auto& lit : kLiterals) { sum = ImHashLiteral(lit, sum); } });
+        gSink = sum;
+
+        std::cout << "literal labels, ns/hash at runtime vs compile time: " << str << " / " << literal << std::endl;
+        return true;
+    }
+
+    bool run(size_t length, bool tripleHash) {
+        constexpr size_t kLabels = 4096;
+        auto labels = makeLabels(kLabels, length, tripleHash);
+
+        for (const auto& label : labels) {
+            ImGuiID seed = mix32(uint32_t(label.size()));
+            if (ImHashStr(label.c_str(), 0, seed) != oldHashStr(label.c_str(), 0, seed)
+                || ImHashStr(label.c_str(), label.size(), seed) != oldHashStr(label.c_str(), label.size(), seed)
+                || ImHashData(label.data(), label.size(), seed) != oldHashData(label.data(), label.size(), seed)) {
+                std::cout << "Hash mismatch for \"" << label << "\"" << std::endl;
+                return false;
+            }
+        }
+
+        int repeats = int(std::max<size_t>(1, 4'000'000 / (kLabels * (length + 8))));
+        ImGuiID sum = 0;
+        HashStrFunc oldStrFunc = gOldHashStr;
+        HashDataFunc oldDataFunc = gOldHashData;
+        double oldStr = nanosecondsPer(kLabels, repeats, [&] { for (const auto& label : labels) { sum += oldStrFunc(label.c_str(), 0, 0); } });
+        double newStr = nanosecondsPer(kLabels, repeats, [&] { for (const auto& label : labels) { sum += ImHashStr(label.c_str(), 0, 0); } });
+        double oldData = nanosecondsPer(kLabels, repeats, [&] { for (const auto& label : labels) { sum += oldDataFunc(label.data(), label.size(), 0); } });
+        double newData = nanosecondsPer(kLabels, repeats, [&] { for (const auto& label : labels) { sum += ImHashData(label.data(), label.size(), 0); } });
+        gSink = sum;
+
+        std::cout << length << " bytes" << (tripleHash ? " with ###" : "") << ", ns/hash old vs new:"
+                  << " str " << oldStr << " / " << newStr
+                  << ", data " << oldData << " / " << newData
+                  << ", " << double(length) / newData << " GB/s" << std::endl;
+        return true;
+    }
+}
+
+int main() {
+    for (size_t length : { 2, 4, 8, 12, 16, 32, 64, 256, 4096 }) {
+        if (!run(length, false)) { return 1; }
+    }
+    for (size_t length : { 12, 16, 64 }) {
+        if (!run(length, true)) { return 1; }
+    }
+    if (!runLiterals()) { return 1; }
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "ifs.h"
+#include "parallel.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// histogram accumulation and tonemapping throughput for every preset
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    template<typename F>
+    double measure(F&& fn) {
+        auto start = Clock::now();
+        fn();
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    constexpr unsigned kWidth = 1024;
+    constexpr unsigned kHeight = 768;
+}
+
+int main(int argc, const char **argv) {
+    uint64_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50'000'000;
+    unsigned threads = defaultThreadCount();
+
+    std::vector<Rgba8> image(size_t(kWidth) * kHeight);
+
+    for (const auto& preset : ifsPresets()) {
+        auto bounds = ifsBounds(preset.maps, float(kWidth) / float(kHeight));
+
+        for (unsigned count : { 1u, threads }) {
+            IfsHistogram first(kWidth, kHeight);
+            IfsHistogram second(kWidth, kHeight);
+            first.reset(preset.maps, bounds, 1234);
+            second.reset(preset.maps, bounds, 1234);
+
+            double accumulate = measure([&] { first.accumulate(iterations, count); });
+            double tonemap = measure([&] { first.tonemap(image, 2.2f, count); });
+
+            std::cout << preset.name << " x" << count << ": " << first.iterations() << " iterations in "
+                      << accumulate * 1000.0 << " ms (" << (double(first.iterations()) / accumulate) / 1e6
+                      << " Miterations/s), tonemap " << tonemap * 1000.0 << " ms" << std::endl;
+
+            second.accumulate(iterations, count);
+            auto lhs = first.bins();
+            auto rhs = second.bins();
+            if (std::memcmp(lhs.data(), rhs.data(), lhs.size_bytes()) != 0) {
+                std::cout << "Histogram differs between runs with " << count << " threads" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
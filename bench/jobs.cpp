@@ -0,0 +1,145 @@
+#include "hash.h"
+#include "jobs.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// what the job system costs per job and per parallelFor, and how a compute
+// bound loop scales from one thread up to 64
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    template<typename F>
+    double measure(F&& fn) {
+        auto start = Clock::now();
+        fn();
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // the best of a few runs, the first one pays for waking the workers
+    template<typename F>
+    double best(int runs, F&& fn) {
+        double seconds = measure(fn);
+        for (int i = 1; i < runs; i++) {
+            seconds = std::min(seconds, measure(fn));
+        }
+        return seconds;
+    }
+
+    // spawns from one thread and waits, everything else has to steal
+    double spawnEmpty(JobSystem& jobs, size_t count) {
+        std::vector<Job> queued(count);
+        return best(5, [&] {
+            JobCounter counter;
+            for (auto& job : queued) {
+                job = { [](void*) { }, nullptr };
+                jobs.spawn(job, counter);
+            }
+            jobs.wait(counter);
+        });
+    }
+
+    // the same split as the old parallelFor, a fresh thread per chunk every call
+    template<typename F>
+    void threadPerChunk(size_t count, unsigned threads, F&& fn) {
+        std::vector<std::jthread> workers;
+        for (unsigned chunk = 1; chunk < threads; chunk++) {
+            workers.emplace_back([&fn, chunk, count, threads] { fn(count * chunk / threads, count * (chunk + 1) / threads); });
+        }
+        fn(0, count / threads);
+    }
+
+    uint64_t hashRange(size_t begin, size_t end) {
+        uint64_t sum = 0;
+        for (size_t i = begin; i < end; i++) {
+            sum += mix64(i);
+        }
+        return sum;
+    }
+
+    // fork join all the way down, most jobs get stolen at least once
+    struct Fib {
+        JobSystem *jobs;
+        unsigned n;
+        uint64_t result = 0;
+
+        static void run(void *data) {
+            auto *it = static_cast<Fib*>(data);
+            it->result = it->compute();
+        }
+
+        uint64_t compute() {
+            if (n < 12) { return serial(n); }
+
+            Fib left = { jobs, n - 1 };
+            Job job = { &Fib::run, &left };
+            JobCounter counter;
+            jobs->spawn(job, counter);
+
+            Fib right = { jobs, n - 2 };
+            uint64_t sum = right.compute();
+            jobs->wait(counter);
+            return sum + left.result;
+        }
+
+        static uint64_t serial(unsigned n) {
+            return n < 2 ? n : serial(n - 1) + serial(n - 2);
+        }
+    };
+}
+
+int main(int argc, const char **argv) {
+    unsigned maxThreads = argc > 1 ? unsigned(std::atoi(argv[1])) : 64;
+    size_t work = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 64'000'000;
+
+    std::cout << defaultThreadCount() << " hardware threads" << std::endl;
+
+    uint64_t expected = 0;
+    double serial = best(3, [&] { expected = hashRange(0, work); });
+    std::cout << "serial: " << serial * 1000.0 << " ms" << std::endl;
+
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        JobSystem jobs(threads);
+        std::cout << "x" << threads << std::endl;
+
+        // scheduling overhead
+        constexpr size_t kJobs = 100'000;
+        double spawn = spawnEmpty(jobs, kJobs);
+        std::cout << "  spawn + wait: " << spawn / kJobs * 1e9 << " ns/job" << std::endl;
+
+        constexpr size_t kEmpty = 1'000'000;
+        double empty = best(5, [&] { jobs.parallelFor(kEmpty, [](size_t, size_t) { }); });
+        double spawned = best(5, [&] { threadPerChunk(kEmpty, threads, [](size_t, size_t) { }); });
+        std::cout << "  empty parallelFor: " << empty * 1e6 << " us, a thread per chunk: " << spawned * 1e6 << " us" << std::endl;
+
+        // scaling
+        std::atomic<uint64_t> sum = 0;
+        double hashed = best(3, [&] {
+            sum = 0;
+            jobs.parallelFor(work, [&](size_t begin, size_t end) {
+                sum.fetch_add(hashRange(begin, end), std::memory_order_relaxed);
+            });
+        });
+        if (sum != expected) {
+            std::cout << "parallelFor skipped or repeated part of the range with " << threads << " threads" << std::endl;
+            return 1;
+        }
+        std::cout << "  hash " << work << ": " << hashed * 1000.0 << " ms, " << serial / hashed << "x serial" << std::endl;
+
+        uint64_t stealsBefore = jobs.steals();
+        Fib fib = { &jobs, 30 };
+        double forked = best(3, [&] { fib.result = fib.compute(); });
+        if (fib.result != Fib::serial(30)) {
+            std::cout << "fork join got the wrong answer with " << threads << " threads" << std::endl;
+            return 1;
+        }
+        std::cout << "  fib(30) fork join: " << forked * 1000.0 << " ms, " << jobs.steals() - stealsBefore << " steals" << std::endl;
+    }
+
+    return 0;
+}
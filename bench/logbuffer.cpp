@@ -0,0 +1,118 @@
+#include "hash.h"
+#include "logbuffer.h"
+
+#include "imgui/imgui.h"
+#include "imgui/imgui_internal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// appending a 1 GB log line by line, LogBuffer against the ImGuiTextBuffer
+// and ImGuiTextIndex pair a log window would otherwise keep. reports the
+// cost of each 128 MB as the log grows and the single slowest append, then
+// random line lookups, then the same again spilling to a file
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t kWindow = 128ull << 20;
+    constexpr size_t kWindows = 8;
+    constexpr const char *kSpillPath = "bench-logbuffer.spill";
+
+    struct Appended {
+        std::vector<double> windowMs;
+        double slowestUs = 0.0;
+        size_t lines = 0;
+    };
+
+    template<typename F>
+    Appended appendLog(F&& append) {
+        Appended result;
+        uint32_t i = 0;
+        uint64_t bytes = 0;
+        for (size_t window = 0; window < kWindows; window++) {
+            auto start = Clock::now();
+            while (bytes < (window + 1) * kWindow) {
+                auto before = Clock::now();
+                bytes += append(i, mix32(i));
+                double us = std::chrono::duration<double, std::micro>(Clock::now() - before).count();
+                result.slowestUs = std::max(result.slowestUs, us);
+                i++;
+            }
+            result.windowMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        result.lines = i;
+        return result;
+    }
+
+    void report(const char *name, const Appended& appended) {
+        std::cout << name << ", ms per 128 MB:";
+        for (double ms : appended.windowMs) {
+            std::cout << " " << ms;
+        }
+        std::cout << ", slowest append " << appended.slowestUs << " us" << std::endl;
+    }
+
+    // random lines, the way a clipper jumps around a scrolled log
+    template<typename F>
+    double nanosecondsPerLookup(size_t lines, F&& lookup) {
+        constexpr size_t kLookups = 1'000'000;
+        size_t sum = 0;
+        auto start = Clock::now();
+        for (size_t i = 0; i < kLookups; i++) {
+            sum += lookup(mix32(uint32_t(i)) % lines);
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / double(kLookups);
+        return sum == 0 ? 0.0 : ns;
+    }
+
+    void runLogBuffer(bool spill) {
+        LogBuffer log;
+        if (spill && !log.spillTo(kSpillPath, 4)) {
+            std::cout << "Failed to create " << kSpillPath << std::endl;
+            std::exit(1);
+        }
+
+        Appended appended = appendLog([&](uint32_t i, uint32_t r) {
+            uint64_t before = log.size();
+            log.appendf("[%u] frame %u took %.3f ms, %u points streamed\n", i / 60, i, double(r % 20000) / 1000.0, r);
+            return log.size() - before;
+        });
+
+        report(spill ? "LogBuffer spilling" : "LogBuffer", appended);
+        double ns = nanosecondsPerLookup(log.lineCount(), [&](size_t line) { return log.line(line).size(); });
+        std::cout << "  " << log.lineCount() << " lines, " << ns << " ns per random line, "
+                  << log.residentChunkCount() << " of " << log.chunkCount() << " chunks resident" << std::endl;
+    }
+
+    void runTextBuffer() {
+        ImGuiTextBuffer buffer;
+        ImGuiTextIndex index;
+
+        Appended appended = appendLog([&](uint32_t i, uint32_t r) {
+            int before = buffer.size();
+            buffer.appendf("[%u] frame %u took %.3f ms, %u points streamed\n", i / 60, i, double(r % 20000) / 1000.0, r);
+            index.append(buffer.begin(), before, buffer.size());
+            return uint64_t(buffer.size() - before);
+        });
+
+        report("ImGuiTextBuffer", appended);
+        double ns = nanosecondsPerLookup(size_t(index.size()), [&](size_t line) {
+            return size_t(index.get_line_end(buffer.begin(), int(line)) - index.get_line_begin(buffer.begin(), int(line)));
+        });
+        std::cout << "  " << index.size() << " lines, " << ns << " ns per random line, "
+                  << buffer.Buf.Capacity / (1 << 20) << " MB reserved" << std::endl;
+    }
+}
+
+int main() {
+    runTextBuffer();
+    runLogBuffer(false);
+    runLogBuffer(true);
+    std::remove(kSpillPath);
+    return 0;
+}
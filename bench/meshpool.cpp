@@ -0,0 +1,186 @@
+#include "hash.h"
+#include "headless.h"
+#include "meshpool.h"
+#include "program.h"
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// thousands of small meshes, each a Mesh of its own against handles out of
+// one MeshPool that starts small enough to grow many times. both are drawn
+// one mesh at a time and the pool with a single multi draw. then frames of
+// churn replace a tenth of the handles each, their memory coming back
+// through endFrame's fences, and once every handle is dropped the buddy
+// allocators have to have merged back into one free block each
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t kMeshes = 5000;
+    constexpr int kDrawFrames = 50;
+    constexpr int kChurnFrames = 200;
+
+    constexpr const char *kVertexShader = R"(#version 330 core
+        layout (location = 0) in vec3 aPos;
+        void main() { gl_Position = vec4(aPos, 1.0); }
+    )";
+
+    constexpr const char *kFragmentShader = R"(#version 330 core
+        out vec4 colour;
+        void main() { colour = vec4(1.0); }
+    )";
+
+    // a fan of 3 to 66 vertices somewhere on screen
+    struct Shape {
+        std::vector<Vertex2> vertices;
+        std::vector<unsigned> indices;
+    };
+
+    Shape makeShape(uint32_t seed) {
+        uint32_t bits = mix32(seed);
+        unsigned count = 3 + bits % 64;
+        float x = float((bits >> 8) & 0xff) / 128.f - 1.f;
+        float y = float((bits >> 16) & 0xff) / 128.f - 1.f;
+
+        Shape shape;
+        for (unsigned i = 0; i < count; i++) {
+            float angle = float(i) * 6.2831853f / float(count);
+            shape.vertices.push_back({ { x + 0.01f * std::cos(angle), y + 0.01f * std::sin(angle), 0.f }, { 1.f, 1.f, 1.f } });
+        }
+        for (unsigned i = 1; i + 1 < count; i++) {
+            shape.indices.insert(shape.indices.end(), { 0, i, i + 1 });
+        }
+        return shape;
+    }
+
+    double millisecondsSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // each frame waits for the gpu, so the times include the driver's work
+    template<typename F>
+    double millisecondsPerFrame(F&& draw) {
+        glFinish();
+        auto start = Clock::now();
+        for (int frame = 0; frame < kDrawFrames; frame++) {
+            draw();
+            glFinish();
+        }
+        return millisecondsSince(start) / kDrawFrames;
+    }
+
+    void runMeshes(const std::vector<Shape>& shapes) {
+        auto start = Clock::now();
+        std::vector<Mesh> meshes;
+        meshes.reserve(shapes.size());
+        for (const auto& shape : shapes) {
+            meshes.emplace_back(shape.vertices, shape.indices);
+        }
+        double createMs = millisecondsSince(start);
+
+        double drawMs = millisecondsPerFrame([&] {
+            for (auto& mesh : meshes) {
+                mesh.bind();
+                mesh.draw(Primitive::eTriangles);
+            }
+        });
+
+        std::cout << "Mesh each: " << createMs << " ms to create, " << drawMs << " ms per frame" << std::endl;
+    }
+
+    bool runPool(const std::vector<Shape>& shapes) {
+        MeshPool pool(kVertexLayout<Vertex2>, 1024, 1024);
+        size_t startCapacity = pool.vertexSpace().capacity();
+
+        auto start = Clock::now();
+        std::vector<MeshHandle> handles;
+        for (const auto& shape : shapes) {
+            handles.push_back(pool.create(shape.vertices, shape.indices));
+        }
+        double createMs = millisecondsSince(start);
+
+        pool.bind();
+        double eachMs = millisecondsPerFrame([&] {
+            for (const auto& handle : handles) {
+                pool.draw(handle, Primitive::eTriangles);
+            }
+        });
+        double multiMs = millisecondsPerFrame([&] { pool.draw(handles, Primitive::eTriangles); });
+
+        std::cout << "MeshPool: " << createMs << " ms to create growing from " << startCapacity << " to "
+                  << pool.vertexSpace().capacity() << " vertices, ms per frame one at a time / multi draw: "
+                  << eachMs << " / " << multiMs << std::endl;
+
+        // frees only come back once the frame they were made in is done
+        size_t mostPending = 0;
+        start = Clock::now();
+        for (int frame = 0; frame < kChurnFrames; frame++) {
+            for (size_t i = 0; i < handles.size() / 10; i++) {
+                uint32_t r = mix32(uint32_t(frame) * 7919u + uint32_t(i));
+                const Shape& shape = shapes[(r >> 8) % shapes.size()];
+                handles[r % handles.size()] = pool.create(shape.vertices, shape.indices);
+            }
+            pool.draw(handles, Primitive::eTriangles);
+            pool.endFrame();
+            mostPending = std::max(mostPending, pool.pendingFrameCount());
+        }
+        double churnMs = millisecondsSince(start) / kChurnFrames;
+
+        std::cout << "  replacing " << handles.size() / 10 << " meshes a frame: " << churnMs << " ms per frame, up to "
+                  << mostPending << " frames of frees waiting on fences, " << pool.vertexSpace().capacity() << " vertices" << std::endl;
+
+        handles.clear();
+        pool.endFrame();
+        glFinish();
+        pool.endFrame();
+
+        const BuddyAllocator& vertices = pool.vertexSpace();
+        const BuddyAllocator& indices = pool.indexSpace();
+        if (pool.pendingFrameCount() != 0 || vertices.used() != 0 || indices.used() != 0
+            || vertices.freeBlockCount() != 1 || indices.freeBlockCount() != 1) {
+            std::cout << "Pool didnt merge back together: " << pool.pendingFrameCount() << " frames pending, "
+                      << vertices.used() << " vertices and " << indices.used() << " indices used, "
+                      << vertices.freeBlockCount() << " and " << indices.freeBlockCount() << " free blocks" << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+int main() {
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow *window = createHeadlessWindow(64, 64);
+    if (window == nullptr) {
+        std::cout << "Failed to create a headless context" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    unsigned program = createShader(kVertexShader, kFragmentShader);
+    glUseProgram(program);
+    glEnable(GL_RASTERIZER_DISCARD);
+
+    std::vector<Shape> shapes;
+    for (size_t i = 0; i < kMeshes; i++) {
+        shapes.push_back(makeShape(uint32_t(i)));
+    }
+
+    runMeshes(shapes);
+    bool merged = runPool(shapes);
+
+    glDeleteProgram(program);
+    destroyHeadlessWindow(window);
+    glfwTerminate();
+    return merged ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+#include "noise.h"
+#include "parallel.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// compares baked noise against the scalar reference, both for speed and for
+// how closely the simd approximations track it
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // the simd path uses polynomial sin and cos, this is well above their error
+    constexpr float kTolerance = 1e-3f;
+
+    template<typename F>
+    double measure(F&& fn) {
+        auto start = Clock::now();
+        fn();
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    void report(const char *name, const NoiseParams& params, double seconds) {
+        double megapixels = double(params.width) * params.height / 1e6;
+        std::cout << "  " << name << ": " << seconds * 1000.0 << " ms (" << megapixels / seconds << " MP/s)" << std::endl;
+    }
+
+    bool run(const char *name, NoiseParams params) {
+        std::cout << name << " " << params.width << "x" << params.height << std::endl;
+
+        size_t texels = size_t(params.width) * params.height;
+        std::vector<float> reference(texels);
+        std::vector<float> baked(texels);
+
+        double scalar = measure([&] {
+            for (unsigned y = 0; y < params.height; y++) {
+                for (unsigned x = 0; x < params.width; x++) {
+                    reference[size_t(y) * params.width + x] = referenceNoise(params, x, y);
+                }
+            }
+        });
+        report("reference", params, scalar);
+
+        // sse2 always, avx2 as well when this build and cpu have it
+        bool ok = true;
+        for (bool avx2 : { false, true }) {
+            if (avx2 && !noiseAvx2Supported()) {
+                std::cout << "  avx2: not supported here" << std::endl;
+                continue;
+            }
+
+            params.avx2 = avx2;
+            const char *kernels = avx2 ? "avx2" : "sse2";
+
+            unsigned threads = defaultThreadCount();
+            for (unsigned count : { 1u, threads }) {
+                params.threads = count;
+                double seconds = measure([&] { bakeNoise(baked, params); });
+
+                std::string label = std::string(kernels) + " x" + std::to_string(count);
+                report(label.c_str(), params, seconds);
+            }
+
+            float maxError = 0.f;
+            for (size_t i = 0; i < texels; i++) {
+                maxError = std::max(maxError, std::abs(baked[i] - reference[i]));
+            }
+
+            std::cout << "  " << kernels << " max error: " << maxError << std::endl;
+            if (maxError > kTolerance) {
+                std::cout << "  " << kernels << " noise differs from the reference by more than " << kTolerance << std::endl;
+                ok = false;
+            }
+        }
+
+        return ok;
+    }
+
+    // the lattice should wrap exactly at the period
+    bool checkTiling() {
+        constexpr int kPeriod = 8;
+        for (float y = 0.05f; y < float(kPeriod); y += 0.37f) {
+            for (float x = 0.05f; x < float(kPeriod); x += 0.41f) {
+                float a = perlinNoise(x, y, kPeriod);
+                float b = perlinNoise(x + kPeriod, y - kPeriod, kPeriod);
+                if (std::abs(a - b) > 1e-4f) {
+                    std::cout << "perlin noise does not tile at (" << x << ", " << y << ")" << std::endl;
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, const char **argv) {
+    unsigned size = argc > 1 ? unsigned(std::strtoul(argv[1], nullptr, 10)) : 1024;
+
+    bool ok = checkTiling();
+
+    ok &= run("shader", { .kind = NoiseKind::eShader, .width = size, .height = size });
+    ok &= run("perlin", { .kind = NoiseKind::ePerlin, .width = size, .height = size, .frequency = 16.f, .tileable = true });
+    ok &= run("fbm", { .kind = NoiseKind::eFbm, .width = size, .height = size, .frequency = 8.f, .tileable = true });
+
+    // odd sizes exercise the partial vectors at the end of each row
+    ok &= run("shader", { .kind = NoiseKind::eShader, .width = 333, .height = 77 });
+
+    return ok ? 0 : 1;
+}
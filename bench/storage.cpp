@@ -0,0 +1,120 @@
+#include "hash.h"
+
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// ImGuiStorage against the sorted vector it used to be, at the sizes tree
+// heavy windows reach. both are filled in one go with BuildSortByKey, then
+// timed on lookups that hit, lookups that miss and inserting new keys into
+// the full storage. the sorted vector is left out of removal since it never
+// had any
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // what ImGuiStorage was, binary search over pairs sorted by key
+    struct SortedStorage {
+        std::vector<ImGuiStorage::ImGuiStoragePair> data;
+
+        ImGuiStorage::ImGuiStoragePair *lowerBound(ImGuiID key) {
+            ImGuiStorage::ImGuiStoragePair *first = data.data();
+            size_t count = data.size();
+            while (count > 0) {
+                size_t half = count >> 1;
+                ImGuiStorage::ImGuiStoragePair *mid = first + half;
+                if (mid->key < key) {
+                    first = mid + 1;
+                    count -= half + 1;
+                } else {
+                    count = half;
+                }
+            }
+            return first;
+        }
+
+        int getInt(ImGuiID key, int fallback) {
+            auto *it = lowerBound(key);
+            if (it == data.data() + data.size() || it->key != key) { return fallback; }
+            return it->val_i;
+        }
+
+        void setInt(ImGuiID key, int value) {
+            auto *it = lowerBound(key);
+            if (it == data.data() + data.size() || it->key != key) {
+                data.insert(data.begin() + (it - data.data()), ImGuiStorage::ImGuiStoragePair(key, value));
+                return;
+            }
+            it->val_i = value;
+        }
+    };
+
+    constexpr size_t kInserts = 1000;
+
+    // keeps the lookups from being optimised away
+    volatile long gSink = 0;
+
+    // tree node ids, stored keys are even and missing ones odd so the two never collide
+    ImGuiID storedKey(size_t i) { return mix32(uint32_t(i)) & ~1u; }
+    ImGuiID missingKey(size_t i) { return mix32(uint32_t(i) + 0x9e3779b9u) | 1u; }
+
+    template<typename F>
+    double nanosecondsPer(size_t count, F&& fn) {
+        auto start = Clock::now();
+        fn();
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / double(count);
+    }
+
+    void run(size_t base) {
+        size_t count = base + kInserts;
+
+        ImGuiStorage storage;
+        SortedStorage sorted;
+        for (size_t i = 0; i < base; i++) {
+            storage.Data.push_back(ImGuiStorage::ImGuiStoragePair(storedKey(i), int(i)));
+        }
+        sorted.data.assign(storage.Data.begin(), storage.Data.end());
+        storage.BuildSortByKey();
+        std::sort(sorted.data.begin(), sorted.data.end(), [](const auto& lhs, const auto& rhs) { return lhs.key < rhs.key; });
+
+        // queries in a different order to the keys so neither gets a cache friendly walk
+        std::vector<ImGuiID> hits(base);
+        for (size_t i = 0; i < base; i++) {
+            hits[i] = storedKey(mix32(uint32_t(i) ^ 0x5bd1e995u) % base);
+        }
+
+        long sum = 0;
+        double hashHit = nanosecondsPer(base, [&] { for (ImGuiID key : hits) { sum += storage.GetInt(key, -1); } });
+        double sortedHit = nanosecondsPer(base, [&] { for (ImGuiID key : hits) { sum += sorted.getInt(key, -1); } });
+        double hashMiss = nanosecondsPer(base, [&] { for (size_t i = 0; i < base; i++) { sum += storage.GetInt(missingKey(i), -1); } });
+        double sortedMiss = nanosecondsPer(base, [&] { for (size_t i = 0; i < base; i++) { sum += sorted.getInt(missingKey(i), -1); } });
+
+        double hashInsert = nanosecondsPer(kInserts, [&] { for (size_t i = base; i < count; i++) { storage.SetInt(storedKey(i), int(i)); } });
+        double sortedInsert = nanosecondsPer(kInserts, [&] { for (size_t i = base; i < count; i++) { sorted.setInt(storedKey(i), int(i)); } });
+        double hashRemove = nanosecondsPer(kInserts, [&] { for (size_t i = base; i < count; i++) { sum += storage.Remove(storedKey(i)); } });
+
+        // building from empty one key at a time, the way windows fill up
+        ImGuiStorage grown;
+        double hashBuild = nanosecondsPer(count, [&] { for (size_t i = 0; i < count; i++) { grown.SetInt(storedKey(i), int(i)); } });
+
+        gSink = sum;
+
+        std::cout << base << " keys, ns/op hashed vs sorted:"
+                  << " hit " << hashHit << " / " << sortedHit
+                  << ", miss " << hashMiss << " / " << sortedMiss
+                  << ", insert " << hashInsert << " / " << sortedInsert
+                  << ", remove " << hashRemove
+                  << ", build from empty " << hashBuild << std::endl;
+    }
+}
+
+int main() {
+    for (size_t count : { 1'000, 100'000, 1'000'000 }) {
+        run(count);
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include "headless.h"
+#include "mesh.h"
+#include "program.h"
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// streams n MB of vertices a frame the ways Mesh used to and through
+// DynamicMesh. every frame draws what it wrote so the gpu really reads it,
+// with rasterisation off so fill rate stays out of the numbers
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr const char *kVertexShader = R"(#version 330 core
+        layout (location = 0) in vec3 aPos;
+        void main() { gl_Position = vec4(aPos, 1.0); }
+    )";
+
+    constexpr const char *kFragmentShader = R"(#version 330 core
+        out vec4 colour;
+        void main() { colour = vec4(1.0); }
+    )";
+
+    struct Result {
+        double seconds;
+        size_t stalls = 0;
+        size_t orphans = 0;
+    };
+
+    // the old way, fresh storage from glBufferData or an overwrite with glBufferSubData
+    template<typename F>
+    Result streamBuffer(std::span<const Vertex2> vertices, int frames, F&& upload) {
+        unsigned vao = 0, vbo = 0;
+        glGenVertexArrays(1, &vao);
+        glBindVertexArray(vao);
+        glGenBuffers(1, &vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(vertices.size_bytes()), nullptr, GL_STREAM_DRAW);
+        setupAttribs(kVertexLayout<Vertex2>);
+        glFinish();
+
+        auto start = Clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            upload(vertices);
+            glDrawArrays(GL_POINTS, 0, GLsizei(vertices.size()));
+        }
+        glFinish();
+        Result result = { std::chrono::duration<double>(Clock::now() - start).count() };
+
+        glDeleteBuffers(1, &vbo);
+        glDeleteVertexArrays(1, &vao);
+        return result;
+    }
+
+    Result streamDynamic(std::span<const Vertex2> vertices, int frames, StreamMode mode) {
+        DynamicMesh mesh(kVertexLayout<Vertex2>, vertices.size(), mode);
+        glFinish();
+
+        auto start = Clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            auto mapped = mesh.map<Vertex2>(vertices.size());
+            if (mapped.empty()) { continue; }
+
+            std::memcpy(mapped.data(), vertices.data(), vertices.size_bytes());
+            mesh.unmap();
+            mesh.bind();
+            mesh.draw();
+        }
+        glFinish();
+
+        return { std::chrono::duration<double>(Clock::now() - start).count(), mesh.stream().stalls(), mesh.stream().orphans() };
+    }
+
+    void report(const char *name, size_t bytes, int frames, const Result& result) {
+        std::cout << name << ": " << result.seconds * 1000.0 / frames << " ms/frame ("
+                  << double(bytes) * frames / result.seconds / 1e9 << " GB/s), "
+                  << result.stalls << " stalls, " << result.orphans << " orphans" << std::endl;
+    }
+}
+
+int main(int argc, const char **argv) {
+    double megabytes = argc > 1 ? std::strtod(argv[1], nullptr) : 16.0;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow *window = createHeadlessWindow(64, 64);
+    if (window == nullptr) {
+        std::cout << "Failed to create a headless context" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    unsigned program = createShader(kVertexShader, kFragmentShader);
+    glUseProgram(program);
+    glEnable(GL_RASTERIZER_DISCARD);
+
+    auto count = size_t(megabytes * 1024.0 * 1024.0) / sizeof(Vertex2);
+    std::vector<Vertex2> vertices(count);
+    for (size_t i = 0; i < count; i++) {
+        vertices[i] = { { float(i % 1024) / 512.f - 1.f, float(i / 1024 % 1024) / 512.f - 1.f, 0.f }, { 1.f, 1.f, 1.f } };
+    }
+
+    size_t bytes = count * sizeof(Vertex2);
+    std::cout << "streaming " << bytes / (1024.0 * 1024.0) << " MB a frame for " << frames << " frames" << std::endl;
+
+    report("glBufferData", bytes, frames, streamBuffer(vertices, frames, [](std::span<const Vertex2> data) {
+        glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(data.size_bytes()), data.data(), GL_STREAM_DRAW);
+    }));
+
+    report("glBufferSubData", bytes, frames, streamBuffer(vertices, frames, [](std::span<const Vertex2> data) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, GLsizeiptr(data.size_bytes()), data.data());
+    }));
+
+    report("DynamicMesh unsynchronized", bytes, frames, streamDynamic(vertices, frames, StreamMode::eUnsynchronized));
+
+    bool persistent = DynamicMesh(kVertexLayout<Vertex2>, 1, StreamMode::ePersistent).stream().persistent();
+    if (persistent) {
+        report("DynamicMesh persistent", bytes, frames, streamDynamic(vertices, frames, StreamMode::ePersistent));
+    } else {
+        std::cout << "DynamicMesh persistent: needs gl 4.4" << std::endl;
+    }
+
+    glDeleteProgram(program);
+    destroyHeadlessWindow(window);
+    glfwTerminate();
+    return 0;
+}
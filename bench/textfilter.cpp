@@ -0,0 +1,133 @@
+#include "hash.h"
+#include "jobs.h"
+
+#include "imgui/imgui.h"
+#include "imgui/imgui_internal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// ImGuiTextFilter over a 500k line log, the term by term search it used to
+// do against the compiled matcher, one line at a time and batched, serially
+// and on the job system. every way of filtering has to pick the same lines
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t kLines = 500'000;
+
+    // what PassFilter was, ImStristr once per term until one decides
+    bool oldPassFilter(const ImGuiTextFilter& filter, const char *text, const char *textEnd) {
+        if (filter.Filters.empty()) { return true; }
+
+        for (const auto& range : filter.Filters) {
+            if (range.empty()) { continue; }
+            if (range.b[0] == '-') {
+                if (ImStristr(text, textEnd, range.b + 1, range.e) != nullptr) { return false; }
+            } else {
+                if (ImStristr(text, textEnd, range.b, range.e) != nullptr) { return true; }
+            }
+        }
+        return filter.CountGrep == 0;
+    }
+
+    // lines shaped like the app's log, kept in one buffer the way a log window holds them
+    struct Log {
+        std::string text;
+        std::vector<const char*> begins;
+        std::vector<const char*> ends;
+    };
+
+    Log makeLog() {
+        static const char *kLevels[] = { "debug", "info", "info", "info", "warn", "Error" };
+        static const char *kSources[] = { "renderer", "jobs", "stream", "chaos", "deepzoom", "profile", "archive" };
+        static const char *kMessages[] = {
+            "frame took longer than budget",
+            "uploaded chunk to the gpu",
+            "program binary loaded from cache",
+            "fence signalled late, waiting on region",
+            "regenerating tiles after zoom",
+            "worker stole a job from another deque",
+            "asset not found in archive, falling back to disk"
+        };
+
+        Log log;
+        std::vector<size_t> offsets;
+        for (size_t i = 0; i < kLines; i++) {
+            uint32_t r = mix32(uint32_t(i));
+            offsets.push_back(log.text.size());
+            log.text += "[" + std::to_string(i / 60) + "] ";
+            log.text += kLevels[r % 6];
+            log.text += " ";
+            log.text += kSources[(r >> 8) % 7];
+            log.text += ": ";
+            log.text += kMessages[(r >> 16) % 7];
+            log.text += " #" + std::to_string(r % 1000);
+            log.text += "\n";
+        }
+
+        for (size_t i = 0; i < kLines; i++) {
+            log.begins.push_back(log.text.data() + offsets[i]);
+            log.ends.push_back(log.text.data() + (i + 1 < kLines ? offsets[i + 1] : log.text.size()) - 1);
+        }
+        return log;
+    }
+
+    void parallelForJobs(int count, void (*func)(int begin, int end, void *funcData), void *funcData, void *) {
+        jobSystem().parallelFor(size_t(count), [&](size_t begin, size_t end) { func(int(begin), int(end), funcData); }, 4096);
+    }
+
+    template<typename F>
+    double milliseconds(F&& fn) {
+        auto start = Clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    bool run(const Log& log, const char *input) {
+        ImGuiTextFilter filter(input);
+
+        std::vector<int> expected;
+        ImVector<int> single;
+        ImVector<int> batch;
+        ImVector<int> threaded;
+
+        double oldMs = milliseconds([&] {
+            for (size_t i = 0; i < kLines; i++) {
+                if (oldPassFilter(filter, log.begins[i], log.ends[i])) { expected.push_back(int(i)); }
+            }
+        });
+        double singleMs = milliseconds([&] {
+            for (size_t i = 0; i < kLines; i++) {
+                if (filter.PassFilter(log.begins[i], log.ends[i])) { single.push_back(int(i)); }
+            }
+        });
+        double batchMs = milliseconds([&] { filter.PassFilterBatch(log.begins.data(), log.ends.data(), int(kLines), &batch); });
+        double threadedMs = milliseconds([&] { filter.PassFilterBatch(log.begins.data(), log.ends.data(), int(kLines), &threaded, parallelForJobs); });
+
+        for (const ImVector<int> *indices : { &single, &batch, &threaded }) {
+            if (size_t(indices->Size) != expected.size() || !std::equal(expected.begin(), expected.end(), indices->begin())) {
+                std::cout << "Filter \"" << input << "\" picked different lines" << std::endl;
+                return false;
+            }
+        }
+
+        std::cout << "\"" << input << "\", " << expected.size() << " lines, ms old / new / batch / batch x" << jobSystem().threadCount() << ": "
+                  << oldMs << " / " << singleMs << " / " << batchMs << " / " << threadedMs << std::endl;
+        return true;
+    }
+}
+
+int main() {
+    Log log = makeLog();
+
+    for (const char *input : { "error", "error,warn", "-debug", "warn,-stream", "tile,gpu,cache,fence,-info,-debug",
+                               "renderer,jobs,stream,chaos,deepzoom,profile,archive,#99", "not in any line" }) {
+        if (!run(log, input)) { return 1; }
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+#version 330 core
+
+// every vertex is an independent chaos game walker, the final point is
+// captured with transform feedback so it never touches the cpu
+
+uniform uint seed;
+uniform int iterations;
+uniform int blending;
+
+out vec3 outPosition;
+out vec3 outColour;
+
+const vec2 kCorners[3] = vec2[3](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(0.0, 1.0));
+const vec3 kColours[3] = vec3[3](vec3(1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0), vec3(0.0, 0.0, 1.0));
+
+// lowbias32, same mixer the cpu generator uses
+uint mix32(uint x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// map 16 random bits onto [0, 3)
+int pickCorner(uint bits) {
+    return int(((bits & 0xffffu) * 3u) >> 16);
+}
+
+void main() {
+    uint key = mix32(uint(gl_VertexID) ^ mix32(seed));
+
+    int start = pickCorner(mix32(key));
+    vec2 position = kCorners[start];
+    vec3 colour = kColours[start];
+
+    // each draw feeds two steps
+    for (int i = 0; i < iterations; i += 2) {
+        uint bits = mix32(key + uint(i + 1));
+
+        int first = pickCorner(bits);
+        position = (kCorners[first] + position) * 0.5;
+        colour = blending != 0 ? (kColours[first] + colour) * 0.5 : kColours[first];
+
+        int second = pickCorner(bits >> 16);
+        position = (kCorners[second] + position) * 0.5;
+        colour = blending != 0 ? (kColours[second] + colour) * 0.5 : kColours[second];
+    }
+
+    outPosition = vec3(position, 0.0);
+    outColour = colour;
+}
@@ -0,0 +1,10 @@
+#version 330 core
+out vec4 FragColor;
+in vec2 uvCoords;
+
+// shown as is, for images made on the cpu
+uniform sampler2D image;
+
+void main() {
+    FragColor = texture(image, uvCoords);
+}
@@ -0,0 +1,15 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in uint aIndex;
+
+uniform vec3 palette[16];
+
+// xy is the centre of the view and zw the scale, see Camera2D
+uniform vec4 camera;
+
+out vec3 ourColour;
+
+void main() {
+    gl_Position = vec4((aPos.xy - camera.xy) * camera.zw, aPos.z, 1.0);
+    ourColour = palette[aIndex];
+}
@@ -1,16 +1,26 @@
 #version 330 core
 
+// colouring is picked at compile time, see ShaderVariants in program.h.
+// with no key set the uvs are shown
+#pragma variant COLOUR_VERTEX
+#pragma variant COLOUR_UNIFORM
+#pragma variant COLOUR_PERLIN
+#pragma variant COLOUR_BAKED
+
 out vec4 FragColor;
 in vec3 ourColour;
 in vec2 uvCoords;
 
-#define COLOUR_VERTEX 0
-#define COLOUR_UNIFORM 1
-#define COLOUR_PERLIN 2
-
-uniform int colourMethod;
+#if defined(COLOUR_UNIFORM)
 uniform vec3 colour;
+#endif
+
+#if defined(COLOUR_BAKED)
+// the same noise baked on the cpu by bakeNoise, [-1, 1] stored as [0, 1]
+uniform sampler2D noiseTexture;
+#endif
 
+#if defined(COLOUR_PERLIN)
 float interpolate(float a0, float a1, float w) {
     return (a1 - a0) * w + a0;
 }
@@ -64,16 +74,20 @@ float perlin(float x, float y) {
     value = interpolate(ix0, ix1, sy);
     return value; // Will return in range -1 to 1. To make it in range 0 to 1, multiply by 0.5 and add 0.5
 }
+#endif
 
 void main() {
-    if (colourMethod == COLOUR_VERTEX) {
-        FragColor = vec4(colour, 1.0);
-    } else if (colourMethod == COLOUR_UNIFORM) {
-        FragColor = vec4(ourColour, 1.0);
-    } else if (colourMethod == COLOUR_PERLIN) {
-        float noise = perlin(uvCoords.x * 10, uvCoords.y * 10);
-        FragColor = vec4(noise, noise, noise, 1.0);
-    } else {
-        FragColor = vec4(uvCoords.x, uvCoords.y, 0.0, 1.0);
-    }
+#if defined(COLOUR_VERTEX)
+    FragColor = vec4(ourColour, 1.0);
+#elif defined(COLOUR_UNIFORM)
+    FragColor = vec4(colour, 1.0);
+#elif defined(COLOUR_PERLIN)
+    float noise = perlin(uvCoords.x * 10, uvCoords.y * 10);
+    FragColor = vec4(noise, noise, noise, 1.0);
+#elif defined(COLOUR_BAKED)
+    float noise = texture(noiseTexture, uvCoords).r * 2.0 - 1.0;
+    FragColor = vec4(noise, noise, noise, 1.0);
+#else
+    FragColor = vec4(uvCoords.x, uvCoords.y, 0.0, 1.0);
+#endif
 }
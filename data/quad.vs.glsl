@@ -0,0 +1,22 @@
+#version 330 core
+layout (location = 0) in vec2 aCorner;
+
+// per instance, see QuadInstance in src/vertex.h
+layout (location = 1) in vec2 aPosition;
+layout (location = 2) in float aRotation;
+layout (location = 3) in float aScale;
+layout (location = 4) in vec4 aColour;
+
+out vec3 ourColour;
+
+const float TAU = 6.28318530718;
+
+void main() {
+    float angle = aRotation * TAU;
+    float c = cos(angle);
+    float s = sin(angle);
+
+    vec2 corner = mat2(c, s, -s, c) * aCorner * aScale;
+    gl_Position = vec4(aPosition + corner, 0.0, 1.0);
+    ourColour = aColour.rgb;
+}
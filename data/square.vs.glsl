@@ -2,9 +2,12 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColour;
 
+// xy is the centre of the view and zw the scale, see Camera2D
+uniform vec4 camera;
+
 out vec3 ourColour;
 
 void main() {
-    gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);
+    gl_Position = vec4((aPos.xy - camera.xy) * camera.zw, aPos.z, 1.0);
     ourColour = aColour;
 }
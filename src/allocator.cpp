@@ -0,0 +1,361 @@
+#include "allocator.h"
+
+#include "tlsf.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+namespace {
+    constexpr size_t kHeader = 16;
+    constexpr size_t kPageSize = 64 * 1024;
+
+    // payload sizes, 16 byte steps up to 128 then four classes per doubling
+    constexpr auto kClassSizes = std::to_array<uint32_t>({
+        16, 32, 48, 64, 80, 96, 112, 128,
+        160, 192, 224, 256,
+        320, 384, 448, 512,
+        640, 768, 896, 1024
+    });
+
+    constexpr size_t kClassCount = kClassSizes.size();
+
+    static_assert(kClassSizes.back() == kSmallBlockMax);
+
+    // the class for every multiple of 16 up to kSmallBlockMax
+    constexpr auto kClassOf = [] {
+        std::array<uint8_t, kSmallBlockMax / 16 + 1> classes = {};
+        size_t index = 0;
+        for (size_t i = 0; i < classes.size(); i++) {
+            while (kClassSizes[index] < i * 16) {
+                index++;
+            }
+            classes[i] = uint8_t(index);
+        }
+        return classes;
+    }();
+
+    // in front of every allocation
+    struct Header {
+        // the size class plus one, 0 for blocks from the heap
+        uint32_t sizeClass;
+        AllocTag tag;
+        uint64_t size;
+    };
+
+    static_assert(sizeof(Header) == kHeader);
+
+    // how many blocks a thread takes from the shared lists at once
+    constexpr size_t kRefillCount = 32;
+
+    // only ever written by one thread, read by allocatorStats on another
+    struct Counter {
+        std::atomic<size_t> value = 0;
+
+        void add(size_t n) { value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+        size_t get() const { return value.load(std::memory_order_relaxed); }
+    };
+
+    // live bytes and counts wrap on threads that free what another allocated,
+    // they add up right across every thread
+    struct TagCounters {
+        Counter liveBytes;
+        Counter liveCount;
+        Counter allocs;
+        Counter frees;
+    };
+
+    struct TagTotals {
+        size_t liveBytes = 0;
+        size_t liveCount = 0;
+        size_t allocs = 0;
+        size_t frees = 0;
+    };
+
+    using TagArray = std::array<TagTotals, size_t(AllocTag::eCount)>;
+
+    // small blocks freed on a thread go back on its own lists whichever thread
+    // allocated them, so the lock is only taken to refill, for the heap, and
+    // once the thread's cache is gone at exit
+    struct ThreadCache {
+        void *freeLists[kClassCount] = {};
+        std::array<TagCounters, size_t(AllocTag::eCount)> tags;
+
+        ThreadCache();
+        ~ThreadCache();
+
+        void counted(AllocTag tag, size_t bytes, size_t count, bool alloc) {
+            auto& counters = tags[size_t(tag)];
+            counters.liveBytes.add(bytes);
+            counters.liveCount.add(count);
+            (alloc ? counters.allocs : counters.frees).add(1);
+        }
+    };
+
+    struct State {
+        std::mutex lock;
+
+        // freed blocks of each class, linked through their first bytes
+        void *freeLists[kClassCount] = {};
+
+        // what is left of the page each class is carving blocks from
+        std::byte *cursors[kClassCount] = {};
+        std::byte *ends[kClassCount] = {};
+
+        std::vector<void*> pages;
+        TlsfHeap heap;
+
+        std::vector<ThreadCache*> caches;
+
+        // what threads that have exited counted, plus anything done without a cache
+        TagArray retired = {};
+
+        // sampled whenever the stats are read, and the totals at the last end of frame
+        std::array<size_t, size_t(AllocTag::eCount)> peakBytes = {};
+        std::array<AllocTagStats, size_t(AllocTag::eCount)> frame = {};
+        TagArray lastFrame = {};
+    };
+
+    // never destroyed, imgui can free after static destructors have run
+    State& state() {
+        static State *state = new State;
+        return *state;
+    }
+
+    thread_local AllocTag tTag = AllocTag::eOther;
+
+    // set once the cache is destroyed at thread exit, after which the thread
+    // goes through the locked path
+    thread_local bool tCacheGone = false;
+
+    ThreadCache *threadCache() {
+        if (tCacheGone) { return nullptr; }
+
+        thread_local ThreadCache cache;
+        return &cache;
+    }
+
+    ThreadCache::ThreadCache() {
+        State& s = state();
+        std::lock_guard guard(s.lock);
+        s.caches.push_back(this);
+    }
+
+    ThreadCache::~ThreadCache() {
+        State& s = state();
+        std::lock_guard guard(s.lock);
+
+        for (size_t i = 0; i < kClassCount; i++) {
+            while (void *block = freeLists[i]) {
+                freeLists[i] = *static_cast<void**>(block);
+                *static_cast<void**>(block) = s.freeLists[i];
+                s.freeLists[i] = block;
+            }
+        }
+
+        for (size_t i = 0; i < tags.size(); i++) {
+            s.retired[i].liveBytes += tags[i].liveBytes.get();
+            s.retired[i].liveCount += tags[i].liveCount.get();
+            s.retired[i].allocs += tags[i].allocs.get();
+            s.retired[i].frees += tags[i].frees.get();
+        }
+
+        std::erase(s.caches, this);
+        tCacheGone = true;
+    }
+
+    // with the lock held. a new page is only taken when refill is false
+    std::byte *allocateSmall(State& s, size_t index, bool refill) {
+        if (void *block = s.freeLists[index]) {
+            s.freeLists[index] = *static_cast<void**>(block);
+            return static_cast<std::byte*>(block);
+        }
+
+        size_t blockSize = kClassSizes[index] + kHeader;
+        if (s.cursors[index] == nullptr || s.ends[index] - s.cursors[index] < std::ptrdiff_t(blockSize)) {
+            if (refill) { return nullptr; }
+
+            auto *page = static_cast<std::byte*>(std::aligned_alloc(16, kPageSize));
+            if (page == nullptr) { return nullptr; }
+
+            s.pages.push_back(page);
+            s.cursors[index] = page;
+            s.ends[index] = page + kPageSize;
+        }
+
+        std::byte *block = s.cursors[index];
+        s.cursors[index] += blockSize;
+        return block;
+    }
+
+    // with the lock held
+    TagArray totals(State& s) {
+        TagArray result = s.retired;
+        for (ThreadCache *cache : s.caches) {
+            for (size_t i = 0; i < result.size(); i++) {
+                result[i].liveBytes += cache->tags[i].liveBytes.get();
+                result[i].liveCount += cache->tags[i].liveCount.get();
+                result[i].allocs += cache->tags[i].allocs.get();
+                result[i].frees += cache->tags[i].frees.get();
+            }
+        }
+
+        for (size_t i = 0; i < result.size(); i++) {
+            s.peakBytes[i] = std::max(s.peakBytes[i], result[i].liveBytes);
+        }
+        return result;
+    }
+}
+
+const char *allocTagName(AllocTag tag) {
+    switch (tag) {
+    case AllocTag::eOther: return "Other";
+    case AllocTag::eStorage: return "Storage";
+    case AllocTag::eDrawLists: return "Draw Lists";
+    case AllocTag::eFonts: return "Fonts";
+    default: return "Unknown";
+    }
+}
+
+AllocTag allocatorTag() {
+    return tTag;
+}
+
+AllocTagScope::AllocTagScope(AllocTag tag)
+    : previous(tTag)
+{
+    tTag = tag;
+}
+
+AllocTagScope::~AllocTagScope() {
+    tTag = previous;
+}
+
+void *allocatorAlloc(size_t size) {
+    return allocatorAlloc(size, tTag);
+}
+
+void *allocatorAlloc(size_t size, AllocTag tag) {
+    State& s = state();
+    ThreadCache *cache = threadCache();
+
+    uint32_t sizeClass = 0;
+    std::byte *block = nullptr;
+    if (size <= kSmallBlockMax) {
+        size_t index = kClassOf[(size + 15) / 16];
+        sizeClass = uint32_t(index + 1);
+
+        if (cache != nullptr && cache->freeLists[index] != nullptr) {
+            block = static_cast<std::byte*>(cache->freeLists[index]);
+            cache->freeLists[index] = *reinterpret_cast<void**>(block);
+        } else {
+            std::lock_guard guard(s.lock);
+            block = allocateSmall(s, index, false);
+
+            // take a few more so the next ones dont need the lock
+            for (size_t i = 1; cache != nullptr && block != nullptr && i < kRefillCount; i++) {
+                std::byte *extra = allocateSmall(s, index, true);
+                if (extra == nullptr) { break; }
+
+                *reinterpret_cast<void**>(extra) = cache->freeLists[index];
+                cache->freeLists[index] = extra;
+            }
+        }
+    } else {
+        std::lock_guard guard(s.lock);
+        block = static_cast<std::byte*>(s.heap.allocate(size + kHeader));
+    }
+
+    if (block == nullptr) { return nullptr; }
+
+    auto *header = reinterpret_cast<Header*>(block);
+    header->sizeClass = sizeClass;
+    header->tag = tag;
+    header->size = size;
+
+    if (cache != nullptr) {
+        cache->counted(tag, size, 1, true);
+    } else {
+        std::lock_guard guard(s.lock);
+        auto& retired = s.retired[size_t(tag)];
+        retired.liveBytes += size;
+        retired.liveCount += 1;
+        retired.allocs += 1;
+    }
+
+    return block + kHeader;
+}
+
+void allocatorFree(void *ptr) {
+    if (ptr == nullptr) { return; }
+
+    State& s = state();
+    ThreadCache *cache = threadCache();
+
+    auto *block = static_cast<std::byte*>(ptr) - kHeader;
+    auto *header = reinterpret_cast<Header*>(block);
+
+    if (cache != nullptr) {
+        cache->counted(header->tag, 0 - size_t(header->size), size_t(0) - 1, false);
+
+        if (header->sizeClass != 0) {
+            size_t index = header->sizeClass - 1;
+            *reinterpret_cast<void**>(block) = cache->freeLists[index];
+            cache->freeLists[index] = block;
+            return;
+        }
+    }
+
+    std::lock_guard guard(s.lock);
+
+    if (cache == nullptr) {
+        auto& retired = s.retired[size_t(header->tag)];
+        retired.liveBytes -= header->size;
+        retired.liveCount -= 1;
+        retired.frees += 1;
+    }
+
+    if (header->sizeClass == 0) {
+        s.heap.free(block);
+        return;
+    }
+
+    size_t index = header->sizeClass - 1;
+    *reinterpret_cast<void**>(block) = s.freeLists[index];
+    s.freeLists[index] = block;
+}
+
+AllocatorStats allocatorStats() {
+    State& s = state();
+    std::lock_guard guard(s.lock);
+
+    TagArray current = totals(s);
+
+    AllocatorStats stats;
+    for (size_t i = 0; i < stats.tags.size(); i++) {
+        stats.tags[i] = s.frame[i];
+        stats.tags[i].liveBytes = current[i].liveBytes;
+        stats.tags[i].liveCount = current[i].liveCount;
+        stats.tags[i].peakBytes = s.peakBytes[i];
+    }
+
+    stats.smallReserved = s.pages.size() * kPageSize;
+    stats.heapReserved = s.heap.reserved();
+    stats.heapUsed = s.heap.used();
+    stats.heapLargestFree = s.heap.largestFree();
+    return stats;
+}
+
+void allocatorEndFrame() {
+    State& s = state();
+    std::lock_guard guard(s.lock);
+
+    TagArray current = totals(s);
+    for (size_t i = 0; i < current.size(); i++) {
+        s.frame[i].frameAllocs = current[i].allocs - s.lastFrame[i].allocs;
+        s.frame[i].frameFrees = current[i].frees - s.lastFrame[i].frees;
+    }
+    s.lastFrame = current;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// the allocator imgui runs on. blocks up to kSmallBlockMax bytes come from
+// per size class free lists carved out of 64 KB pages, which are never given
+// back, so the steady churn of small ImVector growth is a pop and a push on
+// the calling thread's own lists, without a lock. anything bigger goes to a TlsfHeap. every allocation carries the tag that
+// was current on its thread when it was made, for the stats
+constexpr size_t kSmallBlockMax = 1024;
+
+enum class AllocTag : uint8_t {
+    eOther,
+
+    // windows, widget state and ImGuiStorage, what is made between NewFrame
+    // and Render that isnt a draw list
+    eStorage,
+
+    // draw list buffers wherever they grow, tagged by imgui itself (see
+    // ImDrawListAllocScope), and the copies made for the render thread
+    eDrawLists,
+
+    // the font atlas and everything used to build it
+    eFonts,
+
+    eCount
+};
+
+const char *allocTagName(AllocTag tag);
+
+// the tag of the calling thread
+AllocTag allocatorTag();
+
+// sets the tag of the calling thread until the scope ends
+struct AllocTagScope {
+    AllocTagScope(AllocTag tag);
+    ~AllocTagScope();
+
+    AllocTagScope(const AllocTagScope&) = delete;
+    AllocTagScope& operator=(const AllocTagScope&) = delete;
+
+private:
+    AllocTag previous;
+};
+
+// thread safe. the first one uses the calling thread's tag
+void *allocatorAlloc(size_t size);
+void *allocatorAlloc(size_t size, AllocTag tag);
+void allocatorFree(void *ptr);
+
+struct AllocTagStats {
+    size_t liveBytes = 0;
+    size_t liveCount = 0;
+
+    // the most live bytes seen by allocatorStats or allocatorEndFrame
+    size_t peakBytes = 0;
+
+    // during the last frame ended by allocatorEndFrame
+    size_t frameAllocs = 0;
+    size_t frameFrees = 0;
+};
+
+struct AllocatorStats {
+    std::array<AllocTagStats, size_t(AllocTag::eCount)> tags;
+
+    // bytes taken from the system by small block pages and by the heap, and
+    // how much of the heap live blocks use
+    size_t smallReserved = 0;
+    size_t heapReserved = 0;
+    size_t heapUsed = 0;
+    size_t heapLargestFree = 0;
+};
+
+AllocatorStats allocatorStats();
+
+// start counting allocations for a new frame
+void allocatorEndFrame();
+
+// point imgui at allocatorAlloc and allocatorFree, with draw list growth
+// tagged eDrawLists. call before ImGui::CreateContext
+void allocatorInstallImGui();
+
+// the allocator section of the metrics window, drawn with imgui
+void allocatorDrawStats();
@@ -0,0 +1,70 @@
+#include "allocator.h"
+
+#include "imgui/imgui.h"
+
+namespace {
+    double toKb(size_t bytes) {
+        return double(bytes) / 1024.0;
+    }
+}
+
+void allocatorInstallImGui() {
+    // imgui hands us this user data while a draw list grows, and null otherwise
+    static AllocTag drawLists = AllocTag::eDrawLists;
+
+    ImGui::SetAllocatorFunctions(
+        [](size_t size, void *tag) { return tag != nullptr ? allocatorAlloc(size, *static_cast<AllocTag*>(tag)) : allocatorAlloc(size); },
+        [](void *ptr, void*) { allocatorFree(ptr); }
+    );
+    ImGui::SetAllocatorDrawListUserData(&drawLists);
+}
+
+void allocatorDrawStats() {
+    if (!ImGui::CollapsingHeader("Allocator", ImGuiTreeNodeFlags_DefaultOpen)) { return; }
+
+    AllocatorStats stats = allocatorStats();
+
+    ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+    if (ImGui::BeginTable("Tags", 6, flags)) {
+        ImGui::TableSetupColumn("Tag");
+        ImGui::TableSetupColumn("Live KB");
+        ImGui::TableSetupColumn("Peak KB");
+        ImGui::TableSetupColumn("Blocks");
+        ImGui::TableSetupColumn("Allocs / Frame");
+        ImGui::TableSetupColumn("Frees / Frame");
+        ImGui::TableHeadersRow();
+
+        AllocTagStats total;
+        for (size_t i = 0; i < stats.tags.size(); i++) {
+            const auto& tag = stats.tags[i];
+            total.liveBytes += tag.liveBytes;
+            total.peakBytes += tag.peakBytes;
+            total.liveCount += tag.liveCount;
+            total.frameAllocs += tag.frameAllocs;
+            total.frameFrees += tag.frameFrees;
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(allocTagName(AllocTag(i)));
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", toKb(tag.liveBytes));
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", toKb(tag.peakBytes));
+            ImGui::TableNextColumn(); ImGui::Text("%zu", tag.liveCount);
+            ImGui::TableNextColumn(); ImGui::Text("%zu", tag.frameAllocs);
+            ImGui::TableNextColumn(); ImGui::Text("%zu", tag.frameFrees);
+        }
+
+        // peaks of different tags can happen at different times, so the
+        // total is an upper bound
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn(); ImGui::TextUnformatted("Total");
+        ImGui::TableNextColumn(); ImGui::Text("%.1f", toKb(total.liveBytes));
+        ImGui::TableNextColumn(); ImGui::Text("<= %.1f", toKb(total.peakBytes));
+        ImGui::TableNextColumn(); ImGui::Text("%zu", total.liveCount);
+        ImGui::TableNextColumn(); ImGui::Text("%zu", total.frameAllocs);
+        ImGui::TableNextColumn(); ImGui::Text("%zu", total.frameFrees);
+        ImGui::EndTable();
+    }
+
+    ImGui::Text("Small block pages: %.1f KB", toKb(stats.smallReserved));
+    ImGui::Text("Heap: %.1f of %.1f KB used, largest free block %.1f KB",
+        toKb(stats.heapUsed), toKb(stats.heapReserved), toKb(stats.heapLargestFree));
+}
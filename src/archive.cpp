@@ -0,0 +1,182 @@
+#include "archive.h"
+
+#include "hash.h"
+#include "program.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+Archive::~Archive() {
+    close();
+}
+
+void Archive::close() {
+    if (data == nullptr) { return; }
+
+#if defined(_WIN32)
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+    CloseHandle(file);
+    mapping = nullptr;
+    file = nullptr;
+#else
+    munmap((void*)data, length);
+#endif
+
+    data = nullptr;
+    length = 0;
+    entries = {};
+}
+
+bool Archive::open(const char *path) {
+    close();
+
+#if defined(_WIN32)
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        file = nullptr;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        file = nullptr;
+        return false;
+    }
+
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        file = nullptr;
+        return false;
+    }
+
+    data = (const std::byte*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    length = size_t(fileSize.QuadPart);
+    if (data == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        mapping = nullptr;
+        file = nullptr;
+        return false;
+    }
+#else
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) { return false; }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // the mapping keeps its own reference to the file
+    void *view = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) { return false; }
+
+    data = (const std::byte*)view;
+    length = size_t(info.st_size);
+#endif
+
+    ArchiveHeader header;
+    if (length < sizeof(header)) {
+        close();
+        return false;
+    }
+
+    std::copy_n(data, sizeof(header), (std::byte*)&header);
+
+    size_t indexEnd = sizeof(header) + size_t(header.count) * sizeof(ArchiveEntry);
+    if (header.magic != kArchiveMagic || header.version != kArchiveVersion || indexEnd > length) {
+        close();
+        return false;
+    }
+
+    // the header is 16 bytes so the index is suitably aligned within the mapping
+    entries = { (const ArchiveEntry*)(data + sizeof(header)), header.count };
+
+    // reject anything pointing outside the file rather than trusting it
+    for (const auto& entry : entries) {
+        if (entry.offset + entry.size >= length || entry.nameOffset + entry.nameLength > length) {
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::string_view Archive::nameOf(const ArchiveEntry& entry) const {
+    return { (const char*)data + entry.nameOffset, entry.nameLength };
+}
+
+const ArchiveEntry *Archive::lookup(std::string_view name) const {
+    auto it = std::lower_bound(entries.begin(), entries.end(), name, [&](const ArchiveEntry& entry, std::string_view key) {
+        return nameOf(entry) < key;
+    });
+
+    if (it == entries.end() || nameOf(*it) != name) { return nullptr; }
+
+    return &*it;
+}
+
+std::optional<std::span<const std::byte>> Archive::find(std::string_view name) const {
+    const auto *entry = lookup(name);
+    if (entry == nullptr) { return std::nullopt; }
+
+    return std::span(data + entry->offset, entry->size);
+}
+
+std::optional<std::string_view> Archive::findText(std::string_view name) const {
+    auto bytes = find(name);
+    if (!bytes) { return std::nullopt; }
+
+    return std::string_view((const char*)bytes->data(), bytes->size());
+}
+
+bool Archive::verify(std::string_view name) const {
+    const auto *entry = lookup(name);
+    if (entry == nullptr) { return false; }
+
+    return fnv1a(std::span(data + entry->offset, entry->size)) == entry->hash;
+}
+
+// mounted assets
+
+namespace {
+    Archive gAssets;
+
+    // assets that had to be read from disk, kept alive so their views stay valid
+    std::unordered_map<std::string, std::string> gLooseAssets;
+}
+
+bool mountAssets(const char *path) {
+    return gAssets.open(path);
+}
+
+std::string_view loadAsset(const char *path) {
+    if (auto text = gAssets.findText(path)) {
+        return *text;
+    }
+
+    auto it = gLooseAssets.find(path);
+    if (it == gLooseAssets.end()) {
+        it = gLooseAssets.emplace(path, loadFile(path)).first;
+    }
+
+    return it->second;
+}
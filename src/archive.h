@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+// single file asset archive, written by tools/pack.cpp at build time
+//
+// layout:
+//   ArchiveHeader
+//   ArchiveEntry[count], sorted by name
+//   names, not null terminated
+//   file contents, each aligned to kArchiveAlign and followed by a null byte
+//   so text assets can be handed straight to apis that want a c string
+
+constexpr uint32_t kArchiveMagic = 0x314b4150; // PAK1
+constexpr uint32_t kArchiveVersion = 1;
+constexpr size_t kArchiveAlign = 16;
+
+struct ArchiveHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct ArchiveEntry {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t hash;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+};
+
+// a read only view of an archive mapped into memory. every view it hands
+// out points straight into the mapping and lives as long as the archive
+struct Archive {
+    Archive() = default;
+    ~Archive();
+
+    Archive(const Archive&) = delete;
+    Archive& operator=(const Archive&) = delete;
+
+    // returns false if the file is missing or not an archive
+    bool open(const char *path);
+
+    bool isOpen() const { return data != nullptr; }
+
+    std::optional<std::span<const std::byte>> find(std::string_view name) const;
+
+    // same as find but for text, the view is null terminated
+    std::optional<std::string_view> findText(std::string_view name) const;
+
+    // rehash the contents of an entry and compare against the index
+    bool verify(std::string_view name) const;
+
+    size_t size() const { return entries.size(); }
+
+private:
+    std::string_view nameOf(const ArchiveEntry& entry) const;
+    const ArchiveEntry *lookup(std::string_view name) const;
+
+    void close();
+
+    const std::byte *data = nullptr;
+    size_t length = 0;
+    std::span<const ArchiveEntry> entries;
+
+#if defined(_WIN32)
+    void *file = nullptr;
+    void *mapping = nullptr;
+#endif
+};
+
+// mount the archive loadAsset reads from, returns false if it couldnt be opened
+bool mountAssets(const char *path);
+
+// a view of an asset, out of the mounted archive when it has one and read from
+// disk otherwise. the view is null terminated and valid until exit
+std::string_view loadAsset(const char *path);
@@ -0,0 +1,53 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace {
+    // nearest rank, expects sorted samples
+    double percentile(const std::vector<double>& sorted, double p) {
+        size_t rank = size_t(std::ceil(p * double(sorted.size())));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+}
+
+void FrameTimings::add(const ProfileFrame& frame) {
+    std::map<std::string, double> totals;
+    for (const auto& zone : frame.cpu) {
+        totals[std::string("cpu/") + zone.name] += double(zone.end - zone.begin) / 1'000'000.0;
+    }
+    for (const auto& zone : frame.gpu) {
+        totals[std::string("gpu/") + zone.name] += double(zone.end - zone.begin) / 1'000'000.0;
+    }
+
+    phases["frame"].push_back(double(frame.end - frame.begin) / 1'000'000.0);
+    for (const auto& [name, ms] : totals) {
+        phases[name].push_back(ms);
+    }
+
+    frames += 1;
+}
+
+void FrameTimings::print(std::ostream& out) const {
+    auto flags = out.flags();
+    out << std::fixed << std::setprecision(4);
+
+    out << "{\"frames\":" << frames << ",\"phases\":{";
+
+    bool first = true;
+    for (const auto& [name, samples] : phases) {
+        auto sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+
+        if (!first) { out << ','; }
+        first = false;
+
+        out << '"' << name << "\":{\"count\":" << sorted.size()
+            << ",\"median_ms\":" << percentile(sorted, 0.5)
+            << ",\"p99_ms\":" << percentile(sorted, 0.99) << '}';
+    }
+
+    out << "}}" << std::endl;
+    out.flags(flags);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "profile.h"
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// per phase timings over a benchmark run, gathered from profiler frames
+struct FrameTimings {
+    // adds the frame time and the total time of every zone name in the
+    // frame, cpu zones from all threads are summed
+    void add(const ProfileFrame& frame);
+
+    // one json object on a single line, phases are keyed as "frame",
+    // "cpu/<zone>" and "gpu/<zone>". a phase that only ran on some frames
+    // reports how many in "count"
+    void print(std::ostream& out) const;
+
+private:
+    size_t frames = 0;
+    std::map<std::string, std::vector<double>> phases;
+};
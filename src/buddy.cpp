@@ -0,0 +1,87 @@
+#include "buddy.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+    unsigned orderOf(size_t size) {
+        return unsigned(std::bit_width(std::bit_ceil(std::max<size_t>(size, 1)) - 1));
+    }
+}
+
+BuddyAllocator::BuddyAllocator(size_t capacity)
+    : maxOrder(orderOf(capacity))
+    , freeLists(maxOrder + 1)
+{
+    freeLists[maxOrder].insert(0);
+}
+
+bool BuddyAllocator::allocate(size_t size, Block& block) {
+    unsigned order = orderOf(size);
+    if (order > maxOrder) { return false; }
+
+    // find the smallest free block that fits
+    unsigned found = order;
+    while (found <= maxOrder && freeLists[found].empty()) {
+        found++;
+    }
+
+    if (found > maxOrder) { return false; }
+
+    auto it = freeLists[found].begin();
+    size_t offset = *it;
+    freeLists[found].erase(it);
+
+    // split it down, the upper halves become free blocks of their own
+    while (found > order) {
+        found--;
+        freeLists[found].insert(offset + (size_t(1) << found));
+    }
+
+    block = { offset, order };
+    usedSize += block.size();
+    return true;
+}
+
+void BuddyAllocator::free(Block block) {
+    usedSize -= block.size();
+
+    size_t offset = block.offset;
+    unsigned order = block.order;
+
+    while (order < maxOrder) {
+        size_t buddy = offset ^ (size_t(1) << order);
+        auto& list = freeLists[order];
+        auto it = list.find(buddy);
+        if (it == list.end()) { break; }
+
+        list.erase(it);
+        offset = std::min(offset, buddy);
+        order++;
+    }
+
+    freeLists[order].insert(offset);
+}
+
+void BuddyAllocator::grow() {
+    size_t upper = capacity();
+
+    maxOrder++;
+    freeLists.emplace_back();
+
+    // if the whole old space was free it merges with the new half
+    auto& top = freeLists[maxOrder - 1];
+    if (top.erase(0)) {
+        freeLists[maxOrder].insert(0);
+    } else {
+        top.insert(upper);
+    }
+}
+
+size_t BuddyAllocator::freeBlockCount() const {
+    size_t count = 0;
+    for (const auto& list : freeLists) {
+        count += list.size();
+    }
+    return count;
+}
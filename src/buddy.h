@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_set>
+#include <vector>
+
+// buddy allocator over abstract offsets, it never touches memory itself so it
+// can hand out ranges of gpu buffers. sizes are rounded up to a power of two
+// and freed blocks merge with their buddy as soon as both halves are free
+struct BuddyAllocator {
+    struct Block {
+        size_t offset = 0;
+        unsigned order = 0;
+
+        size_t size() const { return size_t(1) << order; }
+    };
+
+    // capacity is rounded up to a power of two
+    BuddyAllocator(size_t capacity);
+
+    // returns false if there is no free block big enough
+    bool allocate(size_t size, Block& block);
+
+    void free(Block block);
+
+    // double the capacity, the existing space becomes the lower half so every
+    // outstanding block stays valid
+    void grow();
+
+    size_t capacity() const { return size_t(1) << maxOrder; }
+    size_t used() const { return usedSize; }
+
+    // 1 once everything allocated has been freed and merged back together
+    size_t freeBlockCount() const;
+
+private:
+    unsigned maxOrder;
+    size_t usedSize = 0;
+
+    // free block offsets for each order
+    std::vector<std::unordered_set<size_t>> freeLists;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "doubledouble.h"
+#include "vertex.h"
+
+#include <array>
+
+// 2d pan and zoom, applied by the camera uniform in data/square.vs.glsl
+// and data/palette.vs.glsl. at zoom 1 the view covers [-1, 1] on both axes.
+// the centre is a double-double so deep zoom can go far past where floats
+// and doubles run out, everything else only sees it rounded
+struct Camera2D {
+    DoubleDouble x;
+    DoubleDouble y;
+    double zoom = 1.0;
+
+    constexpr bool operator==(const Camera2D&) const = default;
+
+    // the world space rectangle on screen
+    constexpr Bounds2 view() const {
+        return {
+            float(x - 1.0 / zoom), float(y - 1.0 / zoom),
+            float(x + 1.0 / zoom), float(y + 1.0 / zoom)
+        };
+    }
+
+    // zoom by `factor` keeping the world position under `ndc` where it is
+    constexpr void zoomAt(Point2 ndc, double factor) {
+        DoubleDouble anchorX = x + ndc.x / zoom;
+        DoubleDouble anchorY = y + ndc.y / zoom;
+        zoom *= factor;
+        x = anchorX - ndc.x / zoom;
+        y = anchorY - ndc.y / zoom;
+    }
+
+    // xy is the centre and zw the scale, matching `uniform vec4 camera`
+    constexpr std::array<float, 4> uniform() const {
+        return { float(x), float(y), float(zoom), float(zoom) };
+    }
+};
+
+// the camera that just fits `bounds` on screen
+constexpr Camera2D fitCamera(const Bounds2& bounds) {
+    double width = double(bounds.maxX) - double(bounds.minX);
+    double height = double(bounds.maxY) - double(bounds.minY);
+    double extent = width > height ? width : height;
+    return {
+        (double(bounds.minX) + double(bounds.maxX)) * 0.5,
+        (double(bounds.minY) + double(bounds.maxY)) * 0.5,
+        extent > 0.0 ? 2.0 / extent : 1.0
+    };
+}
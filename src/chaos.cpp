@@ -0,0 +1,109 @@
+#include "chaos.h"
+
+#include "hash.h"
+#include "parallel.h"
+#include "profile.h"
+
+#include <cstdlib>
+
+namespace {
+    // walkers per thread. they are stored as structure of arrays and stepped
+    // in lockstep so the inner loops vectorise across lanes
+    constexpr size_t kLanes = 16;
+
+    // map 16 random bits onto [0, 3)
+    constexpr uint32_t pickCorner(uint32_t bits) {
+        return ((bits & 0xffff) * 3) >> 16;
+    }
+
+    struct Lanes {
+        float x[kLanes];
+        float y[kLanes];
+        float r[kLanes];
+        float g[kLanes];
+        float b[kLanes];
+        uint32_t bits[kLanes];
+    };
+
+    void walk(std::span<Vertex2> out, uint64_t seed, uint64_t firstWalker, bool blending) {
+        CounterStream streams[kLanes];
+        for (size_t lane = 0; lane < kLanes; lane++) {
+            streams[lane] = makeCounterStream(seed, firstWalker + lane);
+        }
+
+        // every corner is on the attractor so walkers need no warmup
+        Lanes state;
+        for (size_t lane = 0; lane < kLanes; lane++) {
+            const auto& start = kSierpinskiCorners[pickCorner(streams[lane].at(0))];
+            state.x[lane] = start.position.x;
+            state.y[lane] = start.position.y;
+            state.r[lane] = start.colour.r;
+            state.g[lane] = start.colour.g;
+            state.b[lane] = start.colour.b;
+        }
+
+        // each draw feeds two steps, 16 bits each
+        size_t steps = (out.size() + kLanes - 1) / kLanes;
+        for (size_t step = 0; step < steps; step++) {
+            if (step % 2 == 0) {
+                uint32_t counter = uint32_t(step / 2 + 1);
+                for (size_t lane = 0; lane < kLanes; lane++) {
+                    state.bits[lane] = streams[lane].at(counter);
+                }
+            } else {
+                for (size_t lane = 0; lane < kLanes; lane++) {
+                    state.bits[lane] >>= 16;
+                }
+            }
+
+            for (size_t lane = 0; lane < kLanes; lane++) {
+                uint32_t corner = pickCorner(state.bits[lane]);
+
+                float isR = corner == 0 ? 1.f : 0.f;
+                float isG = corner == 1 ? 1.f : 0.f;
+                float isB = corner == 2 ? 1.f : 0.f;
+
+                // corners are (-1, -1), (1, -1) and (0, 1)
+                float cx = isG - isR;
+                float cy = isB * 2.f - 1.f;
+
+                state.x[lane] = (cx + state.x[lane]) * 0.5f;
+                state.y[lane] = (cy + state.y[lane]) * 0.5f;
+
+                state.r[lane] = blending ? (isR + state.r[lane]) * 0.5f : isR;
+                state.g[lane] = blending ? (isG + state.g[lane]) * 0.5f : isG;
+                state.b[lane] = blending ? (isB + state.b[lane]) * 0.5f : isB;
+            }
+
+            size_t base = step * kLanes;
+            size_t count = std::min(kLanes, out.size() - base);
+            for (size_t lane = 0; lane < count; lane++) {
+                out[base + lane] = {
+                    { state.x[lane], state.y[lane], 0.f },
+                    { state.r[lane], state.g[lane], state.b[lane] }
+                };
+            }
+        }
+    }
+}
+
+std::vector<Vertex2> makeSierpinski(size_t steps, bool blending) {
+    std::vector<Vertex2> verts = { kSierpinskiCorners.begin(), kSierpinskiCorners.end() };
+
+    for (size_t i = 0; i < steps; i++) {
+        size_t index = rand() % 3;
+        auto& back = verts.back();
+        auto& point = verts[index];
+        verts.push_back(sierpinskiStep(point, back, blending));
+    }
+
+    return verts;
+}
+
+void generateSierpinski(std::span<Vertex2> out, const ChaosParams& params) {
+    PROFILE_SCOPE("Generate Sierpinski");
+    parallelFor(out.size(), params.threads, [&](unsigned chunk, size_t begin, size_t end) {
+        PROFILE_SCOPE("Walk");
+        walk(out.subspan(begin, end - begin), params.seed, uint64_t(chunk) * kLanes, params.blending);
+    });
+}
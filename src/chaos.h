@@ -0,0 +1,52 @@
+#pragma once
+
+#include "mesh.h"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// cpu side chaos game generators for the sierpinski triangle
+
+constexpr auto kSierpinskiCorners = std::to_array<Vertex2>({
+    { { -1, -1, 0 }, { 1, 0, 0 } },
+    { { 1, -1, 0 }, { 0, 1, 0 } },
+    { { 0, 1, 0 }, { 0, 0, 1 } }
+});
+
+// move halfway from `back` towards `corner`
+constexpr Vertex2 sierpinskiStep(const Vertex2& corner, const Vertex2& back, bool blending) {
+    return {
+        {
+            (corner.position.x + back.position.x) / 2,
+            (corner.position.y + back.position.y) / 2,
+            0
+        },
+        {
+            blending ? (corner.colour.r + back.colour.r) / 2 : corner.colour.r,
+            blending ? (corner.colour.g + back.colour.g) / 2 : corner.colour.g,
+            blending ? (corner.colour.b + back.colour.b) / 2 : corner.colour.b
+        }
+    };
+}
+
+// which corner a point without blending took its colour from, for PaletteVertex
+constexpr uint16_t sierpinskiCornerIndex(const Colour& colour) {
+    return colour.g > 0.5f ? 1 : colour.b > 0.5f ? 2 : 0;
+}
+
+// regenerates the whole triangle from scratch with a single walker, kept
+// around as the reference implementation
+std::vector<Vertex2> makeSierpinski(size_t steps, bool blending);
+
+struct ChaosParams {
+    uint64_t seed = 0;
+    unsigned threads = 1;
+    bool blending = false;
+};
+
+// fill `out` with points from many independent walkers. every walker has its
+// own counter based rng stream so the output is identical for the same seed
+// and thread count no matter how the threads get scheduled
+void generateSierpinski(std::span<Vertex2> out, const ChaosParams& params);
@@ -0,0 +1,260 @@
+#include "deepzoom.h"
+
+#include "hash.h"
+#include "parallel.h"
+#include "profile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+    // steps a walker takes before its points are kept, as in ifs.cpp
+    constexpr unsigned kWarmup = 64;
+
+    // a composition of maps in attractor space. the linear part shrinks
+    // towards zero but keeps its relative precision in doubles, only the
+    // offset needs the extra bits to stay put next to the camera centre
+    struct Cell {
+        double a, b, c, d;
+        DoubleDouble e, f;
+
+        double mass;
+        Colour colour;
+        float colourScale;
+        Colour outer;
+        unsigned depth;
+
+        // largest side of the cell bounds on screen, in ndc
+        double size;
+    };
+
+    struct Corner {
+        double x, y;
+    };
+
+    // the cell bounds in ndc and whether they touch the view at all
+    bool measureCell(Cell& cell, const std::array<Corner, 4>& corners, const Camera2D& camera) {
+        double ox = double(cell.e - camera.x) * camera.zoom;
+        double oy = double(cell.f - camera.y) * camera.zoom;
+
+        double minX = INFINITY, minY = INFINITY;
+        double maxX = -INFINITY, maxY = -INFINITY;
+        for (const auto& corner : corners) {
+            double x = (cell.a * corner.x + cell.b * corner.y) * camera.zoom + ox;
+            double y = (cell.c * corner.x + cell.d * corner.y) * camera.zoom + oy;
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+        }
+
+        cell.size = std::max(maxX - minX, maxY - minY);
+        return minX <= 1.0 && maxX >= -1.0 && minY <= 1.0 && maxY >= -1.0;
+    }
+
+    // the cell applied after `map`
+    Cell compose(const Cell& cell, const AffineMap& map, double probability) {
+        Cell out;
+        out.a = cell.a * map.a + cell.b * map.c;
+        out.b = cell.a * map.b + cell.b * map.d;
+        out.c = cell.c * map.a + cell.d * map.c;
+        out.d = cell.c * map.b + cell.d * map.d;
+        out.e = cell.e + (cell.a * map.e + cell.b * map.f);
+        out.f = cell.f + (cell.c * map.e + cell.d * map.f);
+
+        out.mass = cell.mass * probability;
+
+        // the map colour goes in before every colour already in the cell
+        float half = cell.colourScale * 0.5f;
+        out.colour = {
+            cell.colour.r + map.colour.r * half,
+            cell.colour.g + map.colour.g * half,
+            cell.colour.b + map.colour.b * half
+        };
+        out.colourScale = half;
+        out.outer = cell.depth == 0 ? map.colour : cell.outer;
+        out.depth = cell.depth + 1;
+        return out;
+    }
+
+    DeepCell toDeepCell(const Cell& cell, const Camera2D& camera) {
+        return {
+            float(cell.a * camera.zoom), float(cell.b * camera.zoom),
+            float(cell.c * camera.zoom), float(cell.d * camera.zoom),
+            float(double(cell.e - camera.x) * camera.zoom),
+            float(double(cell.f - camera.y) * camera.zoom),
+            cell.mass,
+            cell.colour,
+            cell.colourScale,
+            cell.outer,
+            cell.depth
+        };
+    }
+}
+
+std::vector<DeepCell> findDeepCells(std::span<const AffineMap> maps, const Camera2D& camera, const DeepParams& params) {
+    PROFILE_SCOPE("Find Deep Cells");
+
+    std::vector<DeepCell> out;
+    if (maps.empty()) { return out; }
+
+    maps = maps.first(std::min(maps.size(), kMaxAffineMaps));
+
+    // the chance of each map as the walker actually sees it
+    MapPicker picker(maps);
+    double probability[kMaxAffineMaps] = {};
+    uint32_t previous = 0;
+    for (size_t i = 0; i < maps.size(); i++) {
+        uint32_t threshold = i + 1 < maps.size() ? picker.cumulative[i] : 65536;
+        probability[i] = double(threshold - std::min(previous, threshold)) / 65536.0;
+        previous = std::max(previous, threshold);
+    }
+
+    // every cell holds its image of these bounds, so they bound the cell too
+    Bounds2 bounds = ifsBounds(maps, 0.f);
+    std::array<Corner, 4> corners = {{
+        { bounds.minX, bounds.minY },
+        { bounds.maxX, bounds.minY },
+        { bounds.minX, bounds.maxY },
+        { bounds.maxX, bounds.maxY }
+    }};
+
+    // always split the biggest cell on screen next so running out of
+    // cells leaves them all about the same size
+    auto smaller = [](const Cell& lhs, const Cell& rhs) { return lhs.size < rhs.size; };
+    std::priority_queue<Cell, std::vector<Cell>, decltype(smaller)> open(smaller);
+
+    Cell root = { 1.0, 0.0, 0.0, 1.0, 0.0, 0.0, 1.0, { 0.f, 0.f, 0.f }, 1.f, { 0.f, 0.f, 0.f }, 0, 0.0 };
+    if (measureCell(root, corners, camera)) {
+        open.push(root);
+    }
+
+    double leafSize = double(params.cellSize) * 2.0;
+    while (!open.empty()) {
+        const Cell& cell = open.top();
+        if (cell.size <= leafSize || out.size() + open.size() >= params.maxCells) {
+            break;
+        }
+
+        Cell parent = cell;
+        open.pop();
+        if (parent.depth >= params.maxDepth) {
+            out.push_back(toDeepCell(parent, camera));
+            continue;
+        }
+
+        for (size_t i = 0; i < maps.size(); i++) {
+            if (probability[i] <= 0.0) { continue; }
+
+            Cell child = compose(parent, maps[i], probability[i]);
+            if (child.mass > 0.0 && measureCell(child, corners, camera)) {
+                open.push(child);
+            }
+        }
+    }
+
+    for (; !open.empty(); open.pop()) {
+        out.push_back(toDeepCell(open.top(), camera));
+    }
+    return out;
+}
+
+size_t generateDeepPoints(std::span<Vertex2> out, std::span<const AffineMap> maps, std::span<const DeepCell> cells, const ChaosParams& params) {
+    PROFILE_SCOPE("Generate Deep Points");
+
+    if (out.empty() || maps.empty() || cells.empty()) { return 0; }
+
+    maps = maps.first(std::min(maps.size(), kMaxAffineMaps));
+
+    // cell i owns the points whose share of the total falls below ends[i]
+    std::vector<double> ends(cells.size());
+    double total = 0.0;
+    for (size_t i = 0; i < cells.size(); i++) {
+        total += cells[i].mass;
+        ends[i] = total;
+    }
+    if (!(total > 0.0)) { return 0; }
+
+    unsigned threads = std::max(params.threads, 1u);
+    std::vector<size_t> kept(threads);
+    std::vector<size_t> starts(threads);
+    double step = total / double(out.size());
+
+    parallelFor(out.size(), threads, [&](unsigned chunk, size_t begin, size_t end) {
+        PROFILE_SCOPE("Walk Deep Cells");
+
+        MapPicker picker(maps);
+        CounterStream stream = makeCounterStream(params.seed, chunk);
+
+        float x = 0.f, y = 0.f;
+        Colour colour = { 0.5f, 0.5f, 0.5f };
+        uint32_t last = 0;
+
+        uint32_t bits = 0;
+        uint32_t draws = 0;
+        auto advance = [&](uint64_t index) {
+            // each draw feeds two steps, 16 bits each
+            bits = index % 2 == 0 ? stream.at(draws++) : bits >> 16;
+
+            last = picker.pick(bits);
+            const auto& map = maps[last];
+            float nx = map.a * x + map.b * y + map.e;
+            float ny = map.c * x + map.d * y + map.f;
+            x = nx;
+            y = ny;
+            colour = {
+                (colour.r + map.colour.r) * 0.5f,
+                (colour.g + map.colour.g) * 0.5f,
+                (colour.b + map.colour.b) * 0.5f
+            };
+        };
+
+        for (unsigned i = 0; i < kWarmup; i++) {
+            advance(i);
+        }
+
+        auto cell = size_t(std::upper_bound(ends.begin(), ends.end(), (double(begin) + 0.5) * step) - ends.begin());
+        size_t count = 0;
+        for (size_t i = begin; i < end; i++) {
+            advance(kWarmup + (i - begin));
+
+            double share = (double(i) + 0.5) * step;
+            while (cell + 1 < cells.size() && ends[cell] <= share) {
+                cell++;
+            }
+
+            const auto& c = cells[cell];
+            float px = c.a * x + c.b * y + c.e;
+            float py = c.c * x + c.d * y + c.f;
+            if (!(px >= -1.f && px <= 1.f && py >= -1.f && py <= 1.f)) {
+                continue;
+            }
+
+            Colour pc = c.outer;
+            if (params.blending) {
+                pc = {
+                    c.colour.r + colour.r * c.colourScale,
+                    c.colour.g + colour.g * c.colourScale,
+                    c.colour.b + colour.b * c.colourScale
+                };
+            } else if (c.depth == 0) {
+                pc = maps[last].colour;
+            }
+
+            out[begin + count++] = { { px, py, 0.f }, pc };
+        }
+
+        starts[chunk] = begin;
+        kept[chunk] = count;
+    });
+
+    // close the gaps left by dropped points, chunks only ever move down
+    size_t size = kept[0];
+    for (unsigned chunk = 1; chunk < threads; chunk++) {
+        auto first = out.begin() + ptrdiff_t(starts[chunk]);
+        std::copy(first, first + ptrdiff_t(kept[chunk]), out.begin() + ptrdiff_t(size));
+        size += kept[chunk];
+    }
+    return size;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "camera.h"
+#include "chaos.h"
+#include "ifs.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// regenerates only the part of an ifs attractor that is inside the camera
+// view, with positions relative to the view so floats keep their precision
+// at any zoom. the attractor is the union of its images under every map, so
+// it can be split into cells, the images under compositions of maps. cells
+// are tracked in double-double, the ones off screen are dropped and the ones
+// that already look small on screen get filled by an ordinary float chaos
+// game pushed through the cell map composed with the camera.
+//
+// systems whose copies overlap, like the stems of the fern, need more cells
+// the deeper they go. past maxCells the cells are used as they are and more
+// of their points land off screen
+
+// one cell, mapped straight from attractor space to normalised device coordinates
+struct DeepCell {
+    float a, b, c, d;
+    float e, f;
+
+    // share of the whole attractor that lands in the cell
+    double mass;
+
+    // points picked up colour from the maps composed into the cell, the
+    // walker colour only keeps `colourScale` of its weight
+    Colour colour;
+    float colourScale;
+
+    // colour of the last map applied, for points without blending
+    Colour outer;
+
+    // 0 is the whole attractor
+    unsigned depth;
+};
+
+struct DeepParams {
+    // cells stop splitting once their bounds fit in this fraction of the view
+    float cellSize = 0.25f;
+    size_t maxCells = 4096;
+    unsigned maxDepth = 400;
+};
+
+std::vector<DeepCell> findDeepCells(std::span<const AffineMap> maps, const Camera2D& camera, const DeepParams& params = {});
+
+// fill `out` with points spread over `cells` by mass. points outside the view
+// are dropped and the rest packed at the front, returns how many were kept.
+// as with generateSierpinski the output only depends on the seed and thread count
+size_t generateDeepPoints(std::span<Vertex2> out, std::span<const AffineMap> maps, std::span<const DeepCell> cells, const ChaosParams& params);
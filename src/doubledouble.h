@@ -0,0 +1,56 @@
+#pragma once
+
+// double-double, an unevaluated sum of two doubles holding about 106 bits
+// of mantissa. only addition is provided since positions only ever get
+// offsets added to them, scales stay in plain doubles. breaks under
+// -ffast-math, which is free to simplify the error terms away
+
+struct DoubleDouble {
+    double hi = 0.0;
+    double lo = 0.0;
+
+    constexpr DoubleDouble() = default;
+    constexpr DoubleDouble(double value) : hi(value) { }
+    constexpr DoubleDouble(double hi, double lo) : hi(hi), lo(lo) { }
+
+    constexpr explicit operator double() const { return hi + lo; }
+    constexpr explicit operator float() const { return float(hi + lo); }
+
+    constexpr bool operator==(const DoubleDouble&) const = default;
+};
+
+// knuth's two-sum, s + e == a + b exactly
+constexpr DoubleDouble twoSum(double a, double b) {
+    double s = a + b;
+    double v = s - a;
+    double e = (a - (s - v)) + (b - v);
+    return { s, e };
+}
+
+// assumes |a| >= |b|
+constexpr DoubleDouble quickTwoSum(double a, double b) {
+    double s = a + b;
+    return { s, b - (s - a) };
+}
+
+constexpr DoubleDouble operator-(const DoubleDouble& a) {
+    return { -a.hi, -a.lo };
+}
+
+constexpr DoubleDouble operator+(const DoubleDouble& a, double b) {
+    DoubleDouble s = twoSum(a.hi, b);
+    return quickTwoSum(s.hi, s.lo + a.lo);
+}
+
+constexpr DoubleDouble operator+(const DoubleDouble& a, const DoubleDouble& b) {
+    DoubleDouble s = twoSum(a.hi, b.hi);
+    DoubleDouble t = twoSum(a.lo, b.lo);
+    s = quickTwoSum(s.hi, s.lo + t.hi);
+    return quickTwoSum(s.hi, s.lo + t.lo);
+}
+
+constexpr DoubleDouble operator-(const DoubleDouble& a, double b) { return a + -b; }
+constexpr DoubleDouble operator-(const DoubleDouble& a, const DoubleDouble& b) { return a + -b; }
+
+constexpr DoubleDouble& operator+=(DoubleDouble& a, double b) { return a = a + b; }
+constexpr DoubleDouble& operator-=(DoubleDouble& a, double b) { return a = a - b; }
@@ -0,0 +1,176 @@
+#include "profile.h"
+
+#include "glad/glad.h"
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+
+namespace {
+    // frames that can be in flight before a read back has to wait
+    constexpr size_t kGpuLatency = 4;
+    constexpr uint32_t kNoZone = std::numeric_limits<uint32_t>::max();
+
+    // zone handles carry the frame slot in the top bits so a zone that
+    // ends after profileGpuEndFrame still finds its begin query
+    constexpr uint32_t kSlotShift = 24;
+
+    // timestamps rather than GL_TIME_ELAPSED, elapsed queries cant nest
+    struct GpuZone {
+        const char *name;
+        unsigned begin;
+        unsigned end;
+        uint32_t depth;
+    };
+
+    struct GpuFrame {
+        uint64_t index = 0;
+        std::vector<GpuZone> zones;
+    };
+
+    std::array<GpuFrame, kGpuLatency> gFrames;
+    size_t gCurrent = 0;
+    uint32_t gDepth = 0;
+
+    std::vector<unsigned> gFreeQueries;
+    std::vector<unsigned> gAllQueries;
+
+    bool gReady = false;
+
+    // maps gpu timestamps onto the profileNow clock
+    int64_t gClockOffset = 0;
+    uint64_t gCalibratedFrame = 0;
+
+    void calibrate() {
+        GLint64 gpu = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpu);
+        gClockOffset = int64_t(profileNow()) - int64_t(gpu);
+    }
+
+    unsigned allocQuery() {
+        if (gFreeQueries.empty()) {
+            unsigned queries[16];
+            glGenQueries(16, queries);
+            gFreeQueries.insert(gFreeQueries.end(), std::begin(queries), std::end(queries));
+            gAllQueries.insert(gAllQueries.end(), std::begin(queries), std::end(queries));
+        }
+
+        unsigned query = gFreeQueries.back();
+        gFreeQueries.pop_back();
+        return query;
+    }
+
+    bool available(const GpuFrame& frame) {
+        if (frame.zones.empty()) { return true; }
+
+        // queries complete in order so the last end covers the whole frame
+        if (frame.zones.back().end == 0) { return false; }
+
+        unsigned ready = 0;
+        glGetQueryObjectuiv(frame.zones.back().end, GL_QUERY_RESULT_AVAILABLE, &ready);
+        return ready != 0;
+    }
+
+    void resolve(GpuFrame& frame) {
+        if (frame.zones.empty()) { return; }
+
+        auto toCpu = [](GLuint64 time) { return uint64_t(int64_t(time) + gClockOffset); };
+
+        std::vector<ProfileZone> zones;
+        zones.reserve(frame.zones.size());
+        for (const auto& zone : frame.zones) {
+            // never closed, nothing to report
+            if (zone.end == 0) {
+                gFreeQueries.push_back(zone.begin);
+                continue;
+            }
+
+            GLuint64 begin = 0;
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(zone.begin, GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(zone.end, GL_QUERY_RESULT, &end);
+            zones.push_back({ zone.name, toCpu(begin), toCpu(end), 0, zone.depth });
+
+            gFreeQueries.push_back(zone.begin);
+            gFreeQueries.push_back(zone.end);
+        }
+
+        profileSubmitGpuZones(frame.index, zones);
+        frame.zones.clear();
+    }
+}
+
+void profileGpuInit() {
+    if (gReady) { return; }
+
+    calibrate();
+    gReady = true;
+}
+
+void profileGpuShutdown() {
+    if (!gReady) { return; }
+
+    for (auto& frame : gFrames) {
+        frame.zones.clear();
+    }
+
+    glDeleteQueries(GLsizei(gAllQueries.size()), gAllQueries.data());
+    gAllQueries.clear();
+    gFreeQueries.clear();
+    gReady = false;
+}
+
+void profileGpuEndFrame(uint64_t index) {
+    if (!gReady) { return; }
+
+    gFrames[gCurrent].index = index;
+    gCurrent = (gCurrent + 1) % kGpuLatency;
+
+    // pick up whatever the gpu already finished without waiting on it
+    for (size_t i = 1; i < kGpuLatency; i++) {
+        auto& frame = gFrames[(gCurrent + i) % kGpuLatency];
+        if (available(frame)) {
+            resolve(frame);
+        }
+    }
+
+    // the slot about to be reused has to be read back now, this only
+    // blocks when the gpu is more than kGpuLatency frames behind
+    resolve(gFrames[gCurrent]);
+
+    // the two clocks drift apart slowly, resync every second or so
+    if (index - gCalibratedFrame >= 64) {
+        calibrate();
+        gCalibratedFrame = index;
+    }
+}
+
+void profileGpuFlush() {
+    if (!gReady) { return; }
+
+    // the open slot belongs to a frame that hasnt ended yet
+    for (size_t i = 1; i < kGpuLatency; i++) {
+        resolve(gFrames[(gCurrent + i) % kGpuLatency]);
+    }
+}
+
+uint32_t profileGpuBegin(const char *name) {
+    if (!gReady || !profileEnabled()) { return kNoZone; }
+
+    auto& zones = gFrames[gCurrent].zones;
+    GpuZone zone = { name, allocQuery(), 0, gDepth++ };
+    glQueryCounter(zone.begin, GL_TIMESTAMP);
+
+    zones.push_back(zone);
+    return uint32_t(gCurrent) << kSlotShift | uint32_t(zones.size() - 1);
+}
+
+void profileGpuEnd(uint32_t zone) {
+    if (zone == kNoZone) { return; }
+
+    auto& it = gFrames[zone >> kSlotShift].zones[zone & ((1u << kSlotShift) - 1)];
+    it.end = allocQuery();
+    glQueryCounter(it.end, GL_TIMESTAMP);
+    gDepth--;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+// hashing and bit mixing, none of it cryptographic
+
+// fnv-1a, used for cache keys and asset content hashes
+
+constexpr uint64_t kFnvBasis = 0xcbf29ce484222325ull;
+constexpr uint64_t kFnvPrime = 0x100000001b3ull;
+
+constexpr uint64_t fnv1a(std::string_view data, uint64_t hash = kFnvBasis) {
+    for (char c : data) {
+        hash ^= uint8_t(c);
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+inline uint64_t fnv1a(std::span<const std::byte> data, uint64_t hash = kFnvBasis) {
+    for (std::byte b : data) {
+        hash ^= uint8_t(b);
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+// lowbias32 by chris wellons, a good 32 bit integer mixer
+constexpr uint32_t mix32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// the splitmix64 finaliser
+constexpr uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+// counter based random stream, the n-th draw is a pure function of (key, n)
+// so walkers can be split between threads without changing the output
+struct CounterStream {
+    uint32_t lo;
+    uint32_t hi;
+
+    constexpr uint32_t at(uint32_t counter) const {
+        return mix32(mix32(counter + lo) ^ hi);
+    }
+};
+
+constexpr CounterStream makeCounterStream(uint64_t seed, uint64_t walker) {
+    uint64_t key = mix64(seed ^ mix64(walker + 0x9e3779b97f4a7c15ull));
+    return { uint32_t(key), uint32_t(key >> 32) };
+}
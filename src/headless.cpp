@@ -0,0 +1,150 @@
+#include "headless.h"
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+
+#if HELLO_EGL
+#   include <EGL/egl.h>
+#   include <EGL/eglext.h>
+#endif
+
+#include <iostream>
+
+namespace {
+#if HELLO_EGL
+    EGLDisplay gDisplay = EGL_NO_DISPLAY;
+    EGLContext gContext = EGL_NO_CONTEXT;
+    unsigned gFramebuffer = 0;
+    unsigned gColour = 0;
+
+    bool createEglContext(unsigned width, unsigned height) {
+        auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay == nullptr) {
+            std::cout << "EGL: eglGetPlatformDisplayEXT is not supported" << std::endl;
+            return false;
+        }
+
+        gDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (gDisplay == EGL_NO_DISPLAY || !eglInitialize(gDisplay, nullptr, nullptr)) {
+            std::cout << "EGL: no surfaceless display" << std::endl;
+            return false;
+        }
+
+        eglBindAPI(EGL_OPENGL_API);
+
+        const EGLint configAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+        EGLConfig config = nullptr;
+        EGLint configs = 0;
+        eglChooseConfig(gDisplay, configAttribs, &config, 1, &configs);
+
+        const EGLint contextAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 3,
+            EGL_CONTEXT_MINOR_VERSION, 3,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+
+        // surfaceless contexts dont need a config, mesa hands out none for them
+        gContext = eglCreateContext(gDisplay, configs ? config : nullptr, EGL_NO_CONTEXT, contextAttribs);
+        if (gContext == EGL_NO_CONTEXT || !eglMakeCurrent(gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, gContext)) {
+            std::cout << "EGL: failed to create a 3.3 core context" << std::endl;
+            return false;
+        }
+
+        if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return false;
+        }
+
+        // there is no default framebuffer so everything goes into this one
+        glGenRenderbuffers(1, &gColour);
+        glBindRenderbuffer(GL_RENDERBUFFER, gColour);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, GLsizei(width), GLsizei(height));
+
+        glGenFramebuffers(1, &gFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, gFramebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, gColour);
+        glViewport(0, 0, GLsizei(width), GLsizei(height));
+
+        return true;
+    }
+
+    void destroyEglContext() {
+        if (gContext == EGL_NO_CONTEXT) { return; }
+
+        glDeleteFramebuffers(1, &gFramebuffer);
+        glDeleteRenderbuffers(1, &gColour);
+
+        eglMakeCurrent(gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(gDisplay, gContext);
+        eglTerminate(gDisplay);
+        gContext = EGL_NO_CONTEXT;
+        gDisplay = EGL_NO_DISPLAY;
+    }
+#endif
+}
+
+GLFWwindow *createHeadlessWindow(unsigned width, unsigned height) {
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+
+    if (GLFWwindow *window = glfwCreateWindow(int(width), int(height), "hello", nullptr, nullptr)) {
+        glfwMakeContextCurrent(window);
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            glfwDestroyWindow(window);
+            return nullptr;
+        }
+
+        return window;
+    }
+
+#if HELLO_EGL
+    // imgui still wants a window for input, it just doesnt get a context
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    GLFWwindow *window = glfwCreateWindow(int(width), int(height), "hello", nullptr, nullptr);
+    if (window == nullptr) {
+        return nullptr;
+    }
+
+    if (!createEglContext(width, height)) {
+        destroyEglContext();
+        glfwDestroyWindow(window);
+        return nullptr;
+    }
+
+    return window;
+#else
+    return nullptr;
+#endif
+}
+
+void presentHeadless(GLFWwindow *window) {
+#if HELLO_EGL
+    if (gContext != EGL_NO_CONTEXT) {
+        glFinish();
+        return;
+    }
+#endif
+
+    glfwSwapBuffers(window);
+}
+
+void makeHeadlessCurrent(GLFWwindow *window, bool current) {
+#if HELLO_EGL
+    if (gContext != EGL_NO_CONTEXT) {
+        eglMakeCurrent(gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, current ? gContext : EGL_NO_CONTEXT);
+        return;
+    }
+#endif
+
+    glfwMakeContextCurrent(current ? window : nullptr);
+}
+
+void destroyHeadlessWindow(GLFWwindow *window) {
+#if HELLO_EGL
+    destroyEglContext();
+#endif
+
+    glfwDestroyWindow(window);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+struct GLFWwindow;
+
+// a window on glfw's null platform for running without a display. the
+// context comes from osmesa when glfw can find it, otherwise from a
+// surfaceless egl context that draws into a framebuffer object. on success
+// the context is current and gl is loaded. call glfwInit with the null
+// platform hint before this
+GLFWwindow *createHeadlessWindow(unsigned width, unsigned height);
+
+// swap buffers, or just wait for the frame when there is no default framebuffer
+void presentHeadless(GLFWwindow *window);
+
+// make the headless context current on the calling thread, or release it
+void makeHeadlessCurrent(GLFWwindow *window, bool current);
+
+void destroyHeadlessWindow(GLFWwindow *window);
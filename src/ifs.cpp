@@ -0,0 +1,270 @@
+#include "ifs.h"
+
+#include "chaos.h"
+#include "hash.h"
+#include "parallel.h"
+#include "profile.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // walkers per thread, stepped together to hide the latency of each step
+    constexpr size_t kLanes = 8;
+
+    // steps a walker takes before it starts recording, enough for the
+    // presets to settle onto their attractor
+    constexpr unsigned kWarmup = 64;
+
+    constexpr AffineMap sierpinskiMap(const Vertex2& corner) {
+        return { 0.5f, 0.f, 0.f, 0.5f, corner.position.x * 0.5f, corner.position.y * 0.5f, 1.f, corner.colour };
+    }
+
+    // the same triangle as the chaos game, halfway towards a corner
+    constexpr auto kSierpinski = std::to_array<AffineMap>({
+        sierpinskiMap(kSierpinskiCorners[0]),
+        sierpinskiMap(kSierpinskiCorners[1]),
+        sierpinskiMap(kSierpinskiCorners[2])
+    });
+
+    constexpr auto kFern = std::to_array<AffineMap>({
+        { 0.f, 0.f, 0.f, 0.16f, 0.f, 0.f, 0.01f, { 0.5f, 0.35f, 0.1f } },
+        { 0.85f, 0.04f, -0.04f, 0.85f, 0.f, 1.6f, 0.85f, { 0.2f, 0.8f, 0.2f } },
+        { 0.2f, -0.26f, 0.23f, 0.22f, 0.f, 1.6f, 0.07f, { 0.7f, 0.9f, 0.2f } },
+        { -0.15f, 0.28f, 0.26f, 0.24f, 0.f, 0.44f, 0.07f, { 0.1f, 0.6f, 0.5f } }
+    });
+
+    constexpr auto kDragon = std::to_array<AffineMap>({
+        { 0.5f, -0.5f, 0.5f, 0.5f, 0.f, 0.f, 1.f, { 1.f, 0.4f, 0.1f } },
+        { -0.5f, -0.5f, 0.5f, -0.5f, 1.f, 0.f, 1.f, { 0.1f, 0.5f, 1.f } }
+    });
+
+    const auto kPresets = std::to_array<IfsPreset>({
+        { "Sierpinski", kSierpinski },
+        { "Fern", kFern },
+        { "Dragon", kDragon }
+    });
+
+    struct Lanes {
+        float x[kLanes];
+        float y[kLanes];
+        float r[kLanes];
+        float g[kLanes];
+        float b[kLanes];
+    };
+
+    // one thread worth of walkers, `record` is called for every step after warmup
+    template<typename F>
+    void walk(std::span<const AffineMap> maps, CounterStream *streams, uint64_t steps, F&& record) {
+        MapPicker picker(maps);
+
+        Lanes state = {};
+        for (size_t lane = 0; lane < kLanes; lane++) {
+            state.r[lane] = state.g[lane] = state.b[lane] = 0.5f;
+        }
+
+        uint32_t bits[kLanes] = {};
+        for (uint64_t step = 0; step < steps + kWarmup; step++) {
+            // each draw feeds two steps, 16 bits each
+            if (step % 2 == 0) {
+                for (size_t lane = 0; lane < kLanes; lane++) {
+                    bits[lane] = streams[lane].at(uint32_t(step / 2));
+                }
+            } else {
+                for (size_t lane = 0; lane < kLanes; lane++) {
+                    bits[lane] >>= 16;
+                }
+            }
+
+            for (size_t lane = 0; lane < kLanes; lane++) {
+                const auto& map = maps[picker.pick(bits[lane])];
+                float x = state.x[lane];
+                float y = state.y[lane];
+
+                state.x[lane] = map.a * x + map.b * y + map.e;
+                state.y[lane] = map.c * x + map.d * y + map.f;
+                state.r[lane] = (state.r[lane] + map.colour.r) * 0.5f;
+                state.g[lane] = (state.g[lane] + map.colour.g) * 0.5f;
+                state.b[lane] = (state.b[lane] + map.colour.b) * 0.5f;
+            }
+
+            if (step >= kWarmup) {
+                for (size_t lane = 0; lane < kLanes; lane++) {
+                    record(state, lane);
+                }
+            }
+        }
+    }
+}
+
+MapPicker::MapPicker(std::span<const AffineMap> maps) : count(std::min(maps.size(), kMaxAffineMaps)) {
+    float sum = 0.f;
+    for (size_t i = 0; i < count; i++) {
+        sum += std::max(maps[i].weight, 0.f);
+    }
+
+    float running = 0.f;
+    for (size_t i = 0; i < count; i++) {
+        running += std::max(maps[i].weight, 0.f);
+        cumulative[i] = sum > 0.f ? uint32_t(running / sum * 65536.f) : uint32_t((i + 1) * 65536 / count);
+    }
+}
+
+std::span<const IfsPreset> ifsPresets() {
+    return kPresets;
+}
+
+Bounds2 ifsBounds(std::span<const AffineMap> maps, float aspect) {
+    if (maps.empty()) { return { -1.f, -1.f, 1.f, 1.f }; }
+
+    CounterStream streams[kLanes];
+    for (size_t lane = 0; lane < kLanes; lane++) {
+        streams[lane] = makeCounterStream(0, lane);
+    }
+
+    Bounds2 bounds = { INFINITY, INFINITY, -INFINITY, -INFINITY };
+    walk(maps, streams, 1 << 13, [&](const Lanes& state, size_t lane) {
+        bounds.minX = std::min(bounds.minX, state.x[lane]);
+        bounds.minY = std::min(bounds.minY, state.y[lane]);
+        bounds.maxX = std::max(bounds.maxX, state.x[lane]);
+        bounds.maxY = std::max(bounds.maxY, state.y[lane]);
+    });
+
+    // a little margin, then grow whichever side is short of the aspect ratio
+    float width = std::max(bounds.maxX - bounds.minX, 1e-6f) * 1.05f;
+    float height = std::max(bounds.maxY - bounds.minY, 1e-6f) * 1.05f;
+    if (aspect <= 0.f) {
+        // keep the natural shape
+    } else if (width / height < aspect) {
+        width = height * aspect;
+    } else {
+        height = width / aspect;
+    }
+
+    float cx = (bounds.minX + bounds.maxX) * 0.5f;
+    float cy = (bounds.minY + bounds.maxY) * 0.5f;
+    return { cx - width * 0.5f, cy - height * 0.5f, cx + width * 0.5f, cy + height * 0.5f };
+}
+
+IfsHistogram::IfsHistogram(unsigned width, unsigned height)
+    : numWidth(width)
+    , numHeight(height)
+    , bounds({ -1.f, -1.f, 1.f, 1.f })
+    , total(size_t(width) * height)
+{ }
+
+void IfsHistogram::reset(std::span<const AffineMap> newMaps, Bounds2 newBounds, uint64_t newSeed) {
+    maps.assign(newMaps.begin(), newMaps.begin() + std::min(newMaps.size(), kMaxAffineMaps));
+    bounds = newBounds;
+    seed = newSeed;
+    calls = 0;
+    numIterations = 0;
+    numMaxHits = 0;
+
+    std::fill(total.begin(), total.end(), HistogramBin{});
+}
+
+void IfsHistogram::accumulate(uint64_t iterations, unsigned threads) {
+    if (maps.empty() || iterations == 0) { return; }
+
+    threads = std::max(threads, 1u);
+    while (scratch.size() < threads) {
+        scratch.emplace_back(total.size());
+    }
+
+    float scaleX = float(numWidth) / (bounds.maxX - bounds.minX);
+    float scaleY = float(numHeight) / (bounds.maxY - bounds.minY);
+    uint64_t callSeed = mix64(seed ^ mix64(calls + 1));
+
+    // lanes round each share up so a few more steps than asked for get recorded
+    auto shareOf = [&](unsigned thread) {
+        return iterations / threads + (thread < iterations % threads ? 1 : 0);
+    };
+
+    {
+        PROFILE_SCOPE("Accumulate");
+        parallelFor(threads, threads, [&](unsigned thread, size_t, size_t) {
+            PROFILE_SCOPE("Walk Histogram");
+
+            CounterStream streams[kLanes];
+            for (size_t lane = 0; lane < kLanes; lane++) {
+                streams[lane] = makeCounterStream(callSeed, uint64_t(thread) * kLanes + lane);
+            }
+
+            uint64_t steps = (shareOf(thread) + kLanes - 1) / kLanes;
+
+            auto& bins = scratch[thread];
+            walk(maps, streams, steps, [&](const Lanes& state, size_t lane) {
+                float fx = (state.x[lane] - bounds.minX) * scaleX;
+                float fy = (state.y[lane] - bounds.minY) * scaleY;
+
+                // also throws away nans from a system that diverges
+                if (!(fx >= 0.f && fx < float(numWidth) && fy >= 0.f && fy < float(numHeight))) {
+                    return;
+                }
+
+                auto& bin = bins[size_t(fy) * numWidth + size_t(fx)];
+                bin.hits += 1;
+                bin.r += state.r[lane];
+                bin.g += state.g[lane];
+                bin.b += state.b[lane];
+            });
+        });
+    }
+
+    // every thread histogram is folded into the total and cleared for the
+    // next call, each chunk of bins on its own thread
+    PROFILE_SCOPE("Merge Histograms");
+    std::vector<uint32_t> chunkMax(threads);
+    parallelFor(total.size(), threads, [&](unsigned chunk, size_t begin, size_t end) {
+        for (unsigned thread = 0; thread < threads; thread++) {
+            auto& bins = scratch[thread];
+            for (size_t i = begin; i < end; i++) {
+                total[i].hits += bins[i].hits;
+                total[i].r += bins[i].r;
+                total[i].g += bins[i].g;
+                total[i].b += bins[i].b;
+                bins[i] = {};
+            }
+        }
+
+        uint32_t maxHits = 0;
+        for (size_t i = begin; i < end; i++) {
+            maxHits = std::max(maxHits, total[i].hits);
+        }
+        chunkMax[chunk] = maxHits;
+    });
+
+    numMaxHits = *std::max_element(chunkMax.begin(), chunkMax.end());
+    for (unsigned thread = 0; thread < threads; thread++) {
+        numIterations += (shareOf(thread) + kLanes - 1) / kLanes * kLanes;
+    }
+    calls += 1;
+}
+
+void IfsHistogram::tonemap(std::span<Rgba8> out, float gamma, unsigned threads) const {
+    PROFILE_SCOPE("Tonemap");
+
+    // log density keeps the sparse outer parts visible next to the dense core
+    float scale = numMaxHits > 0 ? 1.f / std::log1p(float(numMaxHits)) : 0.f;
+    float exponent = 1.f / std::max(gamma, 0.01f);
+
+    parallelFor(std::min(out.size(), total.size()), threads, [&](unsigned, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const auto& bin = total[i];
+            if (bin.hits == 0) {
+                out[i] = { 0, 0, 0, 255 };
+                continue;
+            }
+
+            float density = std::pow(std::log1p(float(bin.hits)) * scale, exponent);
+            float weight = density / float(bin.hits);
+            out[i] = {
+                packUnorm8(bin.r * weight),
+                packUnorm8(bin.g * weight),
+                packUnorm8(bin.b * weight),
+                255
+            };
+        }
+    });
+}
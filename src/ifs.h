@@ -0,0 +1,104 @@
+#pragma once
+
+#include "vertex.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// iterated function systems rendered as a density histogram rather than
+// as points, so image quality no longer depends on how many vertices the
+// gpu can push
+
+// p' = | a b | p + | e |
+//      | c d |     | f |
+struct AffineMap {
+    float a, b, c, d;
+    float e, f;
+
+    // relative chance of picking this map, need not sum to 1
+    float weight;
+
+    // points move halfway towards this colour every time the map is picked
+    Colour colour;
+};
+
+constexpr size_t kMaxAffineMaps = 16;
+
+struct IfsPreset {
+    const char *name;
+    std::span<const AffineMap> maps;
+};
+
+// sierpinski first, built from kSierpinskiCorners
+std::span<const IfsPreset> ifsPresets();
+
+// picks a map from 16 random bits, map i is taken when the bits are
+// below cumulative[i] and not below any earlier threshold
+struct MapPicker {
+    MapPicker(std::span<const AffineMap> maps);
+
+    uint32_t pick(uint32_t bits) const {
+        bits &= 0xffff;
+
+        uint32_t index = 0;
+        for (size_t i = 0; i + 1 < count; i++) {
+            index += bits >= cumulative[i] ? 1 : 0;
+        }
+        return index;
+    }
+
+    uint32_t cumulative[kMaxAffineMaps];
+    size_t count;
+};
+
+// bounds of the attractor estimated from a short walk, padded out to `aspect`
+// (width over height) so the image isnt stretched, or just padded when
+// `aspect` is 0
+Bounds2 ifsBounds(std::span<const AffineMap> maps, float aspect);
+
+struct HistogramBin {
+    uint32_t hits;
+
+    // sum of the colours of every hit
+    float r, g, b;
+};
+
+// accumulates hits over many calls to accumulate. every thread walks into a
+// histogram of its own which is then merged into the total in parallel, so
+// walkers never contend. each thread histogram is as big as the total one
+struct IfsHistogram {
+    IfsHistogram(unsigned width, unsigned height);
+
+    // clear the histogram and start over with a different system
+    void reset(std::span<const AffineMap> maps, Bounds2 bounds, uint64_t seed = 0);
+
+    // run `iterations` more steps split between `threads` threads. the result
+    // only depends on the seed, the thread count and the calls made so far
+    void accumulate(uint64_t iterations, unsigned threads);
+
+    // log density tonemap, rows go bottom to top like gl textures.
+    // `out` must hold width * height texels
+    void tonemap(std::span<Rgba8> out, float gamma, unsigned threads) const;
+
+    unsigned width() const { return numWidth; }
+    unsigned height() const { return numHeight; }
+    uint64_t iterations() const { return numIterations; }
+    uint32_t maxHits() const { return numMaxHits; }
+    std::span<const HistogramBin> bins() const { return total; }
+
+private:
+    unsigned numWidth;
+    unsigned numHeight;
+
+    std::vector<AffineMap> maps;
+    Bounds2 bounds;
+    uint64_t seed = 0;
+    uint64_t calls = 0;
+
+    uint64_t numIterations = 0;
+    uint32_t numMaxHits = 0;
+
+    std::vector<HistogramBin> total;
+    std::vector<std::vector<HistogramBin>> scratch;
+};
@@ -1151,6 +1151,8 @@ static void    FreeWrapper(void* ptr, void* user_data)        { IM_UNUSED(user_d
 static ImGuiMemAllocFunc    GImAllocatorAllocFunc = MallocWrapper;
 static ImGuiMemFreeFunc     GImAllocatorFreeFunc = FreeWrapper;
 static void*                GImAllocatorUserData = NULL;
+static void*                GImAllocatorDrawListUserData = NULL;
+int                         GImDrawListAllocDepth = 0;     // See ImDrawListAllocScope
 
 //-----------------------------------------------------------------------------
 // [SECTION] USER FACING STRUCTURES (ImGuiStyle, ImGuiIO)
@@ -1827,7 +1829,7 @@ const char* ImStristr(const char* haystack, const char* haystack_end, const char
         {
             const char* b = needle + 1;
             for (const char* a = haystack + 1; b < needle_end; a++, b++)
-                if (ImToUpper(*a) != ImToUpper(*b))
+                if ((haystack_end && a >= haystack_end) || ImToUpper(*a) != ImToUpper(*b))
                     break;
             if (b == needle_end)
                 return haystack;
@@ -1973,53 +1975,228 @@ static const ImU32 GCrc32LookupTable[256] =
     0xBDBDF21C,0xCABAC28A,0x53B39330,0x24B4A3A6,0xBAD03605,0xCDD70693,0x54DE5729,0x23D967BF,0xB3667A2E,0xC4614AB8,0x5D681B02,0x2A6F2B94,0xB40BBE37,0xC30C8EA1,0x5A05DF1B,0x2D02EF8D,
 };
 
+// Slicing-by-8: table N is GCrc32LookupTable followed by N more zero bytes, so 8 bytes of input fold into the CRC with 8 independent
+// lookups instead of a chain of 8 dependent ones. Same CRC32 as the byte at a time loop, so IDs (and .ini contents) don't change.
+// Built at compile time from C++14 on. Before that a function static keeps them usable by static constructors and thread-safe.
+#if __cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+#define IMGUI_CRC32_SLICES_CONSTEXPR constexpr
+#else
+#define IMGUI_CRC32_SLICES_CONSTEXPR
+#endif
+
+struct ImCrc32SliceTables
+{
+    ImU32 Table[8][256];
+    IMGUI_CRC32_SLICES_CONSTEXPR ImCrc32SliceTables() : Table()
+    {
+        for (int n = 0; n < 256; n++)
+        {
+            ImU32 crc = GCrc32LookupTable[n];
+            Table[0][n] = crc;
+            for (int slice = 1; slice < 8; slice++)
+            {
+                crc = (crc >> 8) ^ GCrc32LookupTable[crc & 0xFF];
+                Table[slice][n] = crc;
+            }
+        }
+    }
+};
+
+#if __cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+static constexpr ImCrc32SliceTables GCrc32SliceTables;
+static inline const ImU32 (*ImCrc32Slices())[256] { return GCrc32SliceTables.Table; }
+#else
+static const ImU32 (*ImCrc32Slices())[256] { static const ImCrc32SliceTables slices; return slices.Table; }
+#endif
+
+// 8 bytes, little endian whatever the platform (compilers turn this into a plain load)
+static inline ImU64 ImCrc32Load8(const unsigned char* data)
+{
+    return (ImU64)data[0] | ((ImU64)data[1] << 8) | ((ImU64)data[2] << 16) | ((ImU64)data[3] << 24) |
+           ((ImU64)data[4] << 32) | ((ImU64)data[5] << 40) | ((ImU64)data[6] << 48) | ((ImU64)data[7] << 56);
+}
+
+static inline ImU32 ImCrc32Fold8(const ImU32 (*t)[256], ImU32 crc, ImU64 bytes)
+{
+    const ImU32 lo = crc ^ (ImU32)bytes;
+    const ImU32 hi = (ImU32)(bytes >> 32);
+    return t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+           t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+}
+
+// The CRC after 'n' more zero bytes. Zero bytes only contribute through the CRC itself, so that is at most 4 independent lookups per 8 bytes.
+static inline ImU32 ImCrc32ShiftZeros(const ImU32 (*t)[256], ImU32 crc, size_t n)
+{
+    for (; n >= 8; n -= 8)
+        crc = t[7][crc & 0xFF] ^ t[6][(crc >> 8) & 0xFF] ^ t[5][(crc >> 16) & 0xFF] ^ t[4][crc >> 24];
+    if (n >= 4)
+        return t[n - 1][crc & 0xFF] ^ t[n - 2][(crc >> 8) & 0xFF] ^ t[n - 3][(crc >> 16) & 0xFF] ^ t[n - 4][crc >> 24];
+    while (n-- != 0)
+        crc = (crc >> 8) ^ t[0][crc & 0xFF];
+    return crc;
+}
+
+// Any of the 8 bytes equal to '#', all 8 compared at once (zero byte test on the bytes xor'ed with '#')
+static inline bool ImCrc32HasHashByte(ImU64 bytes)
+{
+    bytes ^= 0x2323232323232323ULL;
+    return ((bytes - 0x0101010101010101ULL) & ~bytes & 0x8080808080808080ULL) != 0;
+}
+
+// ARMv8 crc32 instructions compute this very CRC (CRC32B..CRC32X use the reflected 0xEDB88320 polynomial of GCrc32LookupTable),
+// so on aarch64 __crc32d folds 8 bytes and __crc32b one byte with the same results as the tables. x86 has no instruction for it
+// (the SSE4.2 crc32 instruction computes CRC32-C, a different polynomial), so it stays on the tables.
+// Unless the compiler targets CRC already we ask the CPU at startup. Before that (e.g. from static constructors) the tables are used.
+#if defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__)) && (defined(__ARM_FEATURE_CRC32) || defined(__linux__))
+#define IMGUI_ENABLE_ARM_CRC32
+#include <arm_acle.h>
+#if defined(__ARM_FEATURE_CRC32)
+#define IM_CRC32_TARGET
+static const bool GCrc32Hardware = true;
+#else
+#include <sys/auxv.h>
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32 (1 << 7)
+#endif
+#if defined(__clang__)
+#define IM_CRC32_TARGET __attribute__((target("crc")))
+#else
+#define IM_CRC32_TARGET __attribute__((target("+crc")))
+#endif
+static const bool GCrc32Hardware = (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#endif
+
+IM_CRC32_TARGET static ImGuiID ImHashDataHardware(const unsigned char* data, size_t data_size, ImU32 crc)
+{
+    for (; data_size >= 8; data += 8, data_size -= 8)
+        crc = __crc32d(crc, ImCrc32Load8(data));
+    while (data_size-- != 0)
+        crc = __crc32b(crc, *data++);
+    return ~crc;
+}
+
+// Same as ImHashStrSized() and ImHashStr() below
+IM_CRC32_TARGET static ImGuiID ImHashStrSizedHardware(const unsigned char* data, size_t data_size, ImU32 crc, ImU32 seed)
+{
+    for (; data_size >= 8; data += 8, data_size -= 8)
+    {
+        const ImU64 bytes = ImCrc32Load8(data);
+        if (ImCrc32HasHashByte(bytes))
+            break;
+        crc = __crc32d(crc, bytes);
+    }
+    while (data_size-- != 0)
+    {
+        unsigned char c = *data++;
+        if (c == '#' && data_size >= 2 && data[0] == '#' && data[1] == '#')
+            crc = seed;
+        crc = __crc32b(crc, c);
+    }
+    return ~crc;
+}
+
+IM_CRC32_TARGET static ImGuiID ImHashStrHardware(const unsigned char* data, size_t data_size, ImU32 seed)
+{
+    if (data_size != 0)
+        return ImHashStrSizedHardware(data, data_size, seed, seed);
+    ImU32 crc = seed;
+    const unsigned char* first_blocks_end = data + 16;
+    while (unsigned char c = *data++)
+    {
+        if (c == '#' && data[0] == '#' && data[1] == '#')
+            crc = seed;
+        crc = __crc32b(crc, c);
+        if (data == first_blocks_end)
+            return (*data != 0) ? ImHashStrSizedHardware(data, strlen((const char*)data), crc, seed) : ~crc;
+    }
+    return ~crc;
+}
+#endif // #ifdef IMGUI_ENABLE_ARM_CRC32
+
 // Known size hash
 // It is ok to call ImHashData on a string with known length but the ### operator won't be supported.
-// FIXME-OPT: Replace with e.g. FNV1a hash? CRC32 pretty much randomly access 1KB. Need to do proper measurements.
 ImGuiID ImHashData(const void* data_p, size_t data_size, ImGuiID seed)
 {
     ImU32 crc = ~seed;
     const unsigned char* data = (const unsigned char*)data_p;
-    const ImU32* crc32_lut = GCrc32LookupTable;
+#ifdef IMGUI_ENABLE_ARM_CRC32
+    if (GCrc32Hardware)
+        return ImHashDataHardware(data, data_size, crc);
+#endif
+    const ImU32 (*crc32_lut)[256] = ImCrc32Slices();
+    for (; data_size >= 8; data += 8, data_size -= 8)
+        crc = ImCrc32Fold8(crc32_lut, crc, ImCrc32Load8(data));
     while (data_size-- != 0)
-        crc = (crc >> 8) ^ crc32_lut[(crc & 0xFF) ^ *data++];
+        crc = (crc >> 8) ^ crc32_lut[0][(crc & 0xFF) ^ *data++];
+    return ~crc;
+}
+
+// Rest of ImHashStr() once the size is known, carrying on from 'crc'
+static ImGuiID ImHashStrSized(const unsigned char* data, size_t data_size, ImU32 crc, ImU32 seed)
+{
+    const ImU32 (*crc32_lut)[256] = ImCrc32Slices();
+    for (; data_size >= 8; data += 8, data_size -= 8)
+    {
+        const ImU64 bytes = ImCrc32Load8(data);
+        if (ImCrc32HasHashByte(bytes))
+            break;
+        crc = ImCrc32Fold8(crc32_lut, crc, bytes);
+    }
+    while (data_size-- != 0)
+    {
+        unsigned char c = *data++;
+        if (c == '#' && data_size >= 2 && data[0] == '#' && data[1] == '#')
+            crc = seed;
+        crc = (crc >> 8) ^ crc32_lut[0][(crc & 0xFF) ^ c];
+    }
     return ~crc;
 }
 
 // Zero-terminated string hash, with support for ### to reset back to seed value
 // We support a syntax of "label###id" where only "###id" is included in the hash, and only "label" gets displayed.
 // Because this syntax is rarely used we are optimizing for the common case.
+// - Zero-terminated strings go a byte at a time for the first 16 bytes, checking for the terminator as we go. Most labels end there.
+//   (two bytes per iteration, so checking for the end of those 16 bytes doesn't slow down the short labels)
+// - Past that we find the terminator once and carry on as if the size had been given.
+// - Whole blocks of 8 bytes without a '#' are folded in at once.
+// - From the first block with a '#' in it (or the last, short block) we go a byte at a time.
 // - If we reach ### in the string we discard the hash so far and reset to the seed.
 // - We don't do 'current += 2; continue;' after handling ### to keep the code smaller/faster (measured ~10% diff in Debug build)
-// FIXME-OPT: Replace with e.g. FNV1a hash? CRC32 pretty much randomly access 1KB. Need to do proper measurements.
 ImGuiID ImHashStr(const char* data_p, size_t data_size, ImGuiID seed)
 {
     seed = ~seed;
-    ImU32 crc = seed;
     const unsigned char* data = (const unsigned char*)data_p;
-    const ImU32* crc32_lut = GCrc32LookupTable;
+#ifdef IMGUI_ENABLE_ARM_CRC32
+    if (GCrc32Hardware)
+        return ImHashStrHardware(data, data_size, seed);
+#endif
     if (data_size != 0)
-    {
-        while (data_size-- != 0)
-        {
-            unsigned char c = *data++;
-            if (c == '#' && data_size >= 2 && data[0] == '#' && data[1] == '#')
-                crc = seed;
-            crc = (crc >> 8) ^ crc32_lut[(crc & 0xFF) ^ c];
-        }
-    }
-    else
-    {
-        while (unsigned char c = *data++)
-        {
-            if (c == '#' && data[0] == '#' && data[1] == '#')
-                crc = seed;
-            crc = (crc >> 8) ^ crc32_lut[(crc & 0xFF) ^ c];
-        }
+        return ImHashStrSized(data, data_size, seed, seed);
+    ImU32 crc = seed;
+    const ImU32* crc32_lut = ImCrc32Slices()[0];
+    const unsigned char* first_blocks_end = data + 16;
+    while (unsigned char c = *data++)
+    {
+        if (c == '#' && data[0] == '#' && data[1] == '#')
+            crc = seed;
+        crc = (crc >> 8) ^ crc32_lut[(crc & 0xFF) ^ c];
+        if ((c = *data++) == 0)
+            break;
+        if (c == '#' && data[0] == '#' && data[1] == '#')
+            crc = seed;
+        crc = (crc >> 8) ^ crc32_lut[(crc & 0xFF) ^ c];
+        if (data == first_blocks_end)
+            return (*data != 0) ? ImHashStrSized(data, strlen((const char*)data), crc, seed) : ~crc;
     }
     return ~crc;
 }
 
+// Same value as ImHashStr(lit.Str, 0, seed), the label itself was hashed at compile time (see ImGuiLiteralID)
+ImGuiID ImHashLiteral(const ImGuiLiteralID& lit, ImGuiID seed)
+{
+    return ~(ImCrc32ShiftZeros(ImCrc32Slices(), ~seed, lit.HashedLen) ^ lit.Crc);
+}
+
 //-----------------------------------------------------------------------------
 // [SECTION] MISC HELPERS/UTILITIES (File functions)
 //-----------------------------------------------------------------------------
@@ -2375,27 +2552,156 @@ void ImGui::ColorConvertHSVtoRGB(float h, float s, float v, float& out_r, float&
 // Helper: Key->value storage
 //-----------------------------------------------------------------------------
 
-// std::lower_bound but without the bullshit
-static ImGuiStorage::ImGuiStoragePair* LowerBound(ImVector<ImGuiStorage::ImGuiStoragePair>& data, ImGuiID key)
+// Storage keeps Data as a plain vector of pairs. Small storages (most of them: one per window, per table etc.) are searched linearly.
+// Past IMGUI_STORAGE_LINEAR_MAX pairs an open addressing index is built alongside: a power of two table of slots, each holding a
+// Data index and a control byte with 7 bits of the key hash (or 0x80 when empty). Probing is linear and looks at 16 control bytes
+// at once, removal shifts the following pairs of the cluster back instead of leaving tombstones, so probe lengths never degrade.
+#define IMGUI_STORAGE_LINEAR_MAX    16
+#define IMGUI_STORAGE_GROUP         16
+#define IMGUI_STORAGE_EMPTY         0x80
+
+#if defined(IMGUI_ENABLE_SSE) && (defined(__SSE2__) || defined(__x86_64__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define IMGUI_STORAGE_SSE2
+#endif
+
+static inline int ImStorageLowestBit(unsigned int v)
 {
-    ImGuiStorage::ImGuiStoragePair* first = data.Data;
-    ImGuiStorage::ImGuiStoragePair* last = data.Data + data.Size;
-    size_t count = (size_t)(last - first);
-    while (count > 0)
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(v);
+#else
+    int n = 0;
+    while ((v & 1) == 0) { v >>= 1; n++; }
+    return n;
+#endif
+}
+
+static inline ImU64 ImStorageHash(ImGuiID key)
+{
+    return (ImU64)key * 0x9E3779B97F4A7C15ULL;
+}
+
+static inline unsigned char ImStorageHashCtrl(ImU64 hash) { return (unsigned char)((hash >> 25) & 0x7F); }
+static inline int ImStorageHashHome(ImU64 hash, int mask) { return (int)(hash >> 32) & mask; }
+
+// Bit n set for each of the 16 control bytes from 'ctrl' equal to 'h2', and for each one that is empty
+static inline void ImStorageMatchGroup(const unsigned char* ctrl, unsigned char h2, unsigned int* out_match, unsigned int* out_empty)
+{
+#ifdef IMGUI_STORAGE_SSE2
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    *out_match = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)h2)));
+    *out_empty = (unsigned int)_mm_movemask_epi8(group);
+#else
+    unsigned int match = 0, empty = 0;
+    for (int n = 0; n < IMGUI_STORAGE_GROUP; n++)
+    {
+        match |= (ctrl[n] == h2) ? (1u << n) : 0;
+        empty |= (ctrl[n] & IMGUI_STORAGE_EMPTY) ? (1u << n) : 0;
+    }
+    *out_match = match;
+    *out_empty = empty;
+#endif
+}
+
+static inline void ImStorageSetCtrl(ImGuiStorage* storage, int slot, unsigned char ctrl)
+{
+    storage->IndexCtrl.Data[slot] = ctrl;
+    if (slot < IMGUI_STORAGE_GROUP - 1)
+        storage->IndexCtrl.Data[storage->IndexSlots.Size + slot] = ctrl;
+}
+
+// Slot holding 'key', or -1
+static int ImStorageFindSlot(const ImGuiStorage* storage, ImGuiID key)
+{
+    const int mask = storage->IndexSlots.Size - 1;
+    const ImU64 hash = ImStorageHash(key);
+    const unsigned char h2 = ImStorageHashCtrl(hash);
+    int pos = ImStorageHashHome(hash, mask);
+    for (;;)
     {
-        size_t count2 = count >> 1;
-        ImGuiStorage::ImGuiStoragePair* mid = first + count2;
-        if (mid->key < key)
+        unsigned int match, empty;
+        ImStorageMatchGroup(storage->IndexCtrl.Data + pos, h2, &match, &empty);
+
+        // The key can only be before the first empty slot
+        if (empty != 0)
+            match &= (empty & (0u - empty)) - 1;
+        while (match != 0)
         {
-            first = ++mid;
-            count -= count2 + 1;
+            const int slot = (pos + ImStorageLowestBit(match)) & mask;
+            if (storage->Data.Data[storage->IndexSlots.Data[slot]].key == key)
+                return slot;
+            match &= match - 1;
         }
-        else
+        if (empty != 0)
+            return -1;
+        pos = (pos + IMGUI_STORAGE_GROUP) & mask;
+    }
+}
+
+// Index into Data of the pair for 'key', or -1
+static int ImStorageFind(const ImGuiStorage* storage, ImGuiID key)
+{
+    if (storage->IndexSlots.Size == 0)
+    {
+        for (int n = 0; n < storage->Data.Size; n++)
+            if (storage->Data.Data[n].key == key)
+                return n;
+        return -1;
+    }
+    const int slot = ImStorageFindSlot(storage, key);
+    return (slot != -1) ? storage->IndexSlots.Data[slot] : -1;
+}
+
+// Point the first empty slot in the probe sequence of Data[data_idx] at it
+static void ImStorageIndexPair(ImGuiStorage* storage, int data_idx)
+{
+    const int mask = storage->IndexSlots.Size - 1;
+    const ImU64 hash = ImStorageHash(storage->Data.Data[data_idx].key);
+    int pos = ImStorageHashHome(hash, mask);
+    for (;;)
+    {
+        unsigned int match, empty;
+        ImStorageMatchGroup(storage->IndexCtrl.Data + pos, 0, &match, &empty);
+        if (empty != 0)
         {
-            count = count2;
+            const int slot = (pos + ImStorageLowestBit(empty)) & mask;
+            ImStorageSetCtrl(storage, slot, ImStorageHashCtrl(hash));
+            storage->IndexSlots.Data[slot] = data_idx;
+            return;
         }
+        pos = (pos + IMGUI_STORAGE_GROUP) & mask;
     }
-    return first;
+}
+
+// Rebuild the index for every pair in Data, dropping it while the storage is small enough to be searched linearly
+static void ImStorageRebuildIndex(ImGuiStorage* storage)
+{
+    if (storage->Data.Size <= IMGUI_STORAGE_LINEAR_MAX)
+    {
+        storage->IndexCtrl.clear();
+        storage->IndexSlots.clear();
+        return;
+    }
+
+    // Stay under 3/4 full so unsuccessful probes rarely go past a group or two
+    int capacity = ImUpperPowerOfTwo(storage->Data.Size + storage->Data.Size / 3 + 1);
+    capacity = ImMax(capacity, IMGUI_STORAGE_LINEAR_MAX * 4);
+    storage->IndexSlots.resize(capacity);
+    storage->IndexCtrl.resize(capacity + IMGUI_STORAGE_GROUP - 1);
+    memset(storage->IndexCtrl.Data, IMGUI_STORAGE_EMPTY, (size_t)storage->IndexCtrl.Size);
+    for (int n = 0; n < storage->Data.Size; n++)
+        ImStorageIndexPair(storage, n);
+}
+
+// Append a pair for a key that isn't stored yet
+static ImGuiStorage::ImGuiStoragePair* ImStorageInsert(ImGuiStorage* storage, const ImGuiStorage::ImGuiStoragePair& pair)
+{
+    storage->Data.push_back(pair);
+    const int size = storage->Data.Size;
+    if (storage->IndexSlots.Size == 0 ? size > IMGUI_STORAGE_LINEAR_MAX : size * 4 > storage->IndexSlots.Size * 3)
+        ImStorageRebuildIndex(storage);
+    else if (storage->IndexSlots.Size != 0)
+        ImStorageIndexPair(storage, size - 1);
+    return &storage->Data.back();
 }
 
 // For quicker full rebuild of a storage (instead of an incremental one), you may add all your contents and then sort once.
@@ -2412,14 +2718,15 @@ void ImGuiStorage::BuildSortByKey()
         }
     };
     ImQsort(Data.Data, (size_t)Data.Size, sizeof(ImGuiStoragePair), StaticFunc::PairComparerByID);
+    ImStorageRebuildIndex(this);
 }
 
 int ImGuiStorage::GetInt(ImGuiID key, int default_val) const
 {
-    ImGuiStoragePair* it = LowerBound(const_cast<ImVector<ImGuiStoragePair>&>(Data), key);
-    if (it == Data.end() || it->key != key)
+    const int idx = ImStorageFind(this, key);
+    if (idx == -1)
         return default_val;
-    return it->val_i;
+    return Data.Data[idx].val_i;
 }
 
 bool ImGuiStorage::GetBool(ImGuiID key, bool default_val) const
@@ -2429,27 +2736,27 @@ bool ImGuiStorage::GetBool(ImGuiID key, bool default_val) const
 
 float ImGuiStorage::GetFloat(ImGuiID key, float default_val) const
 {
-    ImGuiStoragePair* it = LowerBound(const_cast<ImVector<ImGuiStoragePair>&>(Data), key);
-    if (it == Data.end() || it->key != key)
+    const int idx = ImStorageFind(this, key);
+    if (idx == -1)
         return default_val;
-    return it->val_f;
+    return Data.Data[idx].val_f;
 }
 
 void* ImGuiStorage::GetVoidPtr(ImGuiID key) const
 {
-    ImGuiStoragePair* it = LowerBound(const_cast<ImVector<ImGuiStoragePair>&>(Data), key);
-    if (it == Data.end() || it->key != key)
+    const int idx = ImStorageFind(this, key);
+    if (idx == -1)
         return NULL;
-    return it->val_p;
+    return Data.Data[idx].val_p;
 }
 
 // References are only valid until a new value is added to the storage. Calling a Set***() function or a Get***Ref() function invalidates the pointer.
 int* ImGuiStorage::GetIntRef(ImGuiID key, int default_val)
 {
-    ImGuiStoragePair* it = LowerBound(Data, key);
-    if (it == Data.end() || it->key != key)
-        it = Data.insert(it, ImGuiStoragePair(key, default_val));
-    return &it->val_i;
+    const int idx = ImStorageFind(this, key);
+    if (idx == -1)
+        return &ImStorageInsert(this, ImGuiStoragePair(key, default_val))->val_i;
+    return &Data.Data[idx].val_i;
 }
 
 bool* ImGuiStorage::GetBoolRef(ImGuiID key, bool default_val)
@@ -2459,30 +2766,27 @@ bool* ImGuiStorage::GetBoolRef(ImGuiID key, bool default_val)
 
 float* ImGuiStorage::GetFloatRef(ImGuiID key, float default_val)
 {
-    ImGuiStoragePair* it = LowerBound(Data, key);
-    if (it == Data.end() || it->key != key)
-        it = Data.insert(it, ImGuiStoragePair(key, default_val));
-    return &it->val_f;
+    const int idx = ImStorageFind(this, key);
+    if (idx == -1)
+        return &ImStorageInsert(this, ImGuiStoragePair(key, default_val))->val_f;
+    return &Data.Data[idx].val_f;
 }
 
 void** ImGuiStorage::GetVoidPtrRef(ImGuiID key, void* default_val)
 {
-    ImGuiStoragePair* it = LowerBound(Data, key);
-    if (it == Data.end() || it->key != key)
-        it = Data.insert(it, ImGuiStoragePair(key, default_val));
-    return &it->val_p;
+    const int idx = ImStorageFind(this, key);
+    if (idx == -1)
+        return &ImStorageInsert(this, ImGuiStoragePair(key, default_val))->val_p;
+    return &Data.Data[idx].val_p;
 }
 
-// FIXME-OPT: Need a way to reuse the result of lower_bound when doing GetInt()/SetInt() - not too bad because it only happens on explicit interaction (maximum one a frame)
 void ImGuiStorage::SetInt(ImGuiID key, int val)
 {
-    ImGuiStoragePair* it = LowerBound(Data, key);
-    if (it == Data.end() || it->key != key)
-    {
-        Data.insert(it, ImGuiStoragePair(key, val));
-        return;
-    }
-    it->val_i = val;
+    const int idx = ImStorageFind(this, key);
+    if (idx == -1)
+        ImStorageInsert(this, ImGuiStoragePair(key, val));
+    else
+        Data.Data[idx].val_i = val;
 }
 
 void ImGuiStorage::SetBool(ImGuiID key, bool val)
@@ -2492,24 +2796,62 @@ void ImGuiStorage::SetBool(ImGuiID key, bool val)
 
 void ImGuiStorage::SetFloat(ImGuiID key, float val)
 {
-    ImGuiStoragePair* it = LowerBound(Data, key);
-    if (it == Data.end() || it->key != key)
-    {
-        Data.insert(it, ImGuiStoragePair(key, val));
-        return;
-    }
-    it->val_f = val;
+    const int idx = ImStorageFind(this, key);
+    if (idx == -1)
+        ImStorageInsert(this, ImGuiStoragePair(key, val));
+    else
+        Data.Data[idx].val_f = val;
 }
 
 void ImGuiStorage::SetVoidPtr(ImGuiID key, void* val)
 {
-    ImGuiStoragePair* it = LowerBound(Data, key);
-    if (it == Data.end() || it->key != key)
+    const int idx = ImStorageFind(this, key);
+    if (idx == -1)
+        ImStorageInsert(this, ImGuiStoragePair(key, val));
+    else
+        Data.Data[idx].val_p = val;
+}
+
+bool ImGuiStorage::Remove(ImGuiID key)
+{
+    if (IndexSlots.Size == 0)
     {
-        Data.insert(it, ImGuiStoragePair(key, val));
-        return;
+        const int idx = ImStorageFind(this, key);
+        if (idx == -1)
+            return false;
+        Data.Data[idx] = Data.back();
+        Data.pop_back();
+        return true;
+    }
+
+    int hole = ImStorageFindSlot(this, key);
+    if (hole == -1)
+        return false;
+    const int idx = IndexSlots.Data[hole];
+
+    // Backward shift: walk the rest of the cluster and move back every pair whose home slot isn't between the hole and where it sits
+    const int mask = IndexSlots.Size - 1;
+    for (int slot = (hole + 1) & mask; IndexCtrl.Data[slot] != IMGUI_STORAGE_EMPTY; slot = (slot + 1) & mask)
+    {
+        const int home = ImStorageHashHome(ImStorageHash(Data.Data[IndexSlots.Data[slot]].key), mask);
+        if (((slot - home) & mask) >= ((slot - hole) & mask))
+        {
+            ImStorageSetCtrl(this, hole, IndexCtrl.Data[slot]);
+            IndexSlots.Data[hole] = IndexSlots.Data[slot];
+            hole = slot;
+        }
+    }
+    ImStorageSetCtrl(this, hole, IMGUI_STORAGE_EMPTY);
+
+    // Move the last pair into the gap and repoint its slot
+    const int last = Data.Size - 1;
+    if (idx != last)
+    {
+        Data.Data[idx] = Data.Data[last];
+        IndexSlots.Data[ImStorageFindSlot(this, Data.Data[idx].key)] = idx;
     }
-    it->val_p = val;
+    Data.pop_back();
+    return true;
 }
 
 void ImGuiStorage::SetAllInt(int v)
@@ -2527,6 +2869,7 @@ ImGuiTextFilter::ImGuiTextFilter(const char* default_filter) //-V1077
 {
     InputBuf[0] = 0;
     CountGrep = 0;
+    MatchClassCount = 0;
     if (default_filter)
     {
         ImStrncpy(InputBuf, default_filter, IM_ARRAYSIZE(InputBuf));
@@ -2562,6 +2905,17 @@ void ImGuiTextFilter::ImGuiTextRange::split(char separator, ImVector<ImGuiTextRa
         out->push_back(ImGuiTextRange(wb, we));
 }
 
+// The characters a filter looks for: 0 when there are none (an empty filter, or a lone "-" which never matches), 1 for a grep term, 2 for a subtract term
+static int ImGuiTextFilterGetTerm(const ImGuiTextFilter::ImGuiTextRange& f, const char** out_b, const char** out_e)
+{
+    const char* term_b = (!f.empty() && f.b[0] == '-') ? f.b + 1 : f.b;
+    if (term_b >= f.e)
+        return 0;
+    *out_b = term_b;
+    *out_e = f.e;
+    return (term_b != f.b) ? 2 : 1;
+}
+
 void ImGuiTextFilter::Build()
 {
     Filters.resize(0);
@@ -2580,33 +2934,135 @@ void ImGuiTextFilter::Build()
         if (f.b[0] != '-')
             CountGrep += 1;
     }
+
+    // Compile all terms into one Aho-Corasick automaton over case folded character classes.
+    // A text is then read once, tracking the earliest term (in filter order) found in it, which is the one the
+    // term by term search would have stopped at. Grep and subtract terms go in the same automaton.
+    memset(MatchClass, 0, sizeof(MatchClass));
+    MatchClassCount = 1;
+    for (const ImGuiTextRange& f : Filters)
+    {
+        const char* term_b;
+        const char* term_e;
+        if (!ImGuiTextFilterGetTerm(f, &term_b, &term_e))
+            continue;
+        for (const char* p = term_b; p < term_e; p++)
+            if (MatchClass[(unsigned char)ImToUpper(*p)] == 0)
+                MatchClass[(unsigned char)ImToUpper(*p)] = (unsigned char)MatchClassCount++;
+    }
+    IM_ASSERT(MatchClassCount <= 256);
+    for (int c = 'a'; c <= 'z'; c++)
+        MatchClass[c] = MatchClass[c - 'a' + 'A'];
+
+    // Trie of the terms, state 0 is the root and 0 also stands for a missing child while building
+    const int classes = MatchClassCount;
+    MatchNext.resize(0);
+    MatchNext.resize(classes, 0);
+    MatchTerm.resize(0);
+    MatchTerm.push_back(0xFFFF);
+    int rank = 0;
+    for (const ImGuiTextRange& f : Filters)
+    {
+        const char* term_b;
+        const char* term_e;
+        const int term_type = ImGuiTextFilterGetTerm(f, &term_b, &term_e);
+        if (term_type == 0)
+            continue;
+        const bool exclude = (term_type == 2);
+        int state = 0;
+        for (const char* p = term_b; p < term_e; p++)
+        {
+            const int slot = state * classes + MatchClass[(unsigned char)*p];
+            if (MatchNext[slot] == 0)
+            {
+                MatchNext[slot] = (ImU32)MatchTerm.Size;
+                MatchNext.resize(MatchNext.Size + classes, 0);
+                MatchTerm.push_back(0xFFFF);
+            }
+            state = (int)MatchNext[slot];
+        }
+        MatchTerm[state] = ImMin(MatchTerm[state], (ImU16)(rank * 2 + (exclude ? 1 : 0)));
+        rank++;
+    }
+
+    // Breadth first: a state falls back to the longest proper suffix of it that is also in the trie, inheriting its
+    // earliest term, and missing children become the fallback's (already complete) transitions.
+    ImVector<int> fallback;
+    ImVector<int> queue;
+    fallback.resize(MatchTerm.Size, 0);
+    for (int c = 0; c < classes; c++)
+        if (MatchNext[c] != 0)
+            queue.push_back((int)MatchNext[c]);
+    for (int queue_n = 0; queue_n < queue.Size; queue_n++)
+    {
+        const int state = queue[queue_n];
+        for (int c = 0; c < classes; c++)
+        {
+            const int child = (int)MatchNext[state * classes + c];
+            const ImU32 fallback_next = MatchNext[fallback[state] * classes + c];
+            if (child == 0)
+            {
+                MatchNext[state * classes + c] = fallback_next;
+                continue;
+            }
+            fallback[child] = (int)fallback_next;
+            MatchTerm[child] = ImMin(MatchTerm[child], MatchTerm[fallback_next]);
+            queue.push_back(child);
+        }
+    }
+
+    // Premultiply and flag the transitions that complete a term, so matching only looks at MatchTerm[] on those
+    for (ImU32& next : MatchNext)
+        next = (next * classes) | (MatchTerm[next] != 0xFFFF ? 0x80000000 : 0);
 }
 
-bool ImGuiTextFilter::PassFilter(const char* text, const char* text_end) const
+// Earliest term found in the text (see MatchTerm), or 0xFFFF
+// At the root a byte that starts no term leads back to the root, so those are skipped without going through the automaton.
+// Those lookups don't depend on each other, unlike the transitions, which keeps the common case of text far from any term fast.
+unsigned int ImGuiTextFilter::MatchFirstTerm(const char* text, const char* text_end) const
 {
-    if (Filters.empty())
-        return true;
-
-    if (text == NULL)
-        text = "";
+    unsigned int first = 0xFFFF;
+    if (MatchNext.empty())
+        return first;
+    if (!text_end)
+        text_end = text + strlen(text);
 
-    for (const ImGuiTextRange& f : Filters)
+    const ImU32* match_next = MatchNext.Data;
+    const unsigned char* p = (const unsigned char*)text;
+    const unsigned char* p_end = (const unsigned char*)text_end;
+    ImU32 state = 0;
+    while (p < p_end)
     {
-        if (f.empty())
-            continue;
-        if (f.b[0] == '-')
+        if (state == 0)
         {
-            // Subtract
-            if (ImStristr(text, text_end, f.b + 1, f.e) != NULL)
-                return false;
+            while (p < p_end && match_next[MatchClass[*p]] == 0)
+                p++;
+            if (p == p_end)
+                break;
         }
-        else
+        state = match_next[(state & 0x7FFFFFFF) + MatchClass[*p++]];
+        if (state & 0x80000000)
         {
-            // Grep
-            if (ImStristr(text, text_end, f.b, f.e) != NULL)
-                return true;
+            first = ImMin(first, (unsigned int)MatchTerm[(state & 0x7FFFFFFF) / MatchClassCount]);
+            if (first <= 1)
+                break;
         }
     }
+    return first;
+}
+
+bool ImGuiTextFilter::PassFilter(const char* text, const char* text_end) const
+{
+    if (Filters.empty())
+        return true;
+
+    if (text == NULL)
+        text = "";
+
+    // The earliest term decides: found grep passes, found subtract fails
+    const unsigned int term = MatchFirstTerm(text, text_end);
+    if (term != 0xFFFF)
+        return (term & 1) == 0;
 
     // Implicit * grep
     if (CountGrep == 0)
@@ -2615,6 +3071,41 @@ bool ImGuiTextFilter::PassFilter(const char* text, const char* text_end) const
     return false;
 }
 
+struct ImGuiTextFilterBatch
+{
+    const ImGuiTextFilter*  Filter;
+    const char* const*      Texts;
+    const char* const*      TextEnds;
+    bool*                   Pass;
+};
+
+static void ImGuiTextFilterBatchFunc(int begin, int end, void* func_data)
+{
+    const ImGuiTextFilterBatch* batch = (const ImGuiTextFilterBatch*)func_data;
+    for (int n = begin; n < end; n++)
+        batch->Pass[n] = batch->Filter->PassFilter(batch->Texts[n], batch->TextEnds ? batch->TextEnds[n] : NULL);
+}
+
+void ImGuiTextFilter::PassFilterBatch(const char* const* texts, const char* const* text_ends, int count, ImVector<int>* out_indices, ImGuiParallelForFunc parallel_for, void* parallel_for_user_data) const
+{
+    if (parallel_for == NULL)
+    {
+        for (int n = 0; n < count; n++)
+            if (PassFilter(texts[n], text_ends ? text_ends[n] : NULL))
+                out_indices->push_back(n);
+        return;
+    }
+
+    // Chunks may finish in any order, each text gets its own flag and the indices are gathered in order after
+    ImVector<bool> pass;
+    pass.resize(count);
+    ImGuiTextFilterBatch batch = { this, texts, text_ends, pass.Data };
+    parallel_for(count, ImGuiTextFilterBatchFunc, &batch, parallel_for_user_data);
+    for (int n = 0; n < count; n++)
+        if (pass[n])
+            out_indices->push_back(n);
+}
+
 //-----------------------------------------------------------------------------
 // [SECTION] ImGuiTextBuffer, ImGuiTextIndex
 //-----------------------------------------------------------------------------
@@ -3547,6 +4038,11 @@ void ImGui::SetAllocatorFunctions(ImGuiMemAllocFunc alloc_func, ImGuiMemFreeFunc
     GImAllocatorUserData = user_data;
 }
 
+void ImGui::SetAllocatorDrawListUserData(void* user_data)
+{
+    GImAllocatorDrawListUserData = user_data;
+}
+
 // This is provided to facilitate copying allocators from one static/DLL boundary to another (e.g. retrieve default allocator of your executable address space)
 void ImGui::GetAllocatorFunctions(ImGuiMemAllocFunc* p_alloc_func, ImGuiMemFreeFunc* p_free_func, void** p_user_data)
 {
@@ -3806,6 +4302,16 @@ ImGuiID ImGuiWindow::GetID(int n)
     return id;
 }
 
+ImGuiID ImGuiWindow::GetID(const ImGuiLiteralID& lit)
+{
+    ImGuiID seed = IDStack.back();
+    ImGuiID id = ImHashLiteral(lit, seed);
+    ImGuiContext& g = *Ctx;
+    if (g.DebugHookIdInfo == id)
+        ImGui::DebugHookIdInfo(id, ImGuiDataType_String, lit.Str, NULL);
+    return id;
+}
+
 // This is only used in rare/specific situations to manufacture an ID out of nowhere.
 ImGuiID ImGuiWindow::GetIDFromRectangle(const ImRect& r_abs)
 {
@@ -4223,7 +4729,8 @@ float ImGui::CalcWrapWidthForPos(const ImVec2& pos, float wrap_pos_x)
 // IM_ALLOC() == ImGui::MemAlloc()
 void* ImGui::MemAlloc(size_t size)
 {
-    void* ptr = (*GImAllocatorAllocFunc)(size, GImAllocatorUserData);
+    void* user_data = (GImDrawListAllocDepth > 0 && GImAllocatorDrawListUserData != NULL) ? GImAllocatorDrawListUserData : GImAllocatorUserData;
+    void* ptr = (*GImAllocatorAllocFunc)(size, user_data);
 #ifndef IMGUI_DISABLE_DEBUG_TOOLS
     if (ImGuiContext* ctx = GImGui)
         DebugAllocHook(&ctx->DebugAllocInfo, ctx->FrameCount, ptr, size);
@@ -4883,6 +5390,7 @@ static inline void AddRootWindowToDrawData(ImGuiWindow* window)
 
 static void FlattenDrawDataIntoSingleLayer(ImDrawDataBuilder* builder)
 {
+    ImDrawListAllocScope alloc_scope;
     int n = builder->Layers[0]->Size;
     int full_size = n;
     for (int i = 1; i < IM_ARRAYSIZE(builder->Layers); i++)
@@ -7813,6 +8321,14 @@ void ImGui::PushID(int int_id)
     window->IDStack.push_back(id);
 }
 
+void ImGui::PushID(const ImGuiLiteralID& lit_id)
+{
+    ImGuiContext& g = *GImGui;
+    ImGuiWindow* window = g.CurrentWindow;
+    ImGuiID id = window->GetID(lit_id);
+    window->IDStack.push_back(id);
+}
+
 // Push a given id value ignoring the ID stack as a seed.
 void ImGui::PushOverrideID(ImGuiID id)
 {
@@ -7869,6 +8385,12 @@ ImGuiID ImGui::GetID(const void* ptr_id)
     return window->GetID(ptr_id);
 }
 
+ImGuiID ImGui::GetID(const ImGuiLiteralID& lit_id)
+{
+    ImGuiWindow* window = GImGui->CurrentWindow;
+    return window->GetID(lit_id);
+}
+
 bool ImGui::IsRectVisible(const ImVec2& size)
 {
     ImGuiWindow* window = GImGui->CurrentWindow;
@@ -14508,7 +15030,7 @@ void ImGui::DebugNodeFontGlyph(ImFont*, const ImFontGlyph* glyph)
 // [DEBUG] Display contents of ImGuiStorage
 void ImGui::DebugNodeStorage(ImGuiStorage* storage, const char* label)
 {
-    if (!TreeNode(label, "%s: %d entries, %d bytes", label, storage->Data.Size, storage->Data.size_in_bytes()))
+    if (!TreeNode(label, "%s: %d entries, %d bytes", label, storage->Data.Size, storage->Data.size_in_bytes() + storage->IndexCtrl.size_in_bytes() + storage->IndexSlots.size_in_bytes()))
         return;
     for (const ImGuiStorage::ImGuiStoragePair& p : storage->Data)
         BulletText("Key 0x%08X Value { i: %d }", p.key, p.val_i); // Important: we currently don't store a type, real value may not be integer.
@@ -38,7 +38,7 @@ Index of this file:
 // [SECTION] ImGuiStyle
 // [SECTION] ImGuiIO
 // [SECTION] Misc data structures (ImGuiInputTextCallbackData, ImGuiSizeCallbackData, ImGuiPayload, ImGuiTableSortSpecs, ImGuiTableColumnSortSpecs)
-// [SECTION] Helpers (ImGuiOnceUponAFrame, ImGuiTextFilter, ImGuiTextBuffer, ImGuiStorage, ImGuiListClipper, Math Operators, ImColor)
+// [SECTION] Helpers (ImGuiOnceUponAFrame, ImGuiTextFilter, ImGuiTextBuffer, ImGuiLiteralID, ImGuiStorage, ImGuiListClipper, Math Operators, ImColor)
 // [SECTION] Drawing API (ImDrawCallback, ImDrawCmd, ImDrawIdx, ImDrawVert, ImDrawChannel, ImDrawListSplitter, ImDrawFlags, ImDrawListFlags, ImDrawList, ImDrawData)
 // [SECTION] Font API (ImFontConfig, ImFontGlyph, ImFontGlyphRangesBuilder, ImFontAtlasFlags, ImFontAtlas, ImFont)
 // [SECTION] Viewports (ImGuiViewportFlags, ImGuiViewport)
@@ -86,6 +86,11 @@ Index of this file:
 #define IM_ARRAYSIZE(_ARR)          ((int)(sizeof(_ARR) / sizeof(*(_ARR))))     // Size of a static C-style array. Don't use on pointers!
 #define IM_UNUSED(_VAR)             ((void)(_VAR))                              // Used to silence "unused variable warnings". Often useful as asserts may be stripped out from final builds.
 #define IM_OFFSETOF(_TYPE,_MEMBER)  offsetof(_TYPE, _MEMBER)                    // Offset of _MEMBER within _TYPE. Standardized as offsetof() in C++11
+#if defined(__cpp_consteval) && __cpp_consteval >= 201811L
+#define IM_CONSTEVAL                consteval                                   // Forces compile-time evaluation where the compiler supports it (C++20), plain constexpr otherwise
+#else
+#define IM_CONSTEVAL                constexpr
+#endif
 #define IMGUI_CHECKVERSION()        ImGui::DebugCheckVersionAndDataLayout(IMGUI_VERSION, sizeof(ImGuiIO), sizeof(ImGuiStyle), sizeof(ImVec2), sizeof(ImVec4), sizeof(ImDrawVert), sizeof(ImDrawIdx))
 
 // Helper Macros - IM_FMTARGS, IM_FMTLIST: Apply printf-style warnings to our formatting functions.
@@ -153,6 +158,7 @@ struct ImGuiIO;                     // Main configuration and I/O between your a
 struct ImGuiInputTextCallbackData;  // Shared state of InputText() when using custom ImGuiInputTextCallback (rare/advanced use)
 struct ImGuiKeyData;                // Storage for ImGuiIO and IsKeyDown(), IsKeyPressed() etc functions.
 struct ImGuiListClipper;            // Helper to manually clip large list of items
+struct ImGuiLiteralID;              // Helper to hash a string literal label at compile time, accepted by PushID(), GetID(), Button(), TreeNode()
 struct ImGuiOnceUponAFrame;         // Helper for running a block of code not more than once a frame
 struct ImGuiPayload;                // User data payload for drag and drop operations
 struct ImGuiPlatformImeData;        // Platform IME data for io.SetPlatformImeDataFn() function.
@@ -251,6 +257,7 @@ typedef int     (*ImGuiInputTextCallback)(ImGuiInputTextCallbackData* data);
 typedef void    (*ImGuiSizeCallback)(ImGuiSizeCallbackData* data);              // Callback function for ImGui::SetNextWindowSizeConstraints()
 typedef void*   (*ImGuiMemAllocFunc)(size_t sz, void* user_data);               // Function signature for ImGui::SetAllocatorFunctions()
 typedef void    (*ImGuiMemFreeFunc)(void* ptr, void* user_data);                // Function signature for ImGui::SetAllocatorFunctions()
+typedef void    (*ImGuiParallelForFunc)(int count, void (*func)(int begin, int end, void* func_data), void* func_data, void* user_data); // Function signature for ImFontAtlas::ParallelFor and ImGuiTextFilter::PassFilterBatch(): call func() over chunks covering [0,count), on any threads, return once all are done
 
 // ImVec2: 2D vector used to store positions, sizes etc. [Compile-time configurable type]
 // This is a frequently used type in the API. Consider using IM_VEC2_CLASS_EXTRA to create implicit cast from/to our preferred type.
@@ -479,10 +486,12 @@ namespace ImGui
     IMGUI_API void          PushID(const char* str_id_begin, const char* str_id_end);       // push string into the ID stack (will hash string).
     IMGUI_API void          PushID(const void* ptr_id);                                     // push pointer into the ID stack (will hash pointer).
     IMGUI_API void          PushID(int int_id);                                             // push integer into the ID stack (will hash integer).
+    IMGUI_API void          PushID(const ImGuiLiteralID& lit_id);                           // push string literal into the ID stack (hashed at compile time, only combined with the ID stack at runtime).
     IMGUI_API void          PopID();                                                        // pop from the ID stack.
     IMGUI_API ImGuiID       GetID(const char* str_id);                                      // calculate unique ID (hash of whole ID stack + given parameter). e.g. if you want to query into ImGuiStorage yourself
     IMGUI_API ImGuiID       GetID(const char* str_id_begin, const char* str_id_end);
     IMGUI_API ImGuiID       GetID(const void* ptr_id);
+    IMGUI_API ImGuiID       GetID(const ImGuiLiteralID& lit_id);
 
     // Widgets: Text
     IMGUI_API void          TextUnformatted(const char* text, const char* text_end = NULL); // raw text without formatting. Roughly equivalent to Text("%s", text) but: A) doesn't require null terminated string if 'text_end' is specified, B) it's faster, no memory copy is done, no buffer size limits, recommended for long chunks of text.
@@ -504,6 +513,7 @@ namespace ImGui
     // - Most widgets return true when the value has been changed or when pressed/selected
     // - You may also use one of the many IsItemXXX functions (e.g. IsItemActive, IsItemHovered, etc.) to query widget state.
     IMGUI_API bool          Button(const char* label, const ImVec2& size = ImVec2(0, 0));   // button
+    IMGUI_API bool          Button(const ImGuiLiteralID& label, const ImVec2& size = ImVec2(0, 0)); // button with a string literal label, e.g. Button(ImGuiLiteralID("OK")), doesn't hash the label at runtime
     IMGUI_API bool          SmallButton(const char* label);                                 // button with FramePadding=(0,0) to easily embed within text
     IMGUI_API bool          InvisibleButton(const char* str_id, const ImVec2& size, ImGuiButtonFlags flags = 0); // flexible button behavior without the visuals, frequently useful to build custom behaviors using the public api (along with IsItemActive, IsItemHovered, etc.)
     IMGUI_API bool          ArrowButton(const char* str_id, ImGuiDir dir);                  // square button with an arrow shape
@@ -606,6 +616,7 @@ namespace ImGui
     // Widgets: Trees
     // - TreeNode functions return true when the node is open, in which case you need to also call TreePop() when you are finished displaying the tree node contents.
     IMGUI_API bool          TreeNode(const char* label);
+    IMGUI_API bool          TreeNode(const ImGuiLiteralID& label);                           // string literal label, doesn't hash the label at runtime
     IMGUI_API bool          TreeNode(const char* str_id, const char* fmt, ...) IM_FMTARGS(2);   // helper variation to easily decorelate the id from the displayed string. Read the FAQ about why and how to use ID. to align arbitrary text at the same level as a TreeNode() you can use Bullet().
     IMGUI_API bool          TreeNode(const void* ptr_id, const char* fmt, ...) IM_FMTARGS(2);   // "
     IMGUI_API bool          TreeNodeV(const char* str_id, const char* fmt, va_list args) IM_FMTLIST(2);
@@ -957,6 +968,7 @@ namespace ImGui
     //   for each static/DLL boundary you are calling from. Read "Context and Memory Allocators" section of imgui.cpp for more details.
     IMGUI_API void          SetAllocatorFunctions(ImGuiMemAllocFunc alloc_func, ImGuiMemFreeFunc free_func, void* user_data = NULL);
     IMGUI_API void          GetAllocatorFunctions(ImGuiMemAllocFunc* p_alloc_func, ImGuiMemFreeFunc* p_free_func, void** p_user_data);
+    IMGUI_API void          SetAllocatorDrawListUserData(void* user_data);  // Allocations made while a draw list grows its buffers get this user data instead of the one above (when not NULL), to count them apart.
     IMGUI_API void*         MemAlloc(size_t size);
     IMGUI_API void          MemFree(void* ptr);
 
@@ -2249,7 +2261,7 @@ struct ImGuiTableSortSpecs
 };
 
 //-----------------------------------------------------------------------------
-// [SECTION] Helpers (ImGuiOnceUponAFrame, ImGuiTextFilter, ImGuiTextBuffer, ImGuiStorage, ImGuiListClipper, Math Operators, ImColor)
+// [SECTION] Helpers (ImGuiOnceUponAFrame, ImGuiTextFilter, ImGuiTextBuffer, ImGuiLiteralID, ImGuiStorage, ImGuiListClipper, Math Operators, ImColor)
 //-----------------------------------------------------------------------------
 
 // Helper: Unicode defines
@@ -2270,11 +2282,14 @@ struct ImGuiOnceUponAFrame
 };
 
 // Helper: Parse and apply text filters. In format "aaaaa[,bbbb][,ccccc]"
+// Build() compiles every term into a single case-insensitive matcher (Aho-Corasick automaton), so PassFilter() reads the text once whatever the number of terms.
+// PassFilterBatch() filters many texts at once, e.g. the lines of a large log, optionally split across threads. Each text passes exactly when PassFilter() would pass it.
 struct ImGuiTextFilter
 {
     IMGUI_API           ImGuiTextFilter(const char* default_filter = "");
     IMGUI_API bool      Draw(const char* label = "Filter (inc,-exc)", float width = 0.0f);  // Helper calling InputText+Build
     IMGUI_API bool      PassFilter(const char* text, const char* text_end = NULL) const;
+    IMGUI_API void      PassFilterBatch(const char* const* texts, const char* const* text_ends, int count, ImVector<int>* out_indices, ImGuiParallelForFunc parallel_for = NULL, void* parallel_for_user_data = NULL) const; // Append the index of every text that passes, in order. 'text_ends' may be NULL when all texts are zero-terminated.
     IMGUI_API void      Build();
     void                Clear()          { InputBuf[0] = 0; Build(); }
     bool                IsActive() const { return !Filters.empty(); }
@@ -2293,6 +2308,15 @@ struct ImGuiTextFilter
     char                    InputBuf[256];
     ImVector<ImGuiTextRange>Filters;
     int                     CountGrep;
+
+    // [Internal] Compiled matcher, rebuilt by Build()
+    // - MatchNext[state + class] is the next state, premultiplied by MatchClassCount, with the high bit set when it completes a term.
+    // - MatchTerm[state] is the earliest term completed there, as its rank among non-empty Filters * 2 (+ 1 for an exclude term), or 0xFFFF for none.
+    unsigned char           MatchClass[256];    // Byte -> character class, 0 for bytes that appear in no term
+    int                     MatchClassCount;
+    ImVector<ImU32>         MatchNext;
+    ImVector<ImU16>         MatchTerm;
+    IMGUI_API unsigned int  MatchFirstTerm(const char* text, const char* text_end) const;
 };
 
 // Helper: Growable text buffer for logging/accumulating text
@@ -2316,10 +2340,38 @@ struct ImGuiTextBuffer
     IMGUI_API void      appendfv(const char* fmt, va_list args) IM_FMTLIST(2);
 };
 
+// Helper: String literal label with its ID hash worked out at compile time
+// The ID of a label is the CRC32 of the label continued from the ID stack seed. CRC32 is linear, so that is the CRC32 of the label
+// from a zero state, xor'ed with the seed run through as many zero bytes. The first half is computed here at compile time
+// (consteval from C++20 on, which guarantees it), the second at runtime by ImHashLiteral(), without reading the label at all.
+// Gives the same IDs as ImHashStr(), including the ### operator, so literal and non-literal uses of a label are interchangeable.
+// e.g. 'if (ImGui::Button(ImGuiLiteralID("Save")))' or 'ImGui::PushID(ImGuiLiteralID("Settings"))'.
+struct ImGuiLiteralID
+{
+    const char*     Str;            // Whole label, as passed
+    const char*     DisplayEnd;     // End of the displayed part, at the first "##" or the terminator
+    ImU32           Crc;            // CRC32 of the hashed part from a zero state, without the final inversion
+    ImU32           HashedLen;      // Bytes in the hashed part: from the last "###", or the whole label
+
+    template<size_t N>
+    IM_CONSTEVAL ImGuiLiteralID(const char (&str)[N])
+        : Str(str),
+          DisplayEnd(str + FindDoubleHash(str, 0, StrLen(str, 0))),
+          Crc(CrcBytes(str + FindLastTripleHash(str, 0, StrLen(str, 0), 0), StrLen(str, 0) - FindLastTripleHash(str, 0, StrLen(str, 0), 0), 0)),
+          HashedLen((ImU32)(StrLen(str, 0) - FindLastTripleHash(str, 0, StrLen(str, 0), 0))) {}
+
+    // [Internal] C++11 constexpr, single expression recursions. The CRC goes a bit at a time as there is no table to hand
+    static constexpr size_t StrLen(const char* s, size_t n) { return s[n] == 0 ? n : StrLen(s, n + 1); }
+    static constexpr size_t FindDoubleHash(const char* s, size_t n, size_t len) { return n + 1 >= len ? len : (s[n] == '#' && s[n + 1] == '#') ? n : FindDoubleHash(s, n + 1, len); }
+    static constexpr size_t FindLastTripleHash(const char* s, size_t n, size_t len, size_t last) { return n + 2 >= len ? last : FindLastTripleHash(s, n + 1, len, (s[n] == '#' && s[n + 1] == '#' && s[n + 2] == '#') ? n : last); }
+    static constexpr ImU32  CrcBits(ImU32 crc, int bits) { return bits == 0 ? crc : CrcBits((crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u))), bits - 1); }
+    static constexpr ImU32  CrcBytes(const char* s, size_t len, ImU32 crc) { return len == 0 ? crc : CrcBytes(s + 1, len - 1, CrcBits(crc ^ (unsigned char)s[0], 8)); }
+};
+
 // Helper: Key->Value storage
 // Typically you don't have to worry about this since a storage is held within each Window.
 // We use it to e.g. store collapse state for a tree (Int 0/1)
-// This is optimized for efficient lookup (dichotomy into a contiguous buffer) and rare insertion (typically tied to user interactions aka max once a frame)
+// Pairs live in a contiguous buffer in insertion order. Past a handful of pairs an open addressing index is built next to it, so lookup, insertion and removal stay O(1) at any size.
 // You can use it as custom user storage for temporary values. Declare your own storage if, for example:
 // - You want to manipulate the open/close state of a particular sub-tree in your interface (tree node uses Int 0/1 to store their state).
 // - You want to store custom debug data easily without adding or editing structures in your code (probably not efficient, but convenient)
@@ -2336,12 +2388,13 @@ struct ImGuiStorage
         ImGuiStoragePair(ImGuiID _key, void* _val_p)    { key = _key; val_p = _val_p; }
     };
 
-    ImVector<ImGuiStoragePair>      Data;
+    ImVector<ImGuiStoragePair>      Data;           // Insertion order, or sorted by key after BuildSortByKey() until the next insertion or removal
+    ImVector<unsigned char>         IndexCtrl;      // [Internal] Per slot control byte (7 bits of hash or empty), first 15 repeated at the end for wrapping 16 byte group loads
+    ImVector<int>                   IndexSlots;     // [Internal] Per slot index into Data
 
-    // - Get***() functions find pair, never add/allocate. Pairs are sorted so a query is O(log N)
-    // - Set***() functions find pair, insertion on demand if missing.
-    // - Sorted insertion is costly, paid once. A typical frame shouldn't need to insert any new pair.
-    void                Clear() { Data.clear(); }
+    // - Get***() functions find pair, never add/allocate. A query hashes the key and probes 16 slots at a time.
+    // - Set***() functions find pair, insertion on demand if missing. Insertion appends to Data.
+    void                Clear() { Data.clear(); IndexCtrl.clear(); IndexSlots.clear(); }
     IMGUI_API int       GetInt(ImGuiID key, int default_val = 0) const;
     IMGUI_API void      SetInt(ImGuiID key, int val);
     IMGUI_API bool      GetBool(ImGuiID key, bool default_val = false) const;
@@ -2360,10 +2413,14 @@ struct ImGuiStorage
     IMGUI_API float*    GetFloatRef(ImGuiID key, float default_val = 0.0f);
     IMGUI_API void**    GetVoidPtrRef(ImGuiID key, void* default_val = NULL);
 
+    // Remove a pair, the last pair in Data takes its place. Returns false if the key wasn't stored.
+    IMGUI_API bool      Remove(ImGuiID key);
+
     // Use on your own storage if you know only integer are being stored (open/close all tree nodes)
     IMGUI_API void      SetAllInt(int val);
 
-    // For quicker full rebuild of a storage (instead of an incremental one), you may add all your contents and then sort once.
+    // For quicker full rebuild of a storage (instead of an incremental one), you may push_back() all your contents into Data and then call this once.
+    // Sorts Data by key and rebuilds the index, so Data can be iterated in key order afterwards.
     IMGUI_API void      BuildSortByKey();
 };
 
@@ -2944,6 +3001,8 @@ struct ImFontAtlas
     int                         TexGlyphPadding;    // Padding between glyphs within texture in pixels. Defaults to 1. If your rendering method doesn't rely on bilinear filtering you may set this to 0 (will also need to set AntiAliasedLinesUseTex = false).
     bool                        Locked;             // Marked as Locked by ImGui::NewFrame() so attempt to modify the atlas will assert.
     void*                       UserData;           // Store your own atlas related user-data (if e.g. you have multiple font atlas).
+    ImGuiParallelForFunc        ParallelFor;        // = NULL // Rasterize glyphs on your own threads while building, see ImGuiParallelForFunc. NULL rasterizes every glyph on the calling thread.
+    void*                       ParallelForUserData; // = NULL // Passed to ParallelFor as 'user_data'.
 
     // [Internal]
     // NB: Access texture data via GetTexData*() calls! Which will setup a default font for you.
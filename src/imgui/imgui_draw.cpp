@@ -128,8 +128,10 @@ namespace IMGUI_STB_NAMESPACE
 #ifdef  IMGUI_ENABLE_STB_TRUETYPE
 #ifndef STB_TRUETYPE_IMPLEMENTATION                         // in case the user already have an implementation in the _same_ compilation unit (e.g. unity builds)
 #ifndef IMGUI_DISABLE_STB_TRUETYPE_IMPLEMENTATION           // in case the user already have an implementation in another compilation unit
-#define STBTT_malloc(x,u)   ((void)(u), IM_ALLOC(x))
-#define STBTT_free(x,u)     ((void)(u), IM_FREE(x))
+static void* ImFontAtlasBuildAlloc(size_t size, void* user_data);
+static void ImFontAtlasBuildFree(void* ptr, void* user_data);
+#define STBTT_malloc(x,u)   ImFontAtlasBuildAlloc(x,u)
+#define STBTT_free(x,u)     ImFontAtlasBuildFree(x,u)
 #define STBTT_assert(x)     do { IM_ASSERT(x); } while(0)
 #define STBTT_fmod(x,y)     ImFmod(x,y)
 #define STBTT_sqrt(x)       ImSqrt(x)
@@ -385,6 +387,7 @@ void ImDrawListSharedData::SetCircleTessellationMaxError(float max_error)
 // Initialize before use in a new frame. We always have a command ready in the buffer.
 void ImDrawList::_ResetForNewFrame()
 {
+    ImDrawListAllocScope alloc_scope;
     // Verify that the ImDrawCmd fields we want to memcmp() are contiguous in memory.
     IM_STATIC_ASSERT(IM_OFFSETOF(ImDrawCmd, ClipRect) == 0);
     IM_STATIC_ASSERT(IM_OFFSETOF(ImDrawCmd, TextureId) == sizeof(ImVec4));
@@ -425,6 +428,7 @@ void ImDrawList::_ClearFreeMemory()
 
 ImDrawList* ImDrawList::CloneOutput() const
 {
+    ImDrawListAllocScope alloc_scope;
     ImDrawList* dst = IM_NEW(ImDrawList(_Data));
     dst->CmdBuffer = CmdBuffer;
     dst->IdxBuffer = IdxBuffer;
@@ -435,6 +439,7 @@ ImDrawList* ImDrawList::CloneOutput() const
 
 void ImDrawList::AddDrawCmd()
 {
+    ImDrawListAllocScope alloc_scope;
     ImDrawCmd draw_cmd;
     draw_cmd.ClipRect = _CmdHeader.ClipRect;    // Same as calling ImDrawCmd_HeaderCopy()
     draw_cmd.TextureId = _CmdHeader.TextureId;
@@ -460,6 +465,7 @@ void ImDrawList::_PopUnusedDrawCmd()
 
 void ImDrawList::AddCallback(ImDrawCallback callback, void* callback_data)
 {
+    ImDrawListAllocScope alloc_scope;
     IM_ASSERT_PARANOID(CmdBuffer.Size > 0);
     ImDrawCmd* curr_cmd = &CmdBuffer.Data[CmdBuffer.Size - 1];
     IM_ASSERT(curr_cmd->UserCallback == NULL);
@@ -570,6 +576,7 @@ int ImDrawList::_CalcCircleAutoSegmentCount(float radius) const
 // Render-level scissoring. This is passed down to your render function but not used for CPU-side coarse clipping. Prefer using higher-level ImGui::PushClipRect() to affect logic (hit-testing and widget culling)
 void ImDrawList::PushClipRect(const ImVec2& cr_min, const ImVec2& cr_max, bool intersect_with_current_clip_rect)
 {
+    ImDrawListAllocScope alloc_scope;
     ImVec4 cr(cr_min.x, cr_min.y, cr_max.x, cr_max.y);
     if (intersect_with_current_clip_rect)
     {
@@ -601,6 +608,7 @@ void ImDrawList::PopClipRect()
 
 void ImDrawList::PushTextureID(ImTextureID texture_id)
 {
+    ImDrawListAllocScope alloc_scope;
     _TextureIdStack.push_back(texture_id);
     _CmdHeader.TextureId = texture_id;
     _OnChangedTextureID();
@@ -618,6 +626,7 @@ void ImDrawList::PopTextureID()
 // submit the intermediate results. PrimUnreserve() can be used to release unused allocations.
 void ImDrawList::PrimReserve(int idx_count, int vtx_count)
 {
+    ImDrawListAllocScope alloc_scope;
     // Large mesh support (when enabled)
     IM_ASSERT_PARANOID(idx_count >= 0 && vtx_count >= 0);
     if (sizeof(ImDrawIdx) == 2 && (_VtxCurrentIdx + vtx_count >= (1 << 16)) && (Flags & ImDrawListFlags_AllowVtxOffset))
@@ -708,6 +717,7 @@ void ImDrawList::PrimQuadUV(const ImVec2& a, const ImVec2& b, const ImVec2& c, c
 // We avoid using the ImVec2 math operators here to reduce cost to a minimum for debug/non-inlined builds.
 void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32 col, ImDrawFlags flags, float thickness)
 {
+    ImDrawListAllocScope alloc_scope;
     if (points_count < 2 || (col & IM_COL32_A_MASK) == 0)
         return;
 
@@ -966,6 +976,7 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
 // - Filled shapes must always use clockwise winding order. The anti-aliasing fringe depends on it. Counter-clockwise shapes will have "inward" anti-aliasing.
 void ImDrawList::AddConvexPolyFilled(const ImVec2* points, const int points_count, ImU32 col)
 {
+    ImDrawListAllocScope alloc_scope;
     if (points_count < 3 || (col & IM_COL32_A_MASK) == 0)
         return;
 
@@ -1048,6 +1059,7 @@ void ImDrawList::AddConvexPolyFilled(const ImVec2* points, const int points_coun
 
 void ImDrawList::_PathArcToFastEx(const ImVec2& center, float radius, int a_min_sample, int a_max_sample, int a_step)
 {
+    ImDrawListAllocScope alloc_scope;
     if (radius < 0.5f)
     {
         _Path.push_back(center);
@@ -1140,6 +1152,7 @@ void ImDrawList::_PathArcToFastEx(const ImVec2& center, float radius, int a_min_
 
 void ImDrawList::_PathArcToN(const ImVec2& center, float radius, float a_min, float a_max, int num_segments)
 {
+    ImDrawListAllocScope alloc_scope;
     if (radius < 0.5f)
     {
         _Path.push_back(center);
@@ -1159,6 +1172,7 @@ void ImDrawList::_PathArcToN(const ImVec2& center, float radius, float a_min, fl
 // 0: East, 3: South, 6: West, 9: North, 12: East
 void ImDrawList::PathArcToFast(const ImVec2& center, float radius, int a_min_of_12, int a_max_of_12)
 {
+    ImDrawListAllocScope alloc_scope;
     if (radius < 0.5f)
     {
         _Path.push_back(center);
@@ -1169,6 +1183,7 @@ void ImDrawList::PathArcToFast(const ImVec2& center, float radius, int a_min_of_
 
 void ImDrawList::PathArcTo(const ImVec2& center, float radius, float a_min, float a_max, int num_segments)
 {
+    ImDrawListAllocScope alloc_scope;
     if (radius < 0.5f)
     {
         _Path.push_back(center);
@@ -1219,6 +1234,7 @@ void ImDrawList::PathArcTo(const ImVec2& center, float radius, float a_min, floa
 
 void ImDrawList::PathEllipticalArcTo(const ImVec2& center, float radius_x, float radius_y, float rot, float a_min, float a_max, int num_segments)
 {
+    ImDrawListAllocScope alloc_scope;
     if (num_segments <= 0)
         num_segments = _CalcCircleAutoSegmentCount(ImMax(radius_x, radius_y)); // A bit pessimistic, maybe there's a better computation to do here.
 
@@ -1303,6 +1319,7 @@ static void PathBezierQuadraticCurveToCasteljau(ImVector<ImVec2>* path, float x1
 
 void ImDrawList::PathBezierCubicCurveTo(const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, int num_segments)
 {
+    ImDrawListAllocScope alloc_scope;
     ImVec2 p1 = _Path.back();
     if (num_segments == 0)
     {
@@ -1319,6 +1336,7 @@ void ImDrawList::PathBezierCubicCurveTo(const ImVec2& p2, const ImVec2& p3, cons
 
 void ImDrawList::PathBezierQuadraticCurveTo(const ImVec2& p2, const ImVec2& p3, int num_segments)
 {
+    ImDrawListAllocScope alloc_scope;
     ImVec2 p1 = _Path.back();
     if (num_segments == 0)
     {
@@ -1723,6 +1741,7 @@ void ImDrawListSplitter::ClearFreeMemory()
 
 void ImDrawListSplitter::Split(ImDrawList* draw_list, int channels_count)
 {
+    ImDrawListAllocScope alloc_scope;
     IM_UNUSED(draw_list);
     IM_ASSERT(_Current == 0 && _Count <= 1 && "Nested channel splitting is not supported. Please use separate instances of ImDrawListSplitter.");
     int old_channels_count = _Channels.Size;
@@ -1753,6 +1772,7 @@ void ImDrawListSplitter::Split(ImDrawList* draw_list, int channels_count)
 
 void ImDrawListSplitter::Merge(ImDrawList* draw_list)
 {
+    ImDrawListAllocScope alloc_scope;
     // Note that we never use or rely on _Channels.Size because it is merely a buffer that we never shrink back to 0 to keep all sub-buffers ready for use.
     if (_Count <= 1)
         return;
@@ -1894,6 +1914,7 @@ void ImGui::AddDrawListToDrawDataEx(ImDrawData* draw_data, ImVector<ImDrawList*>
         IM_ASSERT(draw_list->_VtxCurrentIdx < (1 << 16) && "Too many vertices in ImDrawList using 16-bit indices. Read comment above");
 
     // Add to output list + records state in ImDrawData
+    ImDrawListAllocScope alloc_scope;
     out_list->push_back(draw_list);
     draw_data->CmdListsCount++;
     draw_data->TotalVtxCount += draw_list->VtxBuffer.Size;
@@ -1910,6 +1931,7 @@ void ImDrawData::AddDrawList(ImDrawList* draw_list)
 // For backward compatibility: convert all buffers from indexed to de-indexed, in case you cannot render indexed. Note: this is slow and most likely a waste of resources. Always prefer indexed rendering!
 void ImDrawData::DeIndexAllBuffers()
 {
+    ImDrawListAllocScope alloc_scope;
     ImVector<ImDrawVert> new_vtx_buffer;
     TotalVtxCount = TotalIdxCount = 0;
     for (int i = 0; i < CmdListsCount; i++)
@@ -2431,6 +2453,81 @@ static void UnpackBitVectorToFlatIndexList(const ImBitVector* in, ImVector<int>*
                     out->push_back((int)(((it - it_begin) << 5) + bit_n));
 }
 
+// Glyphs rasterized through ImFontAtlas::ParallelFor pass a non-NULL user data to stb_truetype and
+// allocate straight from the allocator functions: MemAlloc() records into the context without a lock.
+static void* ImFontAtlasBuildAlloc(size_t size, void* user_data)
+{
+    if (user_data == NULL)
+        return IM_ALLOC(size);
+    ImGuiMemAllocFunc alloc_func; ImGuiMemFreeFunc free_func; void* alloc_user_data;
+    ImGui::GetAllocatorFunctions(&alloc_func, &free_func, &alloc_user_data);
+    return alloc_func(size, alloc_user_data);
+}
+
+static void ImFontAtlasBuildFree(void* ptr, void* user_data)
+{
+    if (user_data == NULL)
+        return IM_FREE(ptr);
+    ImGuiMemAllocFunc alloc_func; ImGuiMemFreeFunc free_func; void* alloc_user_data;
+    ImGui::GetAllocatorFunctions(&alloc_func, &free_func, &alloc_user_data);
+    free_func(ptr, alloc_user_data);
+}
+
+// A run of glyphs from one source font, rasterized as one piece of work
+struct ImFontBuildRasterJob
+{
+    int             SrcIndex;
+    int             GlyphBegin;
+    int             GlyphEnd;
+};
+
+struct ImFontBuildRasterData
+{
+    ImFontAtlas*                    Atlas;
+    const stbtt_pack_context*       PackContext;
+    ImVector<ImFontBuildSrcData>*   SrcTmpArray;
+    ImVector<ImFontBuildRasterJob>  Jobs;
+    bool                            Threaded;
+};
+
+// Glyph rectangles never overlap so runs can be rendered in any order and from any thread.
+// Each run gets its own copy of the pack context and font info, stb_truetype writes to both.
+static void ImFontAtlasBuildRasterizeGlyphs(int job_begin, int job_end, void* data)
+{
+    ImFontBuildRasterData* raster = (ImFontBuildRasterData*)data;
+    ImFontAtlas* atlas = raster->Atlas;
+    static char worker_marker;
+    for (int job_i = job_begin; job_i < job_end; job_i++)
+    {
+        const ImFontBuildRasterJob& job = raster->Jobs[job_i];
+        ImFontConfig& cfg = atlas->ConfigData[job.SrcIndex];
+        ImFontBuildSrcData& src_tmp = (*raster->SrcTmpArray)[job.SrcIndex];
+
+        stbtt_pack_context spc = *raster->PackContext;
+        stbtt_fontinfo font_info = src_tmp.FontInfo;
+        font_info.userdata = raster->Threaded ? &worker_marker : NULL;
+
+        stbtt_pack_range range = src_tmp.PackRange;
+        range.array_of_unicode_codepoints = src_tmp.PackRange.array_of_unicode_codepoints + job.GlyphBegin;
+        range.chardata_for_range = src_tmp.PackRange.chardata_for_range + job.GlyphBegin;
+        range.num_chars = job.GlyphEnd - job.GlyphBegin;
+        stbtt_PackFontRangesRenderIntoRects(&spc, &font_info, &range, 1, src_tmp.Rects + job.GlyphBegin);
+
+        // Apply multiply operator
+        if (cfg.RasterizerMultiply != 1.0f)
+        {
+            unsigned char multiply_table[256];
+            ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
+            for (int glyph_i = job.GlyphBegin; glyph_i < job.GlyphEnd; glyph_i++)
+            {
+                stbrp_rect* r = &src_tmp.Rects[glyph_i];
+                if (r->was_packed)
+                    ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, atlas->TexPixelsAlpha8, r->x, r->y, r->w, r->h, atlas->TexWidth * 1);
+            }
+        }
+    }
+}
+
 static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
 {
     IM_ASSERT(atlas->ConfigData.Size > 0);
@@ -2622,28 +2719,25 @@ static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     spc.pixels = atlas->TexPixelsAlpha8;
     spc.height = atlas->TexHeight;
 
-    // 8. Render/rasterize font characters into the texture
+    // 8. Render/rasterize font characters into the texture, in runs of glyphs that can be spread over threads with atlas->ParallelFor
+    const int GLYPHS_PER_RASTER_JOB = 32;
+    ImFontBuildRasterData raster_data;
+    raster_data.Atlas = atlas;
+    raster_data.PackContext = &spc;
+    raster_data.SrcTmpArray = &src_tmp_array;
+    raster_data.Threaded = atlas->ParallelFor != NULL;
     for (int src_i = 0; src_i < src_tmp_array.Size; src_i++)
-    {
-        ImFontConfig& cfg = atlas->ConfigData[src_i];
-        ImFontBuildSrcData& src_tmp = src_tmp_array[src_i];
-        if (src_tmp.GlyphsCount == 0)
-            continue;
-
-        stbtt_PackFontRangesRenderIntoRects(&spc, &src_tmp.FontInfo, &src_tmp.PackRange, 1, src_tmp.Rects);
-
-        // Apply multiply operator
-        if (cfg.RasterizerMultiply != 1.0f)
+        for (int glyph_i = 0; glyph_i < src_tmp_array[src_i].GlyphsCount; glyph_i += GLYPHS_PER_RASTER_JOB)
         {
-            unsigned char multiply_table[256];
-            ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
-            stbrp_rect* r = &src_tmp.Rects[0];
-            for (int glyph_i = 0; glyph_i < src_tmp.GlyphsCount; glyph_i++, r++)
-                if (r->was_packed)
-                    ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, atlas->TexPixelsAlpha8, r->x, r->y, r->w, r->h, atlas->TexWidth * 1);
+            ImFontBuildRasterJob job = { src_i, glyph_i, ImMin(glyph_i + GLYPHS_PER_RASTER_JOB, src_tmp_array[src_i].GlyphsCount) };
+            raster_data.Jobs.push_back(job);
         }
-        src_tmp.Rects = NULL;
-    }
+    if (atlas->ParallelFor != NULL)
+        atlas->ParallelFor(raster_data.Jobs.Size, ImFontAtlasBuildRasterizeGlyphs, &raster_data, atlas->ParallelForUserData);
+    else
+        ImFontAtlasBuildRasterizeGlyphs(0, raster_data.Jobs.Size, &raster_data);
+    for (int src_i = 0; src_i < src_tmp_array.Size; src_i++)
+        src_tmp_array[src_i].Rects = NULL;
 
     // End packing
     stbtt_PackEnd(&spc);
@@ -352,6 +352,7 @@ namespace ImStb
 // Helpers: Hashing
 IMGUI_API ImGuiID       ImHashData(const void* data, size_t data_size, ImGuiID seed = 0);
 IMGUI_API ImGuiID       ImHashStr(const char* data, size_t data_size = 0, ImGuiID seed = 0);
+IMGUI_API ImGuiID       ImHashLiteral(const ImGuiLiteralID& lit, ImGuiID seed = 0);    // == ImHashStr(lit.Str, 0, seed)
 
 // Helpers: Sorting
 #ifndef ImQsort
@@ -766,6 +767,16 @@ struct ImGuiTextIndex
 #endif
 #define IM_DRAWLIST_ARCFAST_SAMPLE_MAX                          IM_DRAWLIST_ARCFAST_TABLE_SIZE // Sample index _PathArcToFastEx() for 360 angle.
 
+// Allocations made while an ImDrawListAllocScope is alive are passed the user data given to ImGui::SetAllocatorDrawListUserData().
+// Placed where draw lists grow their buffers, so an allocator can tell that memory apart from window and widget state.
+// Draw lists are only built by the thread running the frame, allocations from other threads at the same time would be counted too.
+extern IMGUI_API int GImDrawListAllocDepth;
+struct ImDrawListAllocScope
+{
+    ImDrawListAllocScope()  { GImDrawListAllocDepth++; }
+    ~ImDrawListAllocScope() { GImDrawListAllocDepth--; }
+};
+
 // Data shared between all ImDrawList instances
 // You may want to create your own instance of this if you want to use ImDrawList completely without ImGui. In that case, watch out for future changes to this structure.
 struct IMGUI_API ImDrawListSharedData
@@ -2502,6 +2513,7 @@ public:
     ImGuiID     GetID(const char* str, const char* str_end = NULL);
     ImGuiID     GetID(const void* ptr);
     ImGuiID     GetID(int n);
+    ImGuiID     GetID(const ImGuiLiteralID& lit);
     ImGuiID     GetIDFromRectangle(const ImRect& r_abs);
 
     // We don't use g.FontSize because the window may be != g.CurrentWindow.
@@ -3270,6 +3282,7 @@ namespace ImGui
     // Widgets
     IMGUI_API void          TextEx(const char* text, const char* text_end = NULL, ImGuiTextFlags flags = 0);
     IMGUI_API bool          ButtonEx(const char* label, const ImVec2& size_arg = ImVec2(0, 0), ImGuiButtonFlags flags = 0);
+    IMGUI_API bool          ButtonEx(ImGuiID id, const char* label, const char* label_end, const ImVec2& size_arg, ImGuiButtonFlags flags);
     IMGUI_API bool          ArrowButtonEx(const char* str_id, ImGuiDir dir, ImVec2 size_arg, ImGuiButtonFlags flags = 0);
     IMGUI_API bool          ImageButtonEx(ImGuiID id, ImTextureID texture_id, const ImVec2& size, const ImVec2& uv0, const ImVec2& uv1, const ImVec4& bg_col, const ImVec4& tint_col, ImGuiButtonFlags flags = 0);
     IMGUI_API void          SeparatorEx(ImGuiSeparatorFlags flags, float thickness = 1.0f);
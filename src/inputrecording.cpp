@@ -0,0 +1,275 @@
+#include "inputrecording.h"
+
+#include "imgui/imgui.h"
+#include "imgui/imgui_internal.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    enum EventType : uint8_t {
+        eMousePos,
+        eMouseWheel,
+        eMouseButton,
+        eKey,
+        eText,
+        eFocus,
+
+        // not an imgui event, io.DisplaySize and io.DisplayFramebufferScale
+        // whenever either changes
+        eDisplay
+    };
+
+    void writeVarint(std::vector<uint8_t>& out, uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back(uint8_t(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(uint8_t(value));
+    }
+
+    template<typename T>
+    void writeValue(std::vector<uint8_t>& out, T value) {
+        size_t at = out.size();
+        out.resize(at + sizeof(T));
+        std::memcpy(out.data() + at, &value, sizeof(T));
+    }
+
+    // reads past the end come back as zero, load has already checked the
+    // stream decodes so that only happens to a corrupt recording
+    struct Reader {
+        const std::vector<uint8_t>& data;
+        size_t& cursor;
+
+        uint32_t varint() {
+            uint32_t value = 0;
+            for (unsigned shift = 0; cursor < data.size() && shift < 35; shift += 7) {
+                uint8_t byte = data[cursor++];
+                value |= uint32_t(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) { break; }
+            }
+            return value;
+        }
+
+        template<typename T>
+        T value() {
+            T result = {};
+            if (cursor + sizeof(T) <= data.size()) {
+                std::memcpy(&result, data.data() + cursor, sizeof(T));
+            }
+            cursor += sizeof(T);
+            return result;
+        }
+    };
+
+    // payload bytes after the type byte, 0 for a type that doesnt exist
+    size_t payloadSize(uint8_t type) {
+        switch (type) {
+        case eMousePos: return 9;
+        case eMouseWheel: return 9;
+        case eMouseButton: return 3;
+        case eKey: return 7;
+        case eText: return 4;
+        case eFocus: return 1;
+        case eDisplay: return 16;
+        default: return 0;
+        }
+    }
+}
+
+void InputRecording::writeDisplay() {
+    const ImGuiIO& io = ImGui::GetIO();
+    if (io.DisplaySize.x == displayWidth && io.DisplaySize.y == displayHeight
+        && io.DisplayFramebufferScale.x == displayScaleX && io.DisplayFramebufferScale.y == displayScaleY) {
+        return;
+    }
+
+    displayWidth = io.DisplaySize.x;
+    displayHeight = io.DisplaySize.y;
+    displayScaleX = io.DisplayFramebufferScale.x;
+    displayScaleY = io.DisplayFramebufferScale.y;
+
+    writeVarint(data, frames - eventFrame);
+    eventFrame = frames;
+    data.push_back(eDisplay);
+    writeValue(data, displayWidth);
+    writeValue(data, displayHeight);
+    writeValue(data, displayScaleX);
+    writeValue(data, displayScaleY);
+    numEvents += 1;
+}
+
+void InputRecording::capture() {
+    ImGuiContext& g = *ImGui::GetCurrentContext();
+
+    writeDisplay();
+
+    for (const ImGuiInputEvent& e : g.InputEventsQueue) {
+        // still queued from an earlier frame, imgui trickles some events out
+        // over several frames
+        if (e.EventId < nextEventId) { continue; }
+
+        writeVarint(data, frames - eventFrame);
+        eventFrame = frames;
+
+        switch (e.Type) {
+        case ImGuiInputEventType_MousePos:
+            data.push_back(eMousePos);
+            data.push_back(uint8_t(e.MousePos.MouseSource));
+            writeValue(data, e.MousePos.PosX);
+            writeValue(data, e.MousePos.PosY);
+            break;
+        case ImGuiInputEventType_MouseWheel:
+            data.push_back(eMouseWheel);
+            data.push_back(uint8_t(e.MouseWheel.MouseSource));
+            writeValue(data, e.MouseWheel.WheelX);
+            writeValue(data, e.MouseWheel.WheelY);
+            break;
+        case ImGuiInputEventType_MouseButton:
+            data.push_back(eMouseButton);
+            data.push_back(uint8_t(e.MouseButton.MouseSource));
+            data.push_back(uint8_t(e.MouseButton.Button));
+            data.push_back(uint8_t(e.MouseButton.Down));
+            break;
+        case ImGuiInputEventType_Key:
+            data.push_back(eKey);
+            writeValue(data, uint16_t(e.Key.Key));
+            data.push_back(uint8_t(e.Key.Down));
+            writeValue(data, e.Key.AnalogValue);
+            break;
+        case ImGuiInputEventType_Text:
+            data.push_back(eText);
+            writeValue(data, uint32_t(e.Text.Char));
+            break;
+        case ImGuiInputEventType_Focus:
+            data.push_back(eFocus);
+            data.push_back(uint8_t(e.AppFocused.Focused));
+            break;
+        default:
+            std::cout << "Unknown imgui input event type " << int(e.Type) << std::endl;
+            std::abort();
+        }
+
+        numEvents += 1;
+    }
+
+    nextEventId = g.InputEventsNextEventId;
+    frames += 1;
+}
+
+void InputRecording::replay() {
+    ImGuiContext& g = *ImGui::GetCurrentContext();
+    ImGuiIO& io = g.IO;
+
+    // whatever the backend queued this frame is at the end
+    while (!g.InputEventsQueue.empty() && g.InputEventsQueue.back().EventId >= nextEventId) {
+        g.InputEventsQueue.pop_back();
+    }
+
+    Reader in = { data, cursor };
+    while (cursor < data.size()) {
+        // peek at the gap so an event for a later frame stays put
+        size_t start = cursor;
+        if (eventFrame + in.varint() != frame) {
+            cursor = start;
+            break;
+        }
+
+        eventFrame = frame;
+
+        uint8_t type = in.value<uint8_t>();
+        switch (type) {
+        case eMousePos: {
+            io.AddMouseSourceEvent(ImGuiMouseSource(in.value<uint8_t>()));
+            float x = in.value<float>();
+            float y = in.value<float>();
+            io.AddMousePosEvent(x, y);
+            break;
+        }
+        case eMouseWheel: {
+            io.AddMouseSourceEvent(ImGuiMouseSource(in.value<uint8_t>()));
+            float x = in.value<float>();
+            float y = in.value<float>();
+            io.AddMouseWheelEvent(x, y);
+            break;
+        }
+        case eMouseButton: {
+            io.AddMouseSourceEvent(ImGuiMouseSource(in.value<uint8_t>()));
+            int button = in.value<uint8_t>();
+            bool down = in.value<uint8_t>() != 0;
+            io.AddMouseButtonEvent(button, down);
+            break;
+        }
+        case eKey: {
+            auto key = ImGuiKey(in.value<uint16_t>());
+            bool down = in.value<uint8_t>() != 0;
+            float analog = in.value<float>();
+            io.AddKeyAnalogEvent(key, down, analog);
+            break;
+        }
+        case eText:
+            io.AddInputCharacter(in.value<uint32_t>());
+            break;
+        case eFocus:
+            io.AddFocusEvent(in.value<uint8_t>() != 0);
+            break;
+        case eDisplay:
+            displayWidth = in.value<float>();
+            displayHeight = in.value<float>();
+            displayScaleX = in.value<float>();
+            displayScaleY = in.value<float>();
+            break;
+        }
+    }
+
+    // the backend sets these every frame from the window
+    if (displayWidth > 0.f) {
+        io.DisplaySize = ImVec2(displayWidth, displayHeight);
+        io.DisplayFramebufferScale = ImVec2(displayScaleX, displayScaleY);
+    }
+
+    nextEventId = g.InputEventsNextEventId;
+    frame += 1;
+}
+
+bool InputRecording::save(const char *path) const {
+    std::ofstream fd(path, std::ios::binary | std::ios::trunc);
+
+    InputRecordingHeader header = { kInputRecordingMagic, kInputRecordingVersion, frames, uint32_t(data.size()) };
+    fd.write((const char*)&header, sizeof(header));
+    fd.write((const char*)data.data(), std::streamsize(data.size()));
+
+    return bool(fd);
+}
+
+bool InputRecording::load(const char *path) {
+    std::ifstream fd(path, std::ios::binary);
+
+    InputRecordingHeader header;
+    if (!fd.read((char*)&header, sizeof(header))) { return false; }
+    if (header.magic != kInputRecordingMagic || header.version != kInputRecordingVersion) { return false; }
+
+    std::vector<uint8_t> contents(header.bytes);
+    if (!fd.read((char*)contents.data(), std::streamsize(contents.size()))) { return false; }
+
+    // walk the events once so replay can trust the stream
+    size_t events = 0;
+    size_t at = 0;
+    uint64_t last = 0;
+    Reader in = { contents, at };
+    while (at < contents.size()) {
+        last += in.varint();
+        size_t size = at < contents.size() ? payloadSize(contents[at]) : 0;
+        if (size == 0 || at + 1 + size > contents.size() || last >= header.frames) { return false; }
+
+        at += 1 + size;
+        events += 1;
+    }
+
+    *this = {};
+    data = std::move(contents);
+    frames = header.frames;
+    numEvents = events;
+    return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// every input event the platform backend hands imgui, tagged with the frame
+// it arrived on, so a session can be played back later exactly as it was
+// recorded. recording and playback both run on a fixed time step so anything
+// imgui derives from time, double clicks and key repeat, comes out the same
+//
+// layout:
+//   InputRecordingHeader
+//   events, each a frame gap since the previous event as a varint, a type
+//   byte and the payload for that type packed without padding
+
+constexpr uint32_t kInputRecordingMagic = 0x31504e49; // INP1
+constexpr uint32_t kInputRecordingVersion = 1;
+
+// the time step recordings are made and played back at
+constexpr float kInputRecordingStep = 1.f / 60.f;
+
+struct InputRecordingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t frames;
+    uint32_t bytes;
+};
+
+struct InputRecording {
+    // call once a frame after the backend's NewFrame and before
+    // ImGui::NewFrame. appends whatever the backend queued since last time
+    void capture();
+
+    // call where capture would be. drops what the backend queued this frame
+    // and queues the events recorded for it instead
+    void replay();
+
+    // returns false if the file couldnt be written
+    bool save(const char *path) const;
+
+    // returns false if the file is missing or not a recording
+    bool load(const char *path);
+
+    // frames captured so far, or in the loaded recording
+    uint32_t frameCount() const { return frames; }
+
+    size_t eventCount() const { return numEvents; }
+
+private:
+    void writeDisplay();
+
+    std::vector<uint8_t> data;
+    uint32_t frames = 0;
+    size_t numEvents = 0;
+
+    // the frame the last event was written or read on
+    uint32_t eventFrame = 0;
+
+    // where replay is up to
+    uint32_t frame = 0;
+    size_t cursor = 0;
+
+    // imgui numbers events as they are queued, anything at or past this was
+    // queued after the previous capture or replay
+    uint32_t nextEventId = 0;
+
+    float displayWidth = 0.f;
+    float displayHeight = 0.f;
+    float displayScaleX = 0.f;
+    float displayScaleY = 0.f;
+};
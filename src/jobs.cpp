@@ -0,0 +1,257 @@
+#include "jobs.h"
+
+#include "profile.h"
+
+#include <functional>
+#include <string>
+
+namespace {
+    // how many times an idle worker looks for work before going to sleep
+    constexpr int kSpins = 64;
+
+    std::atomic<uint64_t> gNextSystem = 1;
+
+    // the deque this thread pushes to, for the system it was registered with
+    struct LocalDeque {
+        uint64_t system = 0;
+        JobDeque *deque = nullptr;
+    };
+
+    thread_local LocalDeque tLocal;
+
+    // cheap per thread rng for picking who to steal from
+    uint32_t nextVictim() {
+        thread_local uint32_t state = uint32_t(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+}
+
+// deque
+
+JobDeque::Ring::Ring(size_t capacity)
+    : mask(capacity - 1)
+    , jobs(std::make_unique<std::atomic<Job*>[]>(capacity))
+{ }
+
+JobDeque::JobDeque(size_t capacity) {
+    rings.push_back(std::make_unique<Ring>(capacity));
+    ring.store(rings.back().get(), std::memory_order_relaxed);
+}
+
+JobDeque::Ring *JobDeque::grow(Ring *old, int64_t top, int64_t bottom) {
+    auto& bigger = rings.emplace_back(std::make_unique<Ring>((old->mask + 1) * 2));
+    for (int64_t i = top; i < bottom; i++) {
+        bigger->put(i, old->get(i));
+    }
+
+    ring.store(bigger.get(), std::memory_order_release);
+    return bigger.get();
+}
+
+void JobDeque::push(Job *job) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    Ring *r = ring.load(std::memory_order_relaxed);
+
+    if (b - t > int64_t(r->mask)) {
+        r = grow(r, t, b);
+    }
+
+    r->put(b, job);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+Job *JobDeque::pop() {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    Ring *r = ring.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job *job = r->get(b);
+    if (t == b) {
+        // the last job, race the thieves for it
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    return job;
+}
+
+Job *JobDeque::steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+
+    if (t >= b) { return nullptr; }
+
+    Job *job = ring.load(std::memory_order_acquire)->get(t);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+
+    return job;
+}
+
+size_t JobDeque::size() const {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_relaxed);
+    return b > t ? size_t(b - t) : 0;
+}
+
+// job system
+
+JobSystem::JobSystem(unsigned threads)
+    : id(gNextSystem.fetch_add(1))
+{
+    threads = std::max(threads, 1u);
+
+    // the workers' deques are registered up front so their indices match
+    for (unsigned i = 1; i < threads; i++) {
+        deques[i - 1] = std::make_unique<JobDeque>();
+        numDeques.store(i, std::memory_order_release);
+    }
+
+    workers.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; i++) {
+        workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    stopping.store(true);
+    signal.fetch_add(1);
+    signal.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+JobDeque *JobSystem::localDeque() {
+    if (tLocal.system == id) { return tLocal.deque; }
+
+    std::lock_guard guard(registerLock);
+    size_t index = numDeques.load(std::memory_order_relaxed);
+
+    // past the limit the thread runs its jobs inline
+    JobDeque *deque = nullptr;
+    if (index < kMaxDeques) {
+        deques[index] = std::make_unique<JobDeque>();
+        deque = deques[index].get();
+        numDeques.store(index + 1, std::memory_order_release);
+    }
+
+    tLocal = { id, deque };
+    return deque;
+}
+
+Job *JobSystem::findJob(JobDeque *local) {
+    if (local != nullptr) {
+        if (Job *job = local->pop()) { return job; }
+    }
+
+    size_t count = numDeques.load(std::memory_order_acquire);
+    if (count == 0) { return nullptr; }
+
+    size_t start = nextVictim() % count;
+    for (size_t i = 0; i < count; i++) {
+        JobDeque *victim = deques[(start + i) % count].get();
+        if (victim == local) { continue; }
+
+        if (Job *job = victim->steal()) {
+            numSteals.fetch_add(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::execute(Job *job) {
+    // the job can go away as soon as the counter drops, read it first
+    JobCounter *counter = job->counter;
+    job->run(job->data);
+    counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void JobSystem::spawn(Job& job, JobCounter& counter) {
+    job.counter = &counter;
+    counter.pending.fetch_add(1, std::memory_order_relaxed);
+
+    JobDeque *local = localDeque();
+    if (local == nullptr || workers.empty()) {
+        execute(&job);
+        return;
+    }
+
+    local->push(&job);
+
+    signal.fetch_add(1);
+    if (sleeping.load() > 0) {
+        signal.notify_one();
+    }
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    JobDeque *local = localDeque();
+    while (!counter.done()) {
+        if (Job *job = findJob(local)) {
+            execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::workerLoop(unsigned index) {
+    profileNameThread(("Job " + std::to_string(index)).c_str());
+
+    JobDeque *local = deques[index - 1].get();
+    tLocal = { id, local };
+
+    while (!stopping.load(std::memory_order_relaxed)) {
+        Job *job = nullptr;
+        for (int spin = 0; spin < kSpins && job == nullptr; spin++) {
+            job = findJob(local);
+            if (job == nullptr) {
+                std::this_thread::yield();
+            }
+        }
+
+        if (job != nullptr) {
+            execute(job);
+            continue;
+        }
+
+        // the signal is read before the last look so a spawn in between
+        // changes it and the wait returns straight away
+        sleeping.fetch_add(1);
+        uint32_t seen = signal.load();
+        job = findJob(local);
+        if (job == nullptr && !stopping.load()) {
+            signal.wait(seen);
+        }
+        sleeping.fetch_sub(1);
+
+        if (job != nullptr) {
+            execute(job);
+        }
+    }
+}
+
+JobSystem& jobSystem() {
+    static JobSystem jobs;
+    return jobs;
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// number of threads to use when the caller doesnt care
+inline unsigned defaultThreadCount() {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+// counts the jobs spawned against it that havent finished yet
+struct JobCounter {
+    std::atomic<size_t> pending = 0;
+
+    bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+// a function and its argument. the caller owns the job and it has to stay
+// alive until the counter it was spawned against says it has run
+struct Job {
+    void (*run)(void *data) = nullptr;
+    void *data = nullptr;
+    JobCounter *counter = nullptr;
+};
+
+// a chase-lev deque of jobs. only the thread that owns it pushes and pops,
+// at the bottom, every other thread steals from the top. the ring doubles
+// when full and old rings are kept until the deque goes away since a thief
+// may still be reading one
+struct JobDeque {
+    JobDeque(size_t capacity = 256);
+
+    JobDeque(const JobDeque&) = delete;
+    JobDeque& operator=(const JobDeque&) = delete;
+
+    void push(Job *job);
+    Job *pop();
+
+    // nullptr when empty or when another thread won the race for the top job
+    Job *steal();
+
+    // only exact on the owning thread
+    size_t size() const;
+
+private:
+    struct Ring {
+        Ring(size_t capacity);
+
+        // release and acquire publish the job itself to whoever steals it
+        Job *get(int64_t index) const { return jobs[size_t(index) & mask].load(std::memory_order_acquire); }
+        void put(int64_t index, Job *job) { jobs[size_t(index) & mask].store(job, std::memory_order_release); }
+
+        size_t mask;
+        std::unique_ptr<std::atomic<Job*>[]> jobs;
+    };
+
+    Ring *grow(Ring *ring, int64_t top, int64_t bottom);
+
+    alignas(64) std::atomic<int64_t> top = 0;
+    alignas(64) std::atomic<int64_t> bottom = 0;
+    std::atomic<Ring*> ring;
+    std::vector<std::unique_ptr<Ring>> rings;
+};
+
+// a fixed set of worker threads that take jobs from their own deque and
+// steal from everyone elses when it runs dry. any thread can spawn and wait,
+// threads outside the pool get a deque of their own the first time they do
+// and help run jobs while they wait
+struct JobSystem {
+    // `threads` counts the calling thread, so one thread means no workers
+    // and every job runs on whichever thread waits for it
+    JobSystem(unsigned threads = defaultThreadCount());
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // queue `job` on the calling thread and count it against `counter`
+    void spawn(Job& job, JobCounter& counter);
+
+    // run jobs until every job counted against `counter` is done
+    void wait(JobCounter& counter);
+
+    // fn(begin, end) over pieces of [0, count) that are at least `grain`
+    // long, 0 picks one from the count and the number of threads. ranges
+    // are only split in two when the thread has nothing queued for thieves
+    // to take, so busy pools run big pieces and idle ones spread out fast
+    template<typename F>
+    void parallelFor(size_t count, F&& fn, size_t grain = 0);
+
+    unsigned threadCount() const { return unsigned(workers.size()) + 1; }
+
+    // how many jobs were taken from another thread's deque
+    uint64_t steals() const { return numSteals.load(std::memory_order_relaxed); }
+
+private:
+    template<typename F>
+    void splitRange(size_t begin, size_t end, size_t grain, F& fn);
+
+    JobDeque *localDeque();
+    Job *findJob(JobDeque *local);
+    void execute(Job *job);
+    void workerLoop(unsigned index);
+
+    uint64_t id;
+
+    // deques are registered once and live as long as the system, the count
+    // is published after the slot is filled so thieves can read without a lock
+    static constexpr size_t kMaxDeques = 256;
+    std::unique_ptr<JobDeque> deques[kMaxDeques];
+    std::atomic<size_t> numDeques = 0;
+    std::mutex registerLock;
+
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopping = false;
+
+    // workers out of work sleep on `signal`, spawning bumps it
+    std::atomic<uint32_t> signal = 0;
+    std::atomic<unsigned> sleeping = 0;
+
+    std::atomic<uint64_t> numSteals = 0;
+};
+
+// the pool everything shares, made on first use with defaultThreadCount threads
+JobSystem& jobSystem();
+
+template<typename F>
+void JobSystem::parallelFor(size_t count, F&& fn, size_t grain) {
+    if (grain == 0) {
+        grain = std::max<size_t>(count / (size_t(threadCount()) * 8), 1);
+    }
+
+    splitRange(0, count, grain, fn);
+}
+
+template<typename F>
+void JobSystem::splitRange(size_t begin, size_t end, size_t grain, F& fn) {
+    JobDeque *local = localDeque();
+
+    while (end - begin > grain) {
+        // work is already queued where thieves can see it, keep going serially
+        if (local != nullptr && local->size() > 0) {
+            fn(begin, begin + grain);
+            begin += grain;
+            continue;
+        }
+
+        struct Half {
+            JobSystem *jobs;
+            size_t begin;
+            size_t end;
+            size_t grain;
+            F *fn;
+        };
+
+        size_t middle = begin + (end - begin) / 2;
+        Half half = { this, middle, end, grain, &fn };
+        Job job = {
+            [](void *data) {
+                auto *it = static_cast<Half*>(data);
+                it->jobs->splitRange(it->begin, it->end, it->grain, *it->fn);
+            },
+            &half
+        };
+
+        JobCounter counter;
+        spawn(job, counter);
+        splitRange(begin, middle, grain, fn);
+        wait(counter);
+        return;
+    }
+
+    if (begin < end) {
+        fn(begin, end);
+    }
+}
@@ -0,0 +1,267 @@
+#include "logbuffer.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <unistd.h>
+#endif
+
+static_assert(kLogChunkSize % 65536 == 0, "spilled chunks are mapped at multiples of the chunk size");
+
+LogBuffer::~LogBuffer() {
+    clear();
+    closeSpill();
+}
+
+uint32_t& LogBuffer::lineStart(const Chunk& chunk, size_t k) {
+    return reinterpret_cast<uint32_t*>(chunk.data + kLogChunkSize)[-1 - std::ptrdiff_t(k)];
+}
+
+size_t LogBuffer::room(const Chunk& chunk) {
+    return kLogChunkSize - chunk.used - chunk.lines * sizeof(uint32_t);
+}
+
+bool LogBuffer::spillTo(const char *path, size_t residentChunks) {
+    closeSpill();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { return false; }
+    spillFile = file;
+#else
+    spillFile = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (spillFile < 0) { return false; }
+#endif
+
+    residentLimit = std::max<size_t>(residentChunks, 2);
+    return true;
+}
+
+void LogBuffer::closeSpill() {
+    // spilled chunks stay mapped, the mappings keep the file alive
+#if defined(_WIN32)
+    if (spillFile != nullptr) {
+        CloseHandle(spillFile);
+        spillFile = nullptr;
+    }
+#else
+    if (spillFile >= 0) {
+        ::close(spillFile);
+        spillFile = -1;
+    }
+#endif
+    residentLimit = 0;
+}
+
+void LogBuffer::spill(Chunk& chunk, size_t index) {
+    uint64_t offset = uint64_t(index) * kLogChunkSize;
+    void *view = nullptr;
+
+#if defined(_WIN32)
+    OVERLAPPED at = {};
+    at.Offset = DWORD(offset);
+    at.OffsetHigh = DWORD(offset >> 32);
+    DWORD written = 0;
+    if (WriteFile(spillFile, chunk.data, DWORD(kLogChunkSize), &written, &at) && written == kLogChunkSize) {
+        uint64_t end = offset + kLogChunkSize;
+        HANDLE mapping = CreateFileMappingA(spillFile, nullptr, PAGE_READONLY, DWORD(end >> 32), DWORD(end), nullptr);
+        if (mapping != nullptr) {
+            view = MapViewOfFile(mapping, FILE_MAP_READ, DWORD(offset >> 32), DWORD(offset), kLogChunkSize);
+            if (view != nullptr) {
+                chunk.mapping = mapping;
+            } else {
+                CloseHandle(mapping);
+            }
+        }
+    }
+#else
+    size_t written = 0;
+    while (written < kLogChunkSize) {
+        ssize_t n = pwrite(spillFile, chunk.data + written, kLogChunkSize - written, off_t(offset + written));
+        if (n <= 0) { break; }
+        written += size_t(n);
+    }
+    if (written == kLogChunkSize) {
+        view = mmap(nullptr, kLogChunkSize, PROT_READ, MAP_SHARED, spillFile, off_t(offset));
+        if (view == MAP_FAILED) { view = nullptr; }
+    }
+#endif
+
+    // out of disk or address space, keep the rest of the log in memory
+    if (view == nullptr) {
+        std::cout << "Failed to spill log chunk " << index << ", keeping the log in memory" << std::endl;
+        closeSpill();
+        return;
+    }
+
+    std::free(chunk.data);
+    chunk.data = static_cast<char*>(view);
+    chunk.spilled = true;
+    numSpilled += 1;
+}
+
+LogBuffer::Chunk& LogBuffer::newChunk() {
+    // chunks spill oldest first, so the spilled ones are always a prefix.
+    // the limit is at least 2 so the chunk being appended to never goes
+    if (residentLimit != 0 && residentChunkCount() >= residentLimit) {
+        spill(chunks[numSpilled], numSpilled);
+    }
+
+    Chunk chunk;
+    chunk.data = static_cast<char*>(std::malloc(kLogChunkSize));
+    if (chunk.data == nullptr) {
+        std::cout << "Failed to allocate a log chunk" << std::endl;
+        std::abort();
+    }
+    chunk.firstLine = numLines;
+
+    chunks.push_back(chunk);
+    return chunks.back();
+}
+
+void LogBuffer::beginLine() {
+    // a line start and at least one byte of it
+    if (chunks.empty() || room(chunks.back()) < sizeof(uint32_t) + 1) {
+        newChunk();
+    }
+
+    Chunk& chunk = chunks.back();
+    lineStart(chunk, chunk.lines) = chunk.used;
+    chunk.lines += 1;
+
+    if (numLines % kLogLinesPerPage == 0) {
+        pageChunks.push_back(uint32_t(chunks.size() - 1));
+    }
+    numLines += 1;
+    atLineStart = false;
+}
+
+void LogBuffer::carryLine() {
+    // the last chunk is full partway through a line. the line moves to a new
+    // chunk so it stays in one piece, unless it is most of a chunk already
+    // in which case it is broken there
+    uint32_t start = lineStart(chunks.back(), chunks.back().lines - 1);
+    size_t partial = chunks.back().used - start;
+
+    Chunk& fresh = newChunk();
+    if (partial > kLogChunkSize / 2) {
+        beginLine();
+        return;
+    }
+
+    Chunk& full = chunks[chunks.size() - 2];
+    std::memcpy(fresh.data, full.data + start, partial);
+    full.used = start;
+    full.lines -= 1;
+
+    fresh.used = uint32_t(partial);
+    fresh.lines = 1;
+    fresh.firstLine = full.firstLine + full.lines;
+    lineStart(fresh, 0) = 0;
+
+    if (fresh.firstLine % kLogLinesPerPage == 0) {
+        pageChunks.back() = uint32_t(chunks.size() - 1);
+    }
+}
+
+void LogBuffer::append(std::string_view text) {
+    while (!text.empty()) {
+        if (atLineStart) {
+            beginLine();
+        }
+
+        Chunk& chunk = chunks.back();
+        size_t n = std::min(text.size(), room(chunk));
+        const void *newline = std::memchr(text.data(), '\n', n);
+        if (newline != nullptr) {
+            n = size_t(static_cast<const char*>(newline) - text.data()) + 1;
+        }
+
+        std::memcpy(chunk.data + chunk.used, text.data(), n);
+        chunk.used += uint32_t(n);
+        numBytes += n;
+        text.remove_prefix(n);
+
+        if (newline != nullptr) {
+            atLineStart = true;
+        } else if (!text.empty()) {
+            carryLine();
+        }
+    }
+}
+
+void LogBuffer::appendf(const char *fmt, ...) {
+    if (scratch.empty()) {
+        scratch.resize(256);
+    }
+
+    va_list args;
+    va_start(args, fmt);
+
+    // one pass when the line fits what earlier ones needed, two otherwise
+    va_list copy;
+    va_copy(copy, args);
+    int length = std::vsnprintf(scratch.data(), scratch.size(), fmt, copy);
+    va_end(copy);
+
+    if (length >= 0 && size_t(length) >= scratch.size()) {
+        scratch.resize(size_t(length) + 1);
+        std::vsnprintf(scratch.data(), scratch.size(), fmt, args);
+    }
+    va_end(args);
+
+    if (length > 0) {
+        append({ scratch.data(), size_t(length) });
+    }
+}
+
+std::string_view LogBuffer::line(size_t index) const {
+    // the table points at the chunk the page's first line is in, the rest of
+    // the page can only be a few chunks further on
+    size_t c = pageChunks[index / kLogLinesPerPage];
+    while (c + 1 < chunks.size() && chunks[c + 1].firstLine <= index) {
+        c++;
+    }
+
+    const Chunk& chunk = chunks[c];
+    size_t k = index - chunk.firstLine;
+    uint32_t start = lineStart(chunk, k);
+    uint32_t end = k + 1 < chunk.lines ? lineStart(chunk, k + 1) : chunk.used;
+    if (end > start && chunk.data[end - 1] == '\n') {
+        end--;
+    }
+    return { chunk.data + start, end - start };
+}
+
+void LogBuffer::clear() {
+    for (Chunk& chunk : chunks) {
+        if (!chunk.spilled) {
+            std::free(chunk.data);
+            continue;
+        }
+#if defined(_WIN32)
+        UnmapViewOfFile(chunk.data);
+        CloseHandle(chunk.mapping);
+#else
+        munmap(chunk.data, kLogChunkSize);
+#endif
+    }
+
+    chunks.clear();
+    pageChunks.clear();
+    numLines = 0;
+    numBytes = 0;
+    numSpilled = 0;
+    atLineStart = true;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "imgui/imgui.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// an append only log kept in fixed size chunks, each holding its text from
+// the front and the offsets of the lines that start in it from the back. a
+// line never straddles two chunks, appending never moves what is already
+// there so its cost stays flat however big the log gets, and any line is
+// found in constant time for drawing the visible part with ImGuiListClipper
+//
+// older chunks can be spilled to a file and mapped back in read only, which
+// bounds the memory the log holds on to at a few chunks plus a table of one
+// entry per kLogLinesPerPage lines
+
+constexpr size_t kLogChunkSize = 1 << 20;
+
+// lines per entry in the table that finds the chunk a line is in
+constexpr size_t kLogLinesPerPage = 1024;
+
+struct LogBuffer {
+    LogBuffer() = default;
+    ~LogBuffer();
+
+    LogBuffer(const LogBuffer&) = delete;
+    LogBuffer& operator=(const LogBuffer&) = delete;
+
+    // from now on keep at most `residentChunks` chunks in memory, at least 2,
+    // writing older ones to `path` and mapping them back. returns false if
+    // the file couldnt be created, the log then stays in memory
+    bool spillTo(const char *path, size_t residentChunks);
+
+    // a line longer than a chunk is broken up into lines of a chunk each
+    void append(std::string_view text);
+    void appendf(const char *fmt, ...) IM_FMTARGS(2);
+
+    // lines so far, the last one may still be missing its newline
+    size_t lineCount() const { return numLines; }
+
+    // without the newline. only valid until the next append, which may
+    // spill the chunk it points into
+    std::string_view line(size_t index) const;
+
+    // every byte appended, newlines included
+    uint64_t size() const { return numBytes; }
+
+    size_t chunkCount() const { return chunks.size(); }
+
+    // chunks held in memory rather than mapped from the spill file
+    size_t residentChunkCount() const { return chunks.size() - numSpilled; }
+
+    void clear();
+
+private:
+    struct Chunk {
+        char *data = nullptr;
+        uint32_t used = 0;
+        uint32_t lines = 0;
+        uint64_t firstLine = 0;
+        bool spilled = false;
+#if defined(_WIN32)
+        void *mapping = nullptr;
+#endif
+    };
+
+    // where the k-th line of a chunk starts, counted from the back of it
+    static uint32_t& lineStart(const Chunk& chunk, size_t k);
+
+    // bytes left between the text and the line starts
+    static size_t room(const Chunk& chunk);
+
+    void beginLine();
+    void carryLine();
+    Chunk& newChunk();
+    void spill(Chunk& chunk, size_t index);
+    void closeSpill();
+
+    std::vector<Chunk> chunks;
+
+    // the chunk holding the first line of every kLogLinesPerPage lines
+    std::vector<uint32_t> pageChunks;
+
+    size_t numLines = 0;
+    uint64_t numBytes = 0;
+    bool atLineStart = true;
+
+    // reused by appendf so formatting doesnt allocate once it has grown
+    std::vector<char> scratch;
+
+    size_t residentLimit = 0;
+    size_t numSpilled = 0;
+#if defined(_WIN32)
+    void *spillFile = nullptr;
+#else
+    int spillFile = -1;
+#endif
+};
+
+// a log drawn with imgui, with a filter box. lines the filter lets through
+// are found with ImGuiTextFilter::PassFilterBatch, only the lines appended
+// since the last frame are filtered unless the filter changed
+struct LogView {
+    ImGuiTextFilter filter;
+
+    // big batches of new lines are filtered with this when it is set
+    ImGuiParallelForFunc parallelFor = nullptr;
+
+    void draw(const LogBuffer& log);
+
+private:
+    ImVector<int> matches;
+    size_t filteredLines = 0;
+    std::vector<const char*> begins;
+    std::vector<const char*> ends;
+};
@@ -0,0 +1,65 @@
+#include "logbuffer.h"
+
+#include <cfloat>
+
+namespace {
+    // below this farming the filter out costs more than it saves
+    constexpr size_t kParallelFilterLines = 64 * 1024;
+}
+
+void LogView::draw(const LogBuffer& log) {
+    if (filter.Draw("Filter", -FLT_MIN)) {
+        matches.clear();
+        filteredLines = 0;
+    }
+
+    // cleared since the last frame
+    if (filteredLines > log.lineCount()) {
+        matches.clear();
+        filteredLines = 0;
+    }
+
+    if (filter.IsActive() && log.lineCount() > 0) {
+        // the last line may have grown since it was filtered, so it goes again
+        size_t first = filteredLines > 0 ? filteredLines - 1 : 0;
+        while (!matches.empty() && size_t(matches.back()) >= first) {
+            matches.pop_back();
+        }
+
+        size_t count = log.lineCount() - first;
+        begins.resize(count);
+        ends.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            std::string_view line = log.line(first + i);
+            begins[i] = line.data();
+            ends[i] = line.data() + line.size();
+        }
+
+        int from = matches.Size;
+        filter.PassFilterBatch(begins.data(), ends.data(), int(count), &matches, count >= kParallelFilterLines ? parallelFor : nullptr);
+        for (int i = from; i < matches.Size; i++) {
+            matches[i] += int(first);
+        }
+        filteredLines = log.lineCount();
+    }
+
+    ImGui::Separator();
+    if (ImGui::BeginChild("Lines", ImVec2(0.f, 0.f), false, ImGuiWindowFlags_HorizontalScrollbar)) {
+        bool filtering = filter.IsActive();
+        ImGuiListClipper clipper;
+        clipper.Begin(filtering ? matches.Size : int(log.lineCount()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                std::string_view line = log.line(filtering ? size_t(matches[row]) : size_t(row));
+                ImGui::TextUnformatted(line.data(), line.data() + line.size());
+            }
+        }
+        clipper.End();
+
+        // keep following the end of the log while scrolled to the bottom
+        if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
+            ImGui::SetScrollHereY(1.f);
+        }
+    }
+    ImGui::EndChild();
+}
@@ -6,90 +6,83 @@
 
 #include <iostream>
 #include <array>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <vector>
 
+#include "allocator.h"
+#include "archive.h"
+#include "hash.h"
+#include "ifs.h"
+#include "inputrecording.h"
+#include "jobs.h"
+#include "logbuffer.h"
+#include "benchmark.h"
+#include "camera.h"
+#include "deepzoom.h"
+#include "headless.h"
 #include "program.h"
 #include "mesh.h"
+#include "meshpool.h"
+#include "noise.h"
+#include "texture.h"
+#include "chaos.h"
+#include "parallel.h"
+#include "pointindex.h"
+#include "profile.h"
+#include "quads.h"
+#include "renderthread.h"
+#include "sierpinski.h"
 
 #include <cmath>
 
-// square
+// squares
 
-constexpr auto kSquareIndicies = std::to_array<unsigned>({
-    0, 1,
-    1, 2,
-    2, 3,
-    3, 0
-});
+// a grid of squares each spinning at its own rate, only the rotation
+// changes from frame to frame
+QuadInstance makeSquare(uint32_t index, uint32_t perRow, double time) {
+    // cheap enough to recompute every frame rather than keeping per square state
+    uint32_t bits = mix32(index);
+    float cell = 2.f / float(perRow);
+    float x = -1.f + cell * (float(index % perRow) + 0.5f);
+    float y = -1.f + cell * (float(index / perRow) + 0.5f);
 
-struct float2 {
-    float x;
-    float y;
-};
-
-// M_PI is annoying to get on windows
-#define MY_PI 3.14159265358979323846f
-
-float2 rotatePoint(float2 point, float2 origin, float angleInDeg, float scale) {
-    float angleInRad = angleInDeg * (MY_PI / 180.f);
-
-    float cosTheta = std::cos(angleInRad);
-    float sinTheta = std::sin(angleInRad);
-
-    float x = point.x - origin.x;
-    float y = point.y - origin.y;
-
-    float x1 = x * cosTheta - y * sinTheta;
-    float y1 = x * sinTheta + y * cosTheta;
-
-    return { (x1 + origin.x) * scale, (y1 + origin.y) * scale };
-}
-
-std::array<Vertex2, 4> makeSquare(float scale, float rotationInDeg) {
-    float2 origin = { 0.0, 0.0 };
-
-    float2 p1 = rotatePoint({ -1, -1 }, origin, rotationInDeg, scale);
-    float2 p2 = rotatePoint({ 1, -1 }, origin, rotationInDeg, scale);
-    float2 p3 = rotatePoint({ 1, 1 }, origin, rotationInDeg, scale);
-    float2 p4 = rotatePoint({ -1, 1 }, origin, rotationInDeg, scale);
+    // between half a turn a second either way
+    double speed = double(bits & 0xffff) / 65535.0 - 0.5;
+    double phase = double(bits >> 16) / 65535.0;
+    double turns = phase + time * speed;
 
     return {
-        Vertex2{ { p1.x, p1.y, 0.0f }, { 1.0f, 0.0f, 0.0f } },
-        Vertex2{ { p2.x, p2.y, 0.0f }, { 0.0f, 1.0f, 0.0f } },
-        Vertex2{ { p3.x, p3.y, 0.0f }, { 0.0f, 0.0f, 1.0f } },
-        Vertex2{ { p4.x, p4.y, 0.0f }, { 1.0f, 1.0f, 1.0f } }
+        { x, y },
+        packUnorm16(float(turns - std::floor(turns))),
+        packHalf(cell * 0.35f),
+        { uint8_t(bits), uint8_t(bits >> 8), uint8_t(bits >> 16), 255 }
     };
 }
 
-Mesh makeSierpinski(size_t steps, bool blending) {
-    Vertex2 p1 = { { -1, -1, 0 }, { 1, 0, 0 } };
-    Vertex2 p2 = { { 1, -1, 0 }, { 0, 1, 0 } };
-    Vertex2 p3 = { { 0, 1, 0 }, { 0, 0, 1 } };
-
-    std::vector<Vertex2> verts = { p1, p2, p3 };
-    std::vector<unsigned> indicies = { 0, 1, 2 };
-
-    for (size_t i = 0; i < steps; i++) {
-        size_t index = rand() % 3;
-        auto& back = verts.back();
-        auto& point = verts[index];
-        Vertex2 newPoint = {
-            {
-                (point.position.x + back.position.x) / 2,
-                (point.position.y + back.position.y) / 2,
-                0
-            },
-            {
-                blending ? (point.colour.r + back.colour.r) / 2 : point.colour.r,
-                blending ? (point.colour.g + back.colour.g) / 2 : point.colour.g,
-                blending ? (point.colour.b + back.colour.b) / 2 : point.colour.b
-            }
-        };
-        verts.push_back(newPoint);
-        indicies.push_back(unsigned(verts.size() - 1));
+// a logarithmic slider over a wide int range. imgui multiplies the ends of
+// the range together in the slider's own type, which overflows an int here
+bool sliderIntLog(const char *label, int *value, int min, int max) {
+    ImS64 wide = *value;
+    ImS64 wideMin = min;
+    ImS64 wideMax = max;
+    if (!ImGui::SliderScalar(label, ImGuiDataType_S64, &wide, &wideMin, &wideMax, "%lld", ImGuiSliderFlags_Logarithmic)) {
+        return false;
     }
 
-    return Mesh(verts, indicies);
+    *value = int(wide);
+    return true;
+}
+
+// the one parallel for imgui is given, for the font atlas build and the log
+// filter. the pieces allocate under the caller's tag wherever they run
+void parallelForJobs(int count, void (*func)(int begin, int end, void *funcData), void *funcData, void *) {
+    AllocTag tag = allocatorTag();
+    jobSystem().parallelFor(size_t(count), [&](size_t begin, size_t end) {
+        AllocTagScope scope(tag);
+        func(int(begin), int(end), funcData);
+    });
 }
 
 void processInput(GLFWwindow *window) {
@@ -98,15 +91,78 @@ void processInput(GLFWwindow *window) {
     }
 }
 
-void fbResize(GLFWwindow*, int width, int height) {
-    glViewport(0, 0, width, height);
-}
-
 // settings
 constexpr unsigned int kWidth = 800;
 constexpr unsigned int kHeight = 600;
 
-int main() {
+// benchmark frames that are left out of the timings, they pay for shader
+// compiles and the first uploads
+constexpr int kWarmupFrames = 10;
+
+// what the command line asked for
+struct AppOptions {
+    int benchmarkFrames = 0;
+    bool renderThread = true;
+    bool replaying = false;
+
+    // null unless recording
+    const char *recordPath = nullptr;
+};
+
+void runApp(GLFWwindow *window, InputRecording& input, const AppOptions& options);
+
+int main(int argc, const char **argv) {
+    // --benchmark N renders a scripted scene offscreen for N frames and
+    // prints per phase timings as json on the last line of output.
+    // --no-render-thread runs the recorded gl commands on the main thread.
+    // --record FILE saves every input event to FILE on exit and --replay FILE
+    // benchmarks those events instead of the scripted scene, for as many
+    // frames as were recorded
+    int benchmarkFrames = 0;
+    bool renderThread = true;
+    const char *recordPath = nullptr;
+    const char *replayPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc) {
+            benchmarkFrames = std::max(std::atoi(argv[++i]), 1);
+        } else if (std::strcmp(argv[i], "--no-render-thread") == 0) {
+            renderThread = false;
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--benchmark frames] [--no-render-thread] [--record file | --replay file]" << std::endl;
+            return -1;
+        }
+    }
+
+    InputRecording input;
+    if (replayPath != nullptr) {
+        if (!input.load(replayPath)) {
+            std::cout << "Failed to load input recording " << replayPath << std::endl;
+            return -1;
+        }
+
+        benchmarkFrames = std::max(int(input.frameCount()), 1);
+        recordPath = nullptr;
+    }
+
+    bool benchmark = benchmarkFrames > 0;
+    bool replaying = replayPath != nullptr;
+    bool recording = recordPath != nullptr && !benchmark;
+
+    // assets are packed next to the executable, loose files in data/ are the fallback
+    auto archive = (std::filesystem::path(argv[0]).parent_path() / "data.pak").string();
+    if (!mountAssets(archive.c_str())) {
+        std::cout << "No asset archive at " << archive << ", loading loose files" << std::endl;
+    }
+
+    // benchmarks run on build machines without a display
+    if (benchmark) {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -116,81 +172,702 @@ int main() {
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 
-    // glfw window creation
-    // --------------------
-    GLFWwindow* window = glfwCreateWindow(kWidth, kHeight, "hello", NULL, NULL);
-    if (window == NULL) {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
+    GLFWwindow* window = nullptr;
+    if (benchmark) {
+        window = createHeadlessWindow(kWidth, kHeight);
+        if (window == nullptr) {
+            std::cout << "Failed to create a headless context" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+    } else {
+        // glfw window creation
+        // --------------------
+        window = glfwCreateWindow(kWidth, kHeight, "hello", NULL, NULL);
+        if (window == NULL) {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+
+        // glad: load all OpenGL function pointers
+        // ---------------------------------------
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
     }
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, fbResize);
 
-    // glad: load all OpenGL function pointers
-    // ---------------------------------------
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        return -1;
-    }
+    enableProgramCache("cache/programs");
+
+    profileNameThread("Main");
+    profileGpuInit();
 
     IMGUI_CHECKVERSION();
+    allocatorInstallImGui();
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO(); (void)io;
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
 
+    // glyphs are rasterized on the job system when the font atlas is built
+    io.Fonts->ParallelFor = parallelForJobs;
+
+    // benchmark runs shouldnt depend on or overwrite the saved layout, and
+    // recordings have to start from the same one replays do
+    if (benchmark || recording) {
+        io.IniFilename = nullptr;
+    }
+
     // Setup Dear ImGui style
     ImGui::StyleColorsDark();
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplGlfw_InitForOpenGL(window, !benchmark);
     ImGui_ImplOpenGL3_Init("#version 130");
 
+    runApp(window, input, { benchmarkFrames, renderThread, replaying, recording ? recordPath : nullptr });
+
+    // the context is current on this thread again and every gl object made
+    // by the app is gone, what is left goes before the context does
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
+
+    profileGpuShutdown();
+    if (benchmark) {
+        destroyHeadlessWindow(window);
+    }
+    glfwTerminate();
+    return 0;
+}
+
+// everything owning a gl object is a local in here, so it is deleted while
+// there is still a context to delete it from
+void runApp(GLFWwindow *window, InputRecording& input, const AppOptions& options) {
+    ImGuiIO& io = ImGui::GetIO();
+    int benchmarkFrames = options.benchmarkFrames;
+    bool benchmark = benchmarkFrames > 0;
+    bool replaying = options.replaying;
+    bool recording = options.recordPath != nullptr;
+    const char *recordPath = options.recordPath;
+
     int steps = 1000;
     bool blending = false;
-    auto triangle = makeSierpinski(steps, blending);
+    Sierpinski triangle(blending);
+    triangle.setSteps(steps);
+
+    // many independent walkers spread over every core or run on the gpu,
+    // regenerated in one go. density keeps walking every frame and shows a
+    // tonemapped histogram of where the walkers landed instead of points.
+    // deep zoom regenerates just what is on screen whenever the camera moves
+    enum Generator : int { eIncremental, eParallel, eGpu, eDensity, eDeepZoom };
+    const char *kGeneratorNames[] = { "Incremental", "Parallel", "GPU", "Density", "Deep Zoom" };
+
+    int generator = eIncremental;
+    int densePoints = 1'000'000;
+    std::vector<Vertex2> denseScratch;
+
+    // parallel points are chunked so chunks off screen can be skipped and
+    // chunks that are small on screen draw fewer points
+    std::vector<PointChunk> denseChunks;
+    ChunkSelection visibleChunks[2];
+    bool cullPoints = true;
+    float pointsPerPixel = 2.f;
+    Camera2D camera;
+
+    // cpu generated points are packed before upload, a palette index when every
+    // point has one of the corner colours and rgba8 when they are blended
+    PointBuffer dense(kVertexLayout<PointVertex>);
+    PointBuffer denseIndexed(kVertexLayout<PaletteVertex>);
+    GpuSierpinski gpuTriangle;
+
+    int densityPreset = 0;
+    int densityIterations = 2'000'000;
+    float densityGamma = 2.2f;
+    IfsHistogram density(kWidth, kHeight);
+
+    // one image per render thread slot, the render thread uploads one while
+    // the main thread tonemaps into the other
+    std::vector<Rgba8> densityImages[2];
+    for (auto& image : densityImages) {
+        image.resize(size_t(kWidth) * kHeight);
+    }
+    unsigned densityTexture = createTexture(kWidth, kHeight, TextureFormat::eRgba8, nullptr);
+
+    // deep zoom points are already relative to the camera they were made for
+    std::vector<DeepCell> deepCells;
+    Camera2D deepCamera;
+    size_t deepPoints = 0;
+
+    // what the app has to say, shown in the log window as well as on stdout
+    LogBuffer appLog;
+    LogView logView;
+    logView.parallelFor = parallelForJobs;
+
+    // gl belongs to the render thread once the loop starts, everything that
+    // touches a gl object is recorded into the frame rather than called
+    std::unique_ptr<RenderThread> renderer;
+    auto record = [&](auto&& command) {
+        renderer->commands().record(std::forward<decltype(command)>(command));
+    };
+
+    auto fitPreset = [&] {
+        camera = fitCamera(ifsBounds(ifsPresets()[size_t(densityPreset)].maps, 0.f));
+    };
+
+    auto regenerateDense = [&] {
+        PROFILE_SCOPE("Regenerate");
+        if (generator == eDensity) {
+            auto maps = ifsPresets()[size_t(densityPreset)].maps;
+            density.reset(maps, ifsBounds(maps, float(kWidth) / float(kHeight)));
+            return;
+        }
+
+        if (generator == eDeepZoom) {
+            auto maps = ifsPresets()[size_t(densityPreset)].maps;
+            unsigned threads = defaultThreadCount();
+
+            deepCells = findDeepCells(maps, camera);
+            deepCamera = camera;
+            denseChunks.clear();
+
+            denseScratch.resize(size_t(densePoints));
+            deepPoints = generateDeepPoints(denseScratch, maps, deepCells, { .seed = 0, .threads = threads, .blending = blending });
+            appLog.appendf("Deep zoom at %.3gx: %zu points from %zu cells\n", camera.zoom, deepPoints, deepCells.size());
+
+            std::vector<PointVertex> packed(deepPoints);
+            parallelFor(deepPoints, threads, [&](unsigned, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    packed[i] = packPoint(denseScratch[i]);
+                }
+            });
+            record([&dense, packed = std::move(packed)] {
+                dense.clear();
+                dense.append(packed);
+            });
+            return;
+        }
+
+        if (generator == eGpu) {
+            denseChunks.clear();
+            record([&gpuTriangle, count = size_t(densePoints), blending = blending] {
+                gpuTriangle.generate(count, 0, blending);
+            });
+            return;
+        }
+
+        size_t count = size_t(densePoints);
+        unsigned threads = defaultThreadCount();
+
+        denseScratch.resize(count);
+        generateSierpinski(denseScratch, { .seed = 0, .threads = threads, .blending = blending });
+        denseChunks = buildPointChunks(denseScratch, threads);
+
+        // the packed points move into the command, the render thread frees them
+        if (blending) {
+            std::vector<PointVertex> packed(count);
+            parallelFor(count, threads, [&](unsigned, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    packed[i] = packPoint(denseScratch[i]);
+                }
+            });
+            record([&dense, &denseIndexed, packed = std::move(packed)] {
+                dense.clear();
+                denseIndexed.clear();
+                dense.append(packed);
+            });
+        } else {
+            std::vector<PaletteVertex> indices(count);
+            parallelFor(count, threads, [&](unsigned, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    const auto& point = denseScratch[i];
+                    indices[i] = { packPoint(point).position, sierpinskiCornerIndex(point.colour) };
+                }
+            });
+            record([&dense, &denseIndexed, indices = std::move(indices)] {
+                dense.clear();
+                denseIndexed.clear();
+                denseIndexed.append(indices);
+            });
+        }
+    };
+
+    auto vs = loadAsset("data/square.vs.glsl");
+    auto fs = loadAsset("data/square.fs.glsl");
+
+    unsigned shader = createShader(vs.data(), fs.data());
+    int shaderCamera = glGetUniformLocation(shader, "camera");
 
-    auto vs = loadFile("data/square.vs.glsl");
-    auto fs = loadFile("data/square.fs.glsl");
+    auto paletteVs = loadAsset("data/palette.vs.glsl");
+    unsigned paletteShader = createShader(paletteVs.data(), fs.data());
+    int paletteCamera = glGetUniformLocation(paletteShader, "camera");
 
-    unsigned shader = createShader(vs.c_str(), fs.c_str());
+    std::array<Colour, kSierpinskiCorners.size()> palette;
+    for (size_t i = 0; i < palette.size(); i++) {
+        palette[i] = kSierpinskiCorners[i].colour;
+    }
+
+    glUseProgram(paletteShader);
+    glUniform3fv(glGetUniformLocation(paletteShader, "palette"), GLsizei(palette.size()), &palette[0].r);
+
+    // instanced squares, every instance is rewritten each frame
+    auto quadVs = loadAsset("data/quad.vs.glsl");
+    unsigned quadShader = createShader(quadVs.data(), fs.data());
+
+    // instances are written on the main thread and copied into the stream
+    // buffer on the render thread, mapping is a gl call
+    QuadBatch squares;
+    std::vector<QuadInstance> squareInstances[2];
+    int squareCount = 0;
+    bool spinSquares = true;
+    double squareTime = 0.0;
+
+    // background quad coloured by one of the perlin shader variants, only the
+    // variants that actually get picked are compiled
+    ShaderVariants background(loadAsset("data/perlin.vs.glsl"), loadAsset("data/perlin.fs.glsl"));
+
+    const auto kQuadVertices = std::to_array<Vertex>({
+        { { -1, -1, 0 }, { 0, 0 }, { 1, 0, 0 } },
+        { { 1, -1, 0 }, { 1, 0 }, { 0, 1, 0 } },
+        { { 1, 1, 0 }, { 1, 1 }, { 0, 0, 1 } },
+        { { -1, 1, 0 }, { 0, 1 }, { 1, 1, 1 } }
+    });
+    const auto kQuadIndices = std::to_array<unsigned>({ 0, 1, 2, 2, 3, 0 });
+
+    // meshes that never change are sub-allocated from one pool and drawn
+    // without binding buffers of their own
+    MeshPool staticMeshes(kVertexLayout<Vertex>, 256, 256);
+    MeshHandle quad = staticMeshes.create(kQuadVertices, kQuadIndices);
+
+    enum Background : int { eNoBackground, eVertexColour, eUniformColour, ePerlin, eBakedPerlin, eUvs };
+    const char *kBackgroundNames[] = { "None", "Vertex", "Uniform", "Perlin", "Baked Perlin", "UVs" };
+    const uint32_t kBackgroundVariants[] = {
+        0,
+        background.key("COLOUR_VERTEX"),
+        background.key("COLOUR_UNIFORM"),
+        background.key("COLOUR_PERLIN"),
+        background.key("COLOUR_BAKED"),
+        0
+    };
+
+    // the perlin background baked once on the cpu, the shader only samples it
+    unsigned noiseTexture = 0;
+    bool backgroundBaked = false;
+    auto bakeBackground = [&] {
+        NoiseParams params = { .kind = NoiseKind::eShader, .threads = defaultThreadCount() };
+
+        std::vector<float> noise(size_t(params.width) * params.height);
+        bakeNoise(noise, params);
+
+        std::vector<uint16_t> texels(noise.size());
+        packNoise(noise, texels);
+
+        record([&noiseTexture, params, texels = std::move(texels)] {
+            noiseTexture = createTexture(params.width, params.height, TextureFormat::eR16, texels.data());
+        });
+        backgroundBaked = true;
+    };
+
+    // fullscreen images made on the cpu, shares the background quad
+    unsigned imageShader = createShader(loadAsset("data/perlin.vs.glsl").data(), loadAsset("data/image.fs.glsl").data());
+
+    int backgroundMode = eNoBackground;
+    ImVec4 backgroundColour = ImVec4(0.2f, 0.2f, 0.3f, 1.0f);
+
+    auto cacheStats = getProgramCacheStats();
+    std::cout << "Program cache: " << cacheStats.hits << " hits, " << cacheStats.misses << " misses ("
+              << cacheStats.rejected << " rejected), " << cacheStats.loadSeconds * 1000.0 << " ms loading, "
+              << cacheStats.compileSeconds * 1000.0 << " ms compiling" << std::endl;
+    appLog.appendf("Program cache: %zu hits, %zu misses (%zu rejected), %.3f ms loading, %.3f ms compiling\n",
+                   cacheStats.hits, cacheStats.misses, cacheStats.rejected, cacheStats.loadSeconds * 1000.0, cacheStats.compileSeconds * 1000.0);
 
     // uncomment this call to draw in wireframe polygons.
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
-    ImVec4 clearColour = ImVec4(0.0f, 0.0f, 0.0f, 1.0f);
-    while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
-        processInput(window);
+    bool showProfiler = false;
+    bool showMetrics = false;
+    bool showLog = false;
+
+    // the benchmark scene, a quarter million cpu points and a hundred thousand
+    // squares over the baked perlin background with the profiler open. the
+    // camera slowly zooms in and blending flips every 120 frames so
+    // regenerating shows up in the timings too
+    auto scriptFrame = [&](int frame) {
+        if (frame == 0) {
+            generator = eParallel;
+            densePoints = 250'000;
+            backgroundMode = eBakedPerlin;
+            if (!backgroundBaked) {
+                bakeBackground();
+            }
+            squareCount = 100'000;
+            showProfiler = true;
+            regenerateDense();
+        } else if (frame % 120 == 0) {
+            blending = !blending;
+            regenerateDense();
+        }
+
+        // creep towards a corner so culling and level of detail get exercised
+        camera.zoomAt({ 0.6f, -0.6f }, 1.01f);
+    };
 
+    if (benchmark) {
+        profileSetHistoryLength(size_t(benchmarkFrames));
+    }
+
+    // imgui's device objects are made up front, NewFrame would otherwise
+    // make them on the main thread after the context has moved
+    {
+        AllocTagScope tag(AllocTag::eFonts);
         ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
+    }
+
+    DrawDataSnapshot drawData[2];
+    renderer = std::make_unique<RenderThread>([&](bool current) {
+        if (benchmark) {
+            makeHeadlessCurrent(window, current);
+        } else {
+            glfwMakeContextCurrent(current ? window : nullptr);
+        }
+    }, options.renderThread);
+
+    int frame = 0;
+    ImVec4 clearColour = ImVec4(0.0f, 0.0f, 0.0f, 1.0f);
+    while (benchmark ? frame < benchmarkFrames : !glfwWindowShouldClose(window)) {
+        // imgui tags draw list growth itself, whatever else it allocates
+        // during the frame is window and widget state
+        AllocTagScope storageTag(AllocTag::eStorage);
+
+        {
+            PROFILE_SCOPE("Poll Events");
+            glfwPollEvents();
+            processInput(window);
+        }
+
+        {
+            PROFILE_SCOPE("ImGui NewFrame");
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            if (benchmark || recording) {
+                io.DeltaTime = kInputRecordingStep;
+            }
+            if (replaying) {
+                input.replay();
+            } else if (recording) {
+                input.capture();
+            }
+            ImGui::NewFrame();
+        }
+
+        if (benchmark && !replaying) {
+            scriptFrame(frame);
+        }
 
         ImGui::Begin("Options");
             ImGui::ColorEdit3("Clear Colour", &clearColour.x);
-            if (ImGui::SliderInt("Steps", &steps, 1, 50000)) {
-                triangle = makeSierpinski(steps, blending);
+            if (ImGui::Combo("Background", &backgroundMode, kBackgroundNames, IM_ARRAYSIZE(kBackgroundNames))) {
+                if (backgroundMode == eBakedPerlin && !backgroundBaked) {
+                    bakeBackground();
+                }
+            }
+            if (backgroundMode == eUniformColour) {
+                ImGui::ColorEdit3("Background Colour", &backgroundColour.x);
+            }
+            int maxPoints = generator == eGpu ? 50'000'000 : 20'000'000;
+            if (ImGui::Combo("Generator", &generator, kGeneratorNames, IM_ARRAYSIZE(kGeneratorNames)) && generator != eIncremental) {
+                maxPoints = generator == eGpu ? 50'000'000 : 20'000'000;
+                densePoints = std::min(densePoints, maxPoints);
+                if (generator == eDeepZoom) {
+                    fitPreset();
+                }
+                regenerateDense();
+            }
+            if (generator == eIncremental) {
+                if (ImGui::SliderInt("Steps", &steps, 1, 50000)) {
+                    record([&triangle, steps = size_t(steps)] { triangle.setSteps(steps); });
+                }
+            } else if (generator == eDensity) {
+                auto presetName = [](void*, int index) { return ifsPresets()[size_t(index)].name; };
+                if (ImGui::Combo("Preset", &densityPreset, presetName, nullptr, int(ifsPresets().size()))) {
+                    regenerateDense();
+                }
+                sliderIntLog("Iterations / Frame", &densityIterations, 100'000, 50'000'000);
+                ImGui::SliderFloat("Gamma", &densityGamma, 1.f, 4.f);
+                if (ImGui::Button(ImGuiLiteralID("Restart"))) {
+                    regenerateDense();
+                }
+                ImGui::SameLine();
+                ImGui::Text("%.3g iterations", double(density.iterations()));
+            } else {
+                auto presetName = [](void*, int index) { return ifsPresets()[size_t(index)].name; };
+                if (generator == eDeepZoom && ImGui::Combo("Preset", &densityPreset, presetName, nullptr, int(ifsPresets().size()))) {
+                    fitPreset();
+                    regenerateDense();
+                }
+                if (sliderIntLog("Points", &densePoints, 1000, maxPoints)) {
+                    regenerateDense();
+                }
+            }
+            if (generator != eDensity && ImGui::Checkbox("Blending", &blending)) {
+                record([&triangle, blending = blending] { triangle.setBlending(blending); });
+                if (generator != eIncremental) {
+                    regenerateDense();
+                }
             }
-            if (ImGui::Checkbox("Blending", &blending)) {
-                triangle = makeSierpinski(steps, blending);
+            ImGui::SliderInt("Squares", &squareCount, 0, 1'000'000, "%d", ImGuiSliderFlags_Logarithmic);
+            ImGui::Checkbox("Spin", &spinSquares);
+            ImGui::Checkbox("Profiler", &showProfiler);
+            ImGui::SameLine();
+            ImGui::Checkbox("Metrics", &showMetrics);
+            ImGui::SameLine();
+            ImGui::Checkbox("Log", &showLog);
+
+            ImGui::SeparatorText("View");
+            ImGui::Text("Zoom %.3gx, drag to pan and scroll to zoom", camera.zoom);
+            if (ImGui::Button(ImGuiLiteralID("Reset View"))) {
+                camera = {};
+                if (generator == eDeepZoom) {
+                    fitPreset();
+                }
+            }
+            if (generator == eDeepZoom) {
+                unsigned depth = 0;
+                for (const auto& cell : deepCells) {
+                    depth = std::max(depth, cell.depth);
+                }
+                ImGui::Text("%zu of %d points on screen from %zu cells, %u maps deep", deepPoints, densePoints, deepCells.size(), depth);
+            }
+            if (generator == eParallel) {
+                ImGui::Checkbox("Cull", &cullPoints);
+                if (cullPoints) {
+                    ImGui::SliderFloat("Points / Pixel", &pointsPerPixel, 0.f, 16.f, "%.2f", ImGuiSliderFlags_Logarithmic);
+                    const auto& drawn = visibleChunks[renderer->slot() ^ 1];
+                    ImGui::Text("Drew %zu of %d points in %zu chunks", drawn.points, densePoints, drawn.chunks);
+                }
             }
         ImGui::End();
 
-        glClearColor(clearColour.x, clearColour.y, clearColour.z, clearColour.w);
-        glClear(GL_COLOR_BUFFER_BIT);
+        // drag to pan and scroll to zoom wherever imgui isnt using the mouse
+        if (!io.WantCaptureMouse && io.DisplaySize.x > 0.f && io.DisplaySize.y > 0.f) {
+            if (ImGui::IsMouseDown(ImGuiMouseButton_Left)) {
+                camera.x -= io.MouseDelta.x / io.DisplaySize.x * 2.f / camera.zoom;
+                camera.y += io.MouseDelta.y / io.DisplaySize.y * 2.f / camera.zoom;
+            }
+            if (io.MouseWheel != 0.f) {
+                Point2 ndc = { io.MousePos.x / io.DisplaySize.x * 2.f - 1.f, 1.f - io.MousePos.y / io.DisplaySize.y * 2.f };
+                camera.zoomAt(ndc, std::pow(1.2f, io.MouseWheel));
+            }
+        }
+
+        if (showProfiler) {
+            profileDrawWindow(&showProfiler);
+        }
+
+        if (showLog) {
+            if (ImGui::Begin("Log", &showLog)) {
+                logView.draw(appLog);
+            }
+            ImGui::End();
+        }
+
+        if (showMetrics) {
+            ImGui::ShowMetricsWindow(&showMetrics);
+
+            // beginning a window that already exists appends to it
+            if (ImGui::Begin("Dear ImGui Metrics/Debugger", &showMetrics)) {
+                allocatorDrawStats();
+            }
+            ImGui::End();
+        }
+
+        size_t slot = renderer->slot();
 
-        glUseProgram(shader);
-        triangle.bind();
-        triangle.draw();
+        if (squareCount > 0) {
+            PROFILE_SCOPE("Squares");
+            if (spinSquares) {
+                squareTime += io.DeltaTime;
+            }
+
+            auto count = uint32_t(squareCount);
+            auto perRow = uint32_t(std::ceil(std::sqrt(double(count))));
+            auto& instances = squareInstances[slot];
+            instances.resize(count);
+            parallelFor(count, defaultThreadCount(), [&](unsigned, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    instances[i] = makeSquare(uint32_t(i), perRow, squareTime);
+                }
+            });
+            record([&squares, instances = std::span<const QuadInstance>(instances)] {
+                PROFILE_SCOPE("Upload Squares");
+                squares.upload(instances);
+            });
+        }
+
+        if (generator == eDeepZoom && !(camera == deepCamera)) {
+            regenerateDense();
+        }
+
+        if (generator == eDensity) {
+            PROFILE_SCOPE("Density");
+            unsigned threads = defaultThreadCount();
+            density.accumulate(uint64_t(densityIterations), threads);
+            density.tonemap(densityImages[slot], densityGamma, threads);
+            record([densityTexture, image = densityImages[slot].data()] {
+                updateTexture(densityTexture, kWidth, kHeight, TextureFormat::eRgba8, image);
+            });
+        }
+
+        // the chunks to draw are picked here, the draw only reads them
+        auto& selection = visibleChunks[slot];
+        bool culled = generator == eParallel && cullPoints;
+        if (culled) {
+            float pixelsX = io.DisplaySize.x * io.DisplayFramebufferScale.x * 0.5f * float(camera.zoom);
+            float pixelsY = io.DisplaySize.y * io.DisplayFramebufferScale.y * 0.5f * float(camera.zoom);
+            selectPointChunks(denseChunks, { camera.view(), pixelsX, pixelsY, pointsPerPixel }, selection);
+        }
+
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(window, &width, &height);
+        record([width, height, clearColour] {
+            glViewport(0, 0, width, height);
+            glClearColor(clearColour.x, clearColour.y, clearColour.z, clearColour.w);
+            glClear(GL_COLOR_BUFFER_BIT);
+        });
+
+        if (backgroundMode != eNoBackground) {
+            record([&, mode = backgroundMode, colour = backgroundColour] {
+                unsigned program = background.get(kBackgroundVariants[mode]);
+                glUseProgram(program);
+                if (mode == eUniformColour) {
+                    glUniform3f(glGetUniformLocation(program, "colour"), colour.x, colour.y, colour.z);
+                } else if (mode == eBakedPerlin) {
+                    glActiveTexture(GL_TEXTURE0);
+                    glBindTexture(GL_TEXTURE_2D, noiseTexture);
+                    glUniform1i(glGetUniformLocation(program, "noiseTexture"), 0);
+                }
+
+                PROFILE_SCOPE("Background");
+                PROFILE_GPU_SCOPE("Background");
+
+                // everything else is drawn in wireframe
+                glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+                staticMeshes.bind();
+                staticMeshes.draw(quad, Primitive::eTriangles);
+                glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+            });
+        }
+
+        if (squareCount > 0) {
+            record([&] {
+                PROFILE_GPU_SCOPE("Squares");
+                glUseProgram(quadShader);
+                glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+                squares.bind();
+                squares.draw();
+                glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+            });
+        }
+
+        record([&, &selection = selection, view = camera.uniform(), generator = generator, blending = blending, culled] {
+            PROFILE_SCOPE("Points");
+            PROFILE_GPU_SCOPE("Points");
+            glUseProgram(paletteShader);
+            glUniform4fv(paletteCamera, 1, view.data());
+            glUseProgram(shader);
+            glUniform4fv(shaderCamera, 1, view.data());
+
+            if (generator == eIncremental) {
+                triangle.draw();
+            } else if (generator == eParallel) {
+                PointBuffer& points = blending ? dense : denseIndexed;
+                if (!blending) {
+                    glUseProgram(paletteShader);
+                }
+
+                points.bind();
+                if (culled) {
+                    points.draw(selection.firsts, selection.counts);
+                } else {
+                    points.draw(points.size());
+                }
+            } else if (generator == eDeepZoom) {
+                glUniform4f(shaderCamera, 0.f, 0.f, 1.f, 1.f);
+                dense.bind();
+                dense.draw(dense.size());
+            } else if (generator == eDensity) {
+                glUseProgram(imageShader);
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, densityTexture);
+                glUniform1i(glGetUniformLocation(imageShader, "image"), 0);
+
+                glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+                staticMeshes.bind();
+                staticMeshes.draw(quad, Primitive::eTriangles);
+                glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+            } else {
+                gpuTriangle.draw();
+            }
+        });
         // draw via the index buffer
         //meshes[currentMesh].draw();
 
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        {
+            PROFILE_SCOPE("ImGui Render");
+            ImGui::Render();
+            drawData[slot].capture(*ImGui::GetDrawData());
+            record([&snapshot = drawData[slot]] {
+                PROFILE_GPU_SCOPE("ImGui");
+                ImGui_ImplOpenGL3_RenderDrawData(snapshot.get());
+            });
+        }
+
+        record([&, index = profileFrameIndex()] {
+            {
+                PROFILE_SCOPE("Swap Buffers");
+                if (benchmark) {
+                    presentHeadless(window);
+                } else {
+                    glfwSwapBuffers(window);
+                }
+            }
+
+            staticMeshes.endFrame();
+
+            profileGpuEndFrame(index);
+        });
 
-        glfwSwapBuffers(window);
+        {
+            // waits for the previous frame, when the gpu is the bottleneck
+            // this is where the main thread feels it
+            PROFILE_SCOPE("Submit");
+            renderer->submit();
+        }
+
+        allocatorEndFrame();
+        profileEndFrame();
+        frame += 1;
     }
 
-    glfwTerminate();
-    return 0;
+    renderer->stop();
+
+    if (recording) {
+        if (input.save(recordPath)) {
+            std::cout << "Recorded " << input.eventCount() << " input events over " << input.frameCount() << " frames to " << recordPath << std::endl;
+        } else {
+            std::cout << "Failed to write input recording " << recordPath << std::endl;
+        }
+    }
+
+    if (benchmark) {
+        profileGpuFlush();
+
+        FrameTimings timings;
+        for (const auto& it : profileHistory()) {
+            if (it.index >= kWarmupFrames) {
+                timings.add(it);
+            }
+        }
+        timings.print(std::cout);
+    }
 }
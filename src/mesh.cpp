@@ -2,27 +2,65 @@
 
 #include "glad/glad.h"
 
-Mesh::Mesh(std::span<const Vertex2> vertices, std::span<const unsigned> indices) {
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+namespace {
+    GLenum attribType(AttribType type) {
+        switch (type) {
+        case AttribType::eFloat: return GL_FLOAT;
+        case AttribType::eHalf: return GL_HALF_FLOAT;
+        case AttribType::eShort: return GL_SHORT;
+        case AttribType::eUnsignedByte: return GL_UNSIGNED_BYTE;
+        case AttribType::eUnsignedShort: return GL_UNSIGNED_SHORT;
+        }
+
+        return GL_FLOAT;
+    }
+}
+
+unsigned primitiveMode(Primitive primitive) {
+    switch (primitive) {
+    case Primitive::ePoints: return GL_POINTS;
+    case Primitive::eLines: return GL_LINES;
+    case Primitive::eTriangles: return GL_TRIANGLES;
+    }
+
+    return GL_POINTS;
+}
+
+void setupAttribs(const VertexLayout& layout, size_t base) {
+    for (const auto& attrib : layout.attribs) {
+        auto stride = GLsizei(layout.stride);
+        auto offset = (void*)(base + attrib.offset);
+
+        if (attrib.integer) {
+            glVertexAttribIPointer(attrib.location, attrib.components, attribType(attrib.type), stride, offset);
+        } else {
+            glVertexAttribPointer(attrib.location, attrib.components, attribType(attrib.type), attrib.normalized, stride, offset);
+        }
+
+        glVertexAttribDivisor(attrib.location, attrib.divisor);
+        glEnableVertexAttribArray(attrib.location);
+    }
+}
+
+Mesh::Mesh(const VertexLayout& layout, std::span<const std::byte> vertices, std::span<const unsigned> indices) {
     numIndices = indices.size();
-    numVertices = vertices.size();
+    numVertices = vertices.size() / layout.stride;
 
     glGenVertexArrays(1, &vao);
     glBindVertexArray(vao);
 
     glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
 
     // bind and upload the vertex data
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex2), vertices.data(), GL_STATIC_DRAW);
-
-    // our first 3 floats are the position
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex2), (void*)offsetof(Vertex2, position));
-    glEnableVertexAttribArray(0);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size(), vertices.data(), GL_STATIC_DRAW);
 
-    // then colour
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex2), (void*)offsetof(Vertex2, colour));
-    glEnableVertexAttribArray(1);
+    setupAttribs(layout);
 
     // index buffer
     glGenBuffers(1, &ebo);
@@ -33,11 +71,186 @@ Mesh::Mesh(std::span<const Vertex2> vertices, std::span<const unsigned> indices)
     glBindVertexArray(0);
 }
 
+Mesh::~Mesh() {
+    // a moved from mesh has all its names zeroed, which gl silently ignores
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
+}
+
+Mesh::Mesh(Mesh&& other) noexcept
+    : numVertices(other.numVertices)
+    , numIndices(other.numIndices)
+    , vao(std::exchange(other.vao, 0))
+    , vbo(std::exchange(other.vbo, 0))
+    , ebo(std::exchange(other.ebo, 0))
+{ }
+
+Mesh& Mesh::operator=(Mesh&& other) noexcept {
+    std::swap(numVertices, other.numVertices);
+    std::swap(numIndices, other.numIndices);
+    std::swap(vao, other.vao);
+    std::swap(vbo, other.vbo);
+    std::swap(ebo, other.ebo);
+    return *this;
+}
+
 void Mesh::bind() {
     glBindVertexArray(vao);
 }
 
-void Mesh::draw() {
+void Mesh::draw(Primitive primitive) {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glDrawElements(GL_POINTS, GLsizei(numIndices), GL_UNSIGNED_INT, 0);
+    glDrawElements(primitiveMode(primitive), GLsizei(numIndices), GL_UNSIGNED_INT, 0);
+}
+
+// dynamic mesh
+
+DynamicMesh::DynamicMesh(const VertexLayout& layout, size_t initialCapacity, StreamMode mode)
+    : layout(layout)
+    , vertices(std::max<size_t>(initialCapacity, 1) * layout.stride, mode)
+{
+    glGenVertexArrays(1, &vao);
+}
+
+DynamicMesh::~DynamicMesh() {
+    glDeleteVertexArrays(1, &vao);
+}
+
+std::span<std::byte> DynamicMesh::mapBytes(size_t bytes) {
+    numVertices = 0;
+    numMapped = bytes / layout.stride;
+    return vertices.map(numMapped * layout.stride);
+}
+
+void DynamicMesh::unmap() {
+    numVertices = vertices.unmap() ? numMapped : 0;
+
+    // the regions grew into a new buffer
+    if (attached != vertices.buffer()) {
+        attached = vertices.buffer();
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, attached);
+        setupAttribs(layout);
+        glBindVertexArray(0);
+    }
+}
+
+void DynamicMesh::upload(std::span<const std::byte> data) {
+    auto mapped = mapBytes(data.size());
+    if (mapped.empty()) { return; }
+
+    std::copy(data.begin(), data.begin() + ptrdiff_t(mapped.size()), mapped.begin());
+    unmap();
+}
+
+void DynamicMesh::bind() {
+    glBindVertexArray(vao);
+}
+
+void DynamicMesh::draw(Primitive primitive) {
+    if (numVertices == 0) { return; }
+
+    // regions are a whole number of vertices so the region can be picked
+    // with the first vertex rather than by moving the attributes
+    auto first = GLint(vertices.offset() / layout.stride);
+    glDrawArrays(primitiveMode(primitive), first, GLsizei(numVertices));
+    vertices.fence();
+}
+
+// point buffer
+
+PointBuffer::PointBuffer(const VertexLayout& layout, size_t initialCapacity)
+    : layout(layout)
+{
+    numCapacity = std::max<size_t>(initialCapacity, 1);
+
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, numCapacity * layout.stride, nullptr, GL_DYNAMIC_DRAW);
+
+    setupAttribs(layout);
+
+    glBindVertexArray(0);
+}
+
+PointBuffer::~PointBuffer() {
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+}
+
+void PointBuffer::checkStride(size_t stride) const {
+    if (stride != layout.stride) {
+        std::cout << "Appended " << stride << " byte points to a point buffer of " << layout.stride << " byte points" << std::endl;
+        std::abort();
+    }
+}
+
+void PointBuffer::grow(size_t required) {
+    size_t newCapacity = numCapacity;
+    while (newCapacity < required) {
+        newCapacity *= 2;
+    }
+
+    unsigned newVbo = 0;
+    glGenBuffers(1, &newVbo);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newVbo);
+    glBufferData(GL_COPY_WRITE_BUFFER, newCapacity * layout.stride, nullptr, GL_DYNAMIC_DRAW);
+
+    // copy the old points across on the gpu rather than reuploading them
+    glBindBuffer(GL_COPY_READ_BUFFER, vbo);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, numPoints * layout.stride);
+
+    glDeleteBuffers(1, &vbo);
+    vbo = newVbo;
+    numCapacity = newCapacity;
+
+    // the vao still points at the old buffer
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    setupAttribs(layout);
+    glBindVertexArray(0);
+}
+
+void PointBuffer::append(std::span<const std::byte> points) {
+    if (points.empty()) { return; }
+    if (points.size() % layout.stride != 0) {
+        std::cout << "Appended " << points.size() << " bytes to a point buffer of " << layout.stride << " byte points" << std::endl;
+        std::abort();
+    }
+
+    size_t required = numPoints + points.size() / layout.stride;
+    if (required > numCapacity) {
+        grow(required);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, numPoints * layout.stride, points.size(), points.data());
+
+    numPoints = required;
+}
+
+void PointBuffer::resize(size_t count) {
+    if (count > numCapacity) {
+        grow(count);
+    }
+
+    numPoints = count;
+}
+
+void PointBuffer::bind() {
+    glBindVertexArray(vao);
+}
+
+void PointBuffer::draw(size_t count) {
+    glDrawArrays(GL_POINTS, 0, GLsizei(std::min(count, numPoints)));
+}
+
+void PointBuffer::draw(std::span<const int> firsts, std::span<const int> counts) {
+    if (firsts.empty()) { return; }
+
+    glMultiDrawArrays(GL_POINTS, firsts.data(), counts.data(), GLsizei(std::min(firsts.size(), counts.size())));
 }
@@ -1,35 +1,41 @@
 #pragma once
 
+#include "stream.h"
+#include "vertex.h"
+
+#include <ranges>
 #include <span>
 
-struct Vec3 {
-    float x, y, z;
+enum class Primitive {
+    ePoints,
+    eLines,
+    eTriangles
 };
 
-struct Vec2 {
-    float u, v;
-};
+// the gl enum for a primitive
+unsigned primitiveMode(Primitive primitive);
 
-struct Colour {
-    float r, g, b;
-};
+// point the attributes of the bound vao at the bound vbo, starting `base` bytes in
+void setupAttribs(const VertexLayout& layout, size_t base = 0);
 
-struct Vertex {
-    Vec3 position;
-    Vec2 texcoord;
-    Colour colour;
-};
+struct Mesh {
+    // vertices can be any type with a VertexFormat specialisation
+    template<std::ranges::contiguous_range R>
+    Mesh(const R& vertices, std::span<const unsigned> indices)
+        : Mesh(kVertexLayout<std::ranges::range_value_t<R>>, std::as_bytes(std::span(vertices)), indices)
+    { }
 
-struct Vertex2 {
-    Vec3 position;
-    Colour colour;
-};
+    Mesh(const VertexLayout& layout, std::span<const std::byte> vertices, std::span<const unsigned> indices);
+    ~Mesh();
 
-struct Mesh {
-    Mesh(std::span<const Vertex2> vertices, std::span<const unsigned> indices);
+    Mesh(Mesh&& other) noexcept;
+    Mesh& operator=(Mesh&& other) noexcept;
+
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
 
     void bind();
-    void draw();
+    void draw(Primitive primitive = Primitive::ePoints);
 
 private:
     size_t numVertices;
@@ -38,3 +44,101 @@ private:
     unsigned vbo;
     unsigned ebo;
 };
+
+// a mesh whose vertices are rewritten every frame, drawn without an index
+// buffer. vertices go through a StreamBuffer so writing them never waits on
+// draws still reading the previous frames, where Mesh would reallocate
+struct DynamicMesh {
+    DynamicMesh(const VertexLayout& layout, size_t initialCapacity = 1024, StreamMode mode = StreamMode::eAuto);
+    ~DynamicMesh();
+
+    DynamicMesh(const DynamicMesh&) = delete;
+    DynamicMesh& operator=(const DynamicMesh&) = delete;
+
+    // room for `count` vertices replacing the current ones, in the same
+    // layout the mesh was created with. as with StreamBuffer::map an empty
+    // span means unmap must not be called
+    template<typename V>
+    std::span<V> map(size_t count) {
+        auto bytes = mapBytes(count * sizeof(V));
+        return { reinterpret_cast<V*>(bytes.data()), bytes.size() / sizeof(V) };
+    }
+
+    std::span<std::byte> mapBytes(size_t bytes);
+    void unmap();
+
+    template<std::ranges::contiguous_range R>
+    void upload(const R& vertices) {
+        upload(std::span<const std::byte>(std::as_bytes(std::span(vertices))));
+    }
+
+    void upload(std::span<const std::byte> vertices);
+
+    size_t size() const { return numVertices; }
+    const StreamBuffer& stream() const { return vertices; }
+
+    void bind();
+
+    // fences the vertices once drawn, draw every frame after unmap
+    void draw(Primitive primitive = Primitive::ePoints);
+
+private:
+    VertexLayout layout;
+    StreamBuffer vertices;
+    size_t numVertices = 0;
+    size_t numMapped = 0;
+    unsigned vao;
+    unsigned attached = 0;
+};
+
+// a vertex buffer that only ever grows, drawn as points without an index buffer.
+// storage doubles when it runs out and new points are uploaded with glBufferSubData
+// so appending n points costs O(n) rather than reuploading everything
+struct PointBuffer {
+    PointBuffer(const VertexLayout& layout = kVertexLayout<Vertex2>, size_t initialCapacity = 1024);
+    ~PointBuffer();
+
+    PointBuffer(const PointBuffer&) = delete;
+    PointBuffer& operator=(const PointBuffer&) = delete;
+
+    // upload points after the last point currently in the buffer, they
+    // must match the layout the buffer was created with
+    template<std::ranges::contiguous_range R>
+    void append(const R& points) {
+        checkStride(sizeof(std::ranges::range_value_t<R>));
+        append(std::span<const std::byte>(std::as_bytes(std::span(points))));
+    }
+
+    // a whole number of points
+    void append(std::span<const std::byte> points);
+
+    // make room for `count` points without uploading anything, for when
+    // the gpu writes the points itself. existing points are kept
+    void resize(size_t count);
+
+    // forget all points but keep the storage around
+    void clear() { numPoints = 0; }
+
+    size_t size() const { return numPoints; }
+    size_t capacity() const { return numCapacity; }
+    unsigned buffer() const { return vbo; }
+
+    void bind();
+
+    // draw the first `count` points, clamped to however many we have
+    void draw(size_t count);
+
+    // draw several ranges of points in one call, see selectPointChunks
+    void draw(std::span<const int> firsts, std::span<const int> counts);
+
+private:
+    // points of another size would be counted wrong and written past the end
+    void checkStride(size_t stride) const;
+    void grow(size_t required);
+
+    VertexLayout layout;
+    size_t numPoints = 0;
+    size_t numCapacity = 0;
+    unsigned vao;
+    unsigned vbo;
+};
@@ -0,0 +1,200 @@
+#include "meshpool.h"
+
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // make a bigger buffer and copy the old contents over on the gpu
+    void resizeBuffer(unsigned& buffer, size_t oldSize, size_t newSize) {
+        unsigned newBuffer = 0;
+        glGenBuffers(1, &newBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_STATIC_DRAW);
+
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSize);
+
+        glDeleteBuffers(1, &buffer);
+        buffer = newBuffer;
+    }
+}
+
+// mesh handle
+
+MeshHandle::MeshHandle(MeshHandle&& other) noexcept
+    : pool(std::exchange(other.pool, nullptr))
+    , vertices(other.vertices)
+    , indices(other.indices)
+    , numVertices(other.numVertices)
+    , numIndices(other.numIndices)
+{ }
+
+MeshHandle& MeshHandle::operator=(MeshHandle&& other) noexcept {
+    std::swap(pool, other.pool);
+    std::swap(vertices, other.vertices);
+    std::swap(indices, other.indices);
+    std::swap(numVertices, other.numVertices);
+    std::swap(numIndices, other.numIndices);
+    return *this;
+}
+
+void MeshHandle::reset() {
+    if (pool == nullptr) { return; }
+
+    pool->release(*this);
+    pool = nullptr;
+}
+
+// mesh pool
+
+MeshPool::MeshPool(const VertexLayout& layout, size_t vertexCapacity, size_t indexCapacity)
+    : layout(layout)
+    , vertexAllocator(vertexCapacity)
+    , indexAllocator(indexCapacity)
+{
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertexAllocator.capacity() * layout.stride, nullptr, GL_STATIC_DRAW);
+
+    setupAttribs(layout);
+
+    glGenBuffers(1, &ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexAllocator.capacity() * sizeof(unsigned), nullptr, GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+}
+
+MeshPool::~MeshPool() {
+    collect(true);
+
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
+}
+
+void MeshPool::growVertices() {
+    size_t oldSize = vertexAllocator.capacity() * layout.stride;
+    vertexAllocator.grow();
+    resizeBuffer(vbo, oldSize, vertexAllocator.capacity() * layout.stride);
+
+    // the vao still points at the old buffer
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    setupAttribs(layout);
+    glBindVertexArray(0);
+}
+
+void MeshPool::growIndices() {
+    size_t oldSize = indexAllocator.capacity() * sizeof(unsigned);
+    indexAllocator.grow();
+
+    // the element buffer binding is vao state, so do this with no vao bound
+    glBindVertexArray(0);
+    resizeBuffer(ebo, oldSize, indexAllocator.capacity() * sizeof(unsigned));
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBindVertexArray(0);
+}
+
+MeshHandle MeshPool::create(std::span<const std::byte> vertices, std::span<const unsigned> indices) {
+    size_t vertexCount = vertices.size() / layout.stride;
+
+    MeshHandle mesh;
+    while (!vertexAllocator.allocate(vertexCount, mesh.vertices)) {
+        growVertices();
+    }
+
+    while (!indexAllocator.allocate(indices.size(), mesh.indices)) {
+        growIndices();
+    }
+
+    mesh.pool = this;
+    mesh.numVertices = vertexCount;
+    mesh.numIndices = indices.size();
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, mesh.vertices.offset * layout.stride, vertices.size(), vertices.data());
+
+    // go through the copy target so we dont disturb whatever vao is bound
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, mesh.indices.offset * sizeof(unsigned), indices.size_bytes(), indices.data());
+
+    return mesh;
+}
+
+void MeshPool::bind() {
+    glBindVertexArray(vao);
+}
+
+void MeshPool::draw(const MeshHandle& mesh, Primitive primitive) {
+    auto offset = (const void*)(mesh.indices.offset * sizeof(unsigned));
+    glDrawElementsBaseVertex(primitiveMode(primitive), GLsizei(mesh.numIndices), GL_UNSIGNED_INT, offset, GLint(mesh.vertices.offset));
+}
+
+void MeshPool::draw(std::span<const MeshHandle> meshes, Primitive primitive) {
+    drawCounts.clear();
+    drawOffsets.clear();
+    drawBaseVertices.clear();
+
+    for (const auto& mesh : meshes) {
+        if (!mesh) { continue; }
+
+        drawCounts.push_back(GLsizei(mesh.numIndices));
+        drawOffsets.push_back((const void*)(mesh.indices.offset * sizeof(unsigned)));
+        drawBaseVertices.push_back(GLint(mesh.vertices.offset));
+    }
+
+    glMultiDrawElementsBaseVertex(primitiveMode(primitive), drawCounts.data(), GL_UNSIGNED_INT,
+        drawOffsets.data(), GLsizei(drawCounts.size()), drawBaseVertices.data());
+}
+
+void MeshPool::release(MeshHandle& mesh) {
+    releasedThisFrame.push_back({ mesh.vertices, mesh.indices });
+}
+
+void MeshPool::endFrame() {
+    if (!releasedThisFrame.empty()) {
+        auto fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        pendingFrames.push_back({ fence, std::move(releasedThisFrame) });
+        releasedThisFrame.clear();
+    }
+
+    collect(false);
+}
+
+void MeshPool::collect(bool wait) {
+    // fences signal in order, stop at the first one that hasnt
+    size_t done = 0;
+    for (auto& frame : pendingFrames) {
+        auto fence = GLsync(frame.fence);
+        auto timeout = wait ? GL_TIMEOUT_IGNORED : 0;
+        auto status = glClientWaitSync(fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, timeout);
+        if (status == GL_TIMEOUT_EXPIRED) { break; }
+
+        glDeleteSync(fence);
+        for (const auto& block : frame.blocks) {
+            vertexAllocator.free(block.vertices);
+            indexAllocator.free(block.indices);
+        }
+
+        done++;
+    }
+
+    pendingFrames.erase(pendingFrames.begin(), pendingFrames.begin() + done);
+
+    // the pool is going away, nothing else will free these
+    if (wait) {
+        for (const auto& block : releasedThisFrame) {
+            vertexAllocator.free(block.vertices);
+            indexAllocator.free(block.indices);
+        }
+        releasedThisFrame.clear();
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "buddy.h"
+#include "mesh.h"
+
+#include <ranges>
+#include <span>
+#include <vector>
+
+struct MeshPool;
+
+// a range of vertices and indices inside a MeshPool. move only, dropping it
+// hands the memory back to the pool once the gpu is done with it. handles
+// must not outlive their pool
+struct MeshHandle {
+    MeshHandle() = default;
+    ~MeshHandle() { reset(); }
+
+    MeshHandle(MeshHandle&& other) noexcept;
+    MeshHandle& operator=(MeshHandle&& other) noexcept;
+
+    MeshHandle(const MeshHandle&) = delete;
+    MeshHandle& operator=(const MeshHandle&) = delete;
+
+    void reset();
+
+    explicit operator bool() const { return pool != nullptr; }
+
+    size_t vertexCount() const { return numVertices; }
+    size_t indexCount() const { return numIndices; }
+
+private:
+    friend struct MeshPool;
+
+    MeshPool *pool = nullptr;
+    BuddyAllocator::Block vertices;
+    BuddyAllocator::Block indices;
+    size_t numVertices = 0;
+    size_t numIndices = 0;
+};
+
+// sub-allocates many meshes of the same vertex layout out of one vertex and
+// one index buffer that share a single vao. meshes are drawn with base vertex
+// offsets so switching between them costs no binds at all, and the buffers
+// double in size when they run out
+struct MeshPool {
+    MeshPool(const VertexLayout& layout, size_t vertexCapacity = 0x10000, size_t indexCapacity = 0x10000);
+    ~MeshPool();
+
+    MeshPool(const MeshPool&) = delete;
+    MeshPool& operator=(const MeshPool&) = delete;
+
+    // indices are relative to the first vertex of this mesh
+    template<std::ranges::contiguous_range R>
+    MeshHandle create(const R& vertices, std::span<const unsigned> indices) {
+        return create(std::span<const std::byte>(std::as_bytes(std::span(vertices))), indices);
+    }
+
+    MeshHandle create(std::span<const std::byte> vertices, std::span<const unsigned> indices);
+
+    void bind();
+
+    // expects the pool to be bound
+    void draw(const MeshHandle& mesh, Primitive primitive = Primitive::ePoints);
+
+    // draw many meshes with a single multi draw call
+    void draw(std::span<const MeshHandle> meshes, Primitive primitive = Primitive::ePoints);
+
+    // call once per frame after submitting, fences this frames frees and
+    // recycles the memory of frames the gpu has finished with
+    void endFrame();
+
+    size_t vertexBytesUsed() const { return vertexAllocator.used() * layout.stride; }
+    size_t indexBytesUsed() const { return indexAllocator.used() * sizeof(unsigned); }
+
+    const BuddyAllocator& vertexSpace() const { return vertexAllocator; }
+    const BuddyAllocator& indexSpace() const { return indexAllocator; }
+
+    // frames whose frees are still waiting on their fence
+    size_t pendingFrameCount() const { return pendingFrames.size(); }
+
+private:
+    friend struct MeshHandle;
+
+    // called by handles, the memory is only reused after the fence of the
+    // frame it was released in has signalled
+    void release(MeshHandle& mesh);
+
+    void growVertices();
+    void growIndices();
+
+    void collect(bool wait);
+
+    struct PendingFree {
+        BuddyAllocator::Block vertices;
+        BuddyAllocator::Block indices;
+    };
+
+    struct PendingFrame {
+        void *fence;
+        std::vector<PendingFree> blocks;
+    };
+
+    VertexLayout layout;
+
+    BuddyAllocator vertexAllocator;
+    BuddyAllocator indexAllocator;
+
+    std::vector<PendingFree> releasedThisFrame;
+    std::vector<PendingFrame> pendingFrames;
+
+    // scratch for multi draws
+    std::vector<int> drawCounts;
+    std::vector<const void*> drawOffsets;
+    std::vector<int> drawBaseVertices;
+
+    unsigned vao;
+    unsigned vbo;
+    unsigned ebo;
+};
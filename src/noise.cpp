@@ -0,0 +1,292 @@
+#include "noise.h"
+#include "noisetile.h"
+
+#include "parallel.h"
+#include "profile.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define NOISE_SSE2 1
+#endif
+
+namespace {
+    // bakes are split between threads in square tiles of this many texels
+    constexpr unsigned kTileSize = 64;
+
+    float interpolate(float a0, float a1, float w) {
+        return (a1 - a0) * w + a0;
+    }
+
+    // randomGradient in perlin.fs.glsl, minus the cos and sin
+    float gradientAngle(int hash, float x, float y, float z) {
+        int h = hash & 15;
+        float u = h < 8 ? x : y;
+        float v = h < 4 ? y : h == 12 || h == 14 ? x : z;
+        return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+    }
+
+    float dotGridGradient(int ix, int iy, float x, float y) {
+        float angle = gradientAngle(ix + iy, x, y, 0.f);
+
+        float dx = x - float(ix);
+        float dy = y - float(iy);
+
+        return dx * std::cos(angle) + dy * std::sin(angle);
+    }
+
+    int wrap(int value, int period) {
+        if (period <= 0) { return value; }
+
+        int result = value % period;
+        return result < 0 ? result + period : result;
+    }
+
+    uint32_t latticeHash(int ix, int iy) {
+        uint32_t h = (uint32_t(ix) * 0x27d4eb2du) ^ (uint32_t(iy) * 0x165667b1u);
+        h ^= h >> 15;
+        h *= 0x2c1b3c6du;
+        h ^= h >> 12;
+        return h;
+    }
+
+    // one of the four diagonal gradients dotted with the offset
+    float gradient(uint32_t hash, float dx, float dy) {
+        return ((hash & 1) ? -dx : dx) + ((hash & 2) ? -dy : dy);
+    }
+
+    float fade(float t) {
+        return t * t * t * (t * (t * 6.f - 15.f) + 10.f);
+    }
+
+    // tileable fbm needs every octave to land on whole lattice cells
+    float effectiveLacunarity(const NoiseParams& params) {
+        return params.tileable ? std::max(1.f, std::round(params.lacunarity)) : params.lacunarity;
+    }
+
+    int effectivePeriod(const NoiseParams& params) {
+        if (!params.tileable || params.kind == NoiseKind::eShader) { return 0; }
+
+        return std::max(1, int(std::lround(params.frequency)));
+    }
+
+    float effectiveFrequency(const NoiseParams& params) {
+        int period = effectivePeriod(params);
+        return period > 0 ? float(period) : params.frequency;
+    }
+}
+
+float shaderNoise(float x, float y) {
+    int x0 = int(std::floor(x));
+    int x1 = x0 + 1;
+    int y0 = int(std::floor(y));
+    int y1 = y0 + 1;
+
+    float sx = x - float(x0);
+    float sy = y - float(y0);
+
+    float ix0 = interpolate(dotGridGradient(x0, y0, x, y), dotGridGradient(x1, y0, x, y), sx);
+    float ix1 = interpolate(dotGridGradient(x0, y1, x, y), dotGridGradient(x1, y1, x, y), sx);
+
+    return interpolate(ix0, ix1, sy);
+}
+
+float perlinNoise(float x, float y, int period) {
+    float fx = std::floor(x);
+    float fy = std::floor(y);
+
+    int x0 = wrap(int(fx), period);
+    int x1 = wrap(int(fx) + 1, period);
+    int y0 = wrap(int(fy), period);
+    int y1 = wrap(int(fy) + 1, period);
+
+    float dx = x - fx;
+    float dy = y - fy;
+
+    float n00 = gradient(latticeHash(x0, y0), dx, dy);
+    float n10 = gradient(latticeHash(x1, y0), dx - 1.f, dy);
+    float n01 = gradient(latticeHash(x0, y1), dx, dy - 1.f);
+    float n11 = gradient(latticeHash(x1, y1), dx - 1.f, dy - 1.f);
+
+    float u = fade(dx);
+    float v = fade(dy);
+
+    return interpolate(interpolate(n00, n10, u), interpolate(n01, n11, u), v);
+}
+
+float fbmNoise(float x, float y, int period, unsigned octaves, float lacunarity, float gain) {
+    float sum = 0.f;
+    float total = 0.f;
+    float amplitude = 1.f;
+    float scale = 1.f;
+
+    for (unsigned i = 0; i < octaves; i++) {
+        int octavePeriod = period > 0 ? int(std::lround(float(period) * scale)) : 0;
+        sum += amplitude * perlinNoise(x * scale, y * scale, octavePeriod);
+        total += amplitude;
+
+        amplitude *= gain;
+        scale *= lacunarity;
+    }
+
+    return total > 0.f ? sum / total : 0.f;
+}
+
+float referenceNoise(const NoiseParams& params, unsigned x, unsigned y) {
+    float frequency = effectiveFrequency(params);
+    float px = (float(x) + 0.5f) / float(params.width) * frequency;
+    float py = (float(y) + 0.5f) / float(params.height) * frequency;
+
+    switch (params.kind) {
+    case NoiseKind::eShader: return shaderNoise(px, py);
+    case NoiseKind::ePerlin: return perlinNoise(px, py, effectivePeriod(params));
+    case NoiseKind::eFbm: return fbmNoise(px, py, effectivePeriod(params), params.octaves, effectiveLacunarity(params), params.gain);
+    }
+
+    return 0.f;
+}
+
+#if NOISE_SSE2
+
+// simd lanes, the kernels themselves are in noisesimd.h
+
+namespace {
+    constexpr unsigned kWidth = 4;
+
+    struct F { __m128 v; };
+    struct I { __m128i v; };
+
+    F splat(float value) { return { _mm_set1_ps(value) }; }
+    I splat(int value) { return { _mm_set1_epi32(value) }; }
+    F load(const float *data) { return { _mm_loadu_ps(data) }; }
+    void store(float *data, F value) { _mm_storeu_ps(data, value.v); }
+
+    F operator+(F a, F b) { return { _mm_add_ps(a.v, b.v) }; }
+    F operator-(F a, F b) { return { _mm_sub_ps(a.v, b.v) }; }
+    F operator*(F a, F b) { return { _mm_mul_ps(a.v, b.v) }; }
+    F operator/(F a, F b) { return { _mm_div_ps(a.v, b.v) }; }
+    F operator-(F a) { return { _mm_xor_ps(a.v, _mm_set1_ps(-0.f)) }; }
+
+    I operator+(I a, I b) { return { _mm_add_epi32(a.v, b.v) }; }
+    I operator&(I a, I b) { return { _mm_and_si128(a.v, b.v) }; }
+    I operator|(I a, I b) { return { _mm_or_si128(a.v, b.v) }; }
+    I operator^(I a, I b) { return { _mm_xor_si128(a.v, b.v) }; }
+    I operator>>(I a, int n) { return { _mm_srl_epi32(a.v, _mm_cvtsi32_si128(n)) }; }
+    I operator==(I a, I b) { return { _mm_cmpeq_epi32(a.v, b.v) }; }
+    I operator<(I a, I b) { return { _mm_cmplt_epi32(a.v, b.v) }; }
+
+    // sse2 has no 32 bit multiply, do the even and odd lanes separately
+    I mullo(I a, I b) {
+        __m128i even = _mm_mul_epu32(a.v, b.v);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a.v, 32), _mm_srli_epi64(b.v, 32));
+        return { _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0))) };
+    }
+
+    I equal(F a, F b) { return { _mm_castps_si128(_mm_cmpeq_ps(a.v, b.v)) }; }
+
+    // truncate and step down where that rounded up, fine for |a| < 2^31
+    F floor(F a) {
+        __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+        return { _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a.v), _mm_set1_ps(1.f))) };
+    }
+
+    I truncate(F a) { return { _mm_cvttps_epi32(a.v) }; }
+    I round(F a) { return { _mm_cvtps_epi32(a.v) }; }
+    F toFloat(I a) { return { _mm_cvtepi32_ps(a.v) }; }
+
+    F select(I mask, F a, F b) {
+        __m128 m = _mm_castsi128_ps(mask.v);
+        return { _mm_or_ps(_mm_and_ps(m, a.v), _mm_andnot_ps(m, b.v)) };
+    }
+}
+
+#include "noisesimd.h"
+
+#else
+
+namespace {
+    void bakeTile(const NoiseTile& tile) {
+        for (unsigned y = tile.y0; y < tile.y1; y++) {
+            float py = (float(y) + 0.5f) * tile.scaleY;
+            for (unsigned x = tile.x0; x < tile.x1; x++) {
+                float px = (float(x) + 0.5f) * tile.scaleX;
+
+                float noise;
+                switch (tile.kind) {
+                case NoiseKind::eShader: noise = shaderNoise(px, py); break;
+                case NoiseKind::ePerlin: noise = perlinNoise(px, py, tile.period); break;
+                default: noise = fbmNoise(px, py, tile.period, tile.octaves, tile.lacunarity, tile.gain); break;
+                }
+
+                tile.out[size_t(y) * tile.width + x] = noise;
+            }
+        }
+    }
+}
+
+#endif
+
+bool noiseAvx2Supported() {
+#if HELLO_NOISE_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+void bakeNoise(std::span<float> out, const NoiseParams& params) {
+    unsigned tilesX = (params.width + kTileSize - 1) / kTileSize;
+    unsigned tilesY = (params.height + kTileSize - 1) / kTileSize;
+
+    float frequency = effectiveFrequency(params);
+    NoiseTile bake = {
+        .out = out.data(),
+        .width = params.width,
+        .kind = params.kind,
+        .scaleX = frequency / float(params.width),
+        .scaleY = frequency / float(params.height),
+        .period = effectivePeriod(params),
+        .octaves = params.octaves,
+        .lacunarity = effectiveLacunarity(params),
+        .gain = params.gain
+    };
+
+    [[maybe_unused]] bool avx2 = params.avx2 && noiseAvx2Supported();
+
+    PROFILE_SCOPE("Bake Noise");
+    parallelFor(size_t(tilesX) * tilesY, params.threads, [&](unsigned, size_t begin, size_t end) {
+        PROFILE_SCOPE("Bake Tiles");
+        for (size_t index = begin; index < end; index++) {
+            NoiseTile tile = bake;
+            tile.x0 = unsigned(index % tilesX) * kTileSize;
+            tile.y0 = unsigned(index / tilesX) * kTileSize;
+            tile.x1 = std::min(tile.x0 + kTileSize, params.width);
+            tile.y1 = std::min(tile.y0 + kTileSize, params.height);
+
+#if HELLO_NOISE_AVX2
+            if (avx2) {
+                bakeTileAvx2(tile);
+                continue;
+            }
+#endif
+
+            bakeTile(tile);
+        }
+    });
+}
+
+void packNoise(std::span<const float> noise, std::span<uint8_t> out) {
+    for (size_t i = 0; i < noise.size(); i++) {
+        float unorm = std::clamp(noise[i] * 0.5f + 0.5f, 0.f, 1.f);
+        out[i] = uint8_t(unorm * 255.f + 0.5f);
+    }
+}
+
+void packNoise(std::span<const float> noise, std::span<uint16_t> out) {
+    for (size_t i = 0; i < noise.size(); i++) {
+        float unorm = std::clamp(noise[i] * 0.5f + 0.5f, 0.f, 1.f);
+        out[i] = uint16_t(unorm * 65535.f + 0.5f);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+// cpu gradient noise, baked into textures so static backgrounds dont have to
+// evaluate noise per fragment every frame
+
+enum class NoiseKind {
+    // the function in data/perlin.fs.glsl, bit for bit the same maths
+    eShader,
+
+    // classic gradient noise, tileable when a period is given
+    ePerlin,
+
+    // several octaves of ePerlin
+    eFbm
+};
+
+struct NoiseParams {
+    NoiseKind kind = NoiseKind::eShader;
+
+    unsigned width = 1024;
+    unsigned height = 1024;
+
+    // lattice cells across the texture, perlin.fs.glsl uses uv * 10
+    float frequency = 10.f;
+
+    // wrap the lattice so the texture tiles. the frequency is rounded to a
+    // whole number of cells, ignored for eShader which can never tile
+    bool tileable = false;
+
+    // fbm only
+    unsigned octaves = 5;
+    float lacunarity = 2.f;
+    float gain = 0.5f;
+
+    unsigned threads = 1;
+
+    // use the avx2 kernels when the cpu has them, off forces sse2
+    bool avx2 = true;
+};
+
+// scalar reference versions. coordinates are in lattice cells, period 0 means
+// no wrapping. results are roughly in [-1, 1]
+float shaderNoise(float x, float y);
+float perlinNoise(float x, float y, int period);
+float fbmNoise(float x, float y, int period, unsigned octaves, float lacunarity, float gain);
+
+// evaluate the reference for one texel of a bake, texel centres are sampled
+float referenceNoise(const NoiseParams& params, unsigned x, unsigned y);
+
+// fill `out` (width * height, row major) with noise. vectorised with sse2, or
+// avx2 when the cpu has it, and split across threads by tile
+void bakeNoise(std::span<float> out, const NoiseParams& params);
+
+// whether this build has the avx2 kernels and this cpu can run them
+bool noiseAvx2Supported();
+
+// map [-1, 1] onto the full range of a unorm texel
+void packNoise(std::span<const float> noise, std::span<uint8_t> out);
+void packNoise(std::span<const float> noise, std::span<uint16_t> out);
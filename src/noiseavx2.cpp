@@ -0,0 +1,48 @@
+#include "noisetile.h"
+
+#include <immintrin.h>
+
+// the avx2 bake. this file is built with -mavx2 and only called once
+// noiseAvx2Supported() has checked the cpu, see noisesimd.h
+
+namespace {
+    constexpr unsigned kWidth = 8;
+
+    struct F { __m256 v; };
+    struct I { __m256i v; };
+
+    F splat(float value) { return { _mm256_set1_ps(value) }; }
+    I splat(int value) { return { _mm256_set1_epi32(value) }; }
+    F load(const float *data) { return { _mm256_loadu_ps(data) }; }
+    void store(float *data, F value) { _mm256_storeu_ps(data, value.v); }
+
+    F operator+(F a, F b) { return { _mm256_add_ps(a.v, b.v) }; }
+    F operator-(F a, F b) { return { _mm256_sub_ps(a.v, b.v) }; }
+    F operator*(F a, F b) { return { _mm256_mul_ps(a.v, b.v) }; }
+    F operator/(F a, F b) { return { _mm256_div_ps(a.v, b.v) }; }
+    F operator-(F a) { return { _mm256_xor_ps(a.v, _mm256_set1_ps(-0.f)) }; }
+
+    I operator+(I a, I b) { return { _mm256_add_epi32(a.v, b.v) }; }
+    I operator&(I a, I b) { return { _mm256_and_si256(a.v, b.v) }; }
+    I operator|(I a, I b) { return { _mm256_or_si256(a.v, b.v) }; }
+    I operator^(I a, I b) { return { _mm256_xor_si256(a.v, b.v) }; }
+    I operator>>(I a, int n) { return { _mm256_srl_epi32(a.v, _mm_cvtsi32_si128(n)) }; }
+    I operator==(I a, I b) { return { _mm256_cmpeq_epi32(a.v, b.v) }; }
+    I operator<(I a, I b) { return { _mm256_cmpgt_epi32(b.v, a.v) }; }
+    I mullo(I a, I b) { return { _mm256_mullo_epi32(a.v, b.v) }; }
+
+    I equal(F a, F b) { return { _mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ)) }; }
+
+    F floor(F a) { return { _mm256_floor_ps(a.v) }; }
+    I truncate(F a) { return { _mm256_cvttps_epi32(a.v) }; }
+    I round(F a) { return { _mm256_cvtps_epi32(a.v) }; }
+    F toFloat(I a) { return { _mm256_cvtepi32_ps(a.v) }; }
+
+    F select(I mask, F a, F b) { return { _mm256_blendv_ps(b.v, a.v, _mm256_castsi256_ps(mask.v)) }; }
+}
+
+#include "noisesimd.h"
+
+void bakeTileAvx2(const NoiseTile& tile) {
+    bakeTile(tile);
+}
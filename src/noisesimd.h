@@ -0,0 +1,177 @@
+#pragma once
+
+#include "noisetile.h"
+
+#include <cmath>
+
+// the simd bake, written once against a set of lanes. include it after
+// defining kWidth, F and I (float and int lanes) and the operations on them,
+// noise.cpp does that with sse2 and noiseavx2.cpp with avx2.
+//
+// noiseavx2.cpp is built with -mavx2, so anything in here that isnt in the
+// anonymous namespace could be merged with the sse2 copy by the linker and
+// run on cpus without avx2. that is why this sticks to plain loops and c
+// maths functions instead of std templates
+
+namespace {
+    F interpolate(F a0, F a1, F w) {
+        return (a1 - a0) * w + a0;
+    }
+
+    // cephes style sincos, reduce to [-pi/4, pi/4] then pick the polynomial by quadrant
+    void sincos(F x, F& s, F& c) {
+        I quadrant = round(x * splat(0.636619772367581343f));
+        F j = toFloat(quadrant);
+
+        F r = ((x - j * splat(1.5703125f)) - j * splat(4.837512969970703125e-4f)) - j * splat(7.54978995489188216e-8f);
+        F r2 = r * r;
+
+        F sinR = r + r * r2 * (splat(-1.6666654611e-1f) + r2 * (splat(8.3321608736e-3f) + r2 * splat(-1.9515295891e-4f)));
+        F cosR = splat(1.f) - splat(0.5f) * r2 + r2 * r2 * (splat(4.166664568298827e-2f) + r2 * (splat(-1.388731625493765e-3f) + r2 * splat(2.443315711809948e-5f)));
+
+        I swap = (quadrant & splat(1)) == splat(1);
+        F sinQ = select(swap, cosR, sinR);
+        F cosQ = select(swap, sinR, cosR);
+
+        s = select((quadrant & splat(2)) == splat(2), -sinQ, sinQ);
+        c = select(((quadrant + splat(1)) & splat(2)) == splat(2), -cosQ, cosQ);
+    }
+
+    F dotGridGradient(I ix, I iy, F x, F y) {
+        I h = (ix + iy) & splat(15);
+
+        F u = select(h < splat(8), x, y);
+        F v = select(h < splat(4), y, select((h == splat(12)) | (h == splat(14)), x, splat(0.f)));
+        F angle = select((h & splat(1)) == splat(0), u, -u) + select((h & splat(2)) == splat(0), v, -v);
+
+        F s, c;
+        sincos(angle, s, c);
+
+        return (x - toFloat(ix)) * c + (y - toFloat(iy)) * s;
+    }
+
+    F shaderNoise(F x, F y) {
+        I x0 = truncate(floor(x));
+        I y0 = truncate(floor(y));
+        I x1 = x0 + splat(1);
+        I y1 = y0 + splat(1);
+
+        F sx = x - toFloat(x0);
+        F sy = y - toFloat(y0);
+
+        F ix0 = interpolate(dotGridGradient(x0, y0, x, y), dotGridGradient(x1, y0, x, y), sx);
+        F ix1 = interpolate(dotGridGradient(x0, y1, x, y), dotGridGradient(x1, y1, x, y), sx);
+
+        return interpolate(ix0, ix1, sy);
+    }
+
+    I latticeHash(I ix, I iy) {
+        I h = mullo(ix, splat(0x27d4eb2d)) ^ mullo(iy, splat(0x165667b1));
+        h = h ^ (h >> 15);
+        h = mullo(h, splat(0x2c1b3c6d));
+        return h ^ (h >> 12);
+    }
+
+    F gradient(I hash, F dx, F dy) {
+        return select((hash & splat(1)) == splat(0), dx, -dx) + select((hash & splat(2)) == splat(0), dy, -dy);
+    }
+
+    F fade(F t) {
+        return t * t * t * (t * (t * splat(6.f) - splat(15.f)) + splat(10.f));
+    }
+
+    // wrap whole lattice coordinates onto [0, period), done in float since
+    // they are small exact integers
+    void wrapLattice(F cell, int period, I& first, I& second) {
+        if (period <= 0) {
+            first = truncate(cell);
+            second = first + splat(1);
+            return;
+        }
+
+        F p = splat(float(period));
+        F wrapped = cell - p * floor(cell / p);
+        F next = wrapped + splat(1.f);
+
+        first = truncate(wrapped);
+        second = truncate(select(equal(next, p), splat(0.f), next));
+    }
+
+    F perlinNoise(F x, F y, int period) {
+        F fx = floor(x);
+        F fy = floor(y);
+
+        I x0, x1, y0, y1;
+        wrapLattice(fx, period, x0, x1);
+        wrapLattice(fy, period, y0, y1);
+
+        F dx = x - fx;
+        F dy = y - fy;
+        F dx1 = dx - splat(1.f);
+        F dy1 = dy - splat(1.f);
+
+        F n00 = gradient(latticeHash(x0, y0), dx, dy);
+        F n10 = gradient(latticeHash(x1, y0), dx1, dy);
+        F n01 = gradient(latticeHash(x0, y1), dx, dy1);
+        F n11 = gradient(latticeHash(x1, y1), dx1, dy1);
+
+        F u = fade(dx);
+        F v = fade(dy);
+
+        return interpolate(interpolate(n00, n10, u), interpolate(n01, n11, u), v);
+    }
+
+    F fbmNoise(F x, F y, int period, unsigned octaves, float lacunarity, float gain) {
+        F sum = splat(0.f);
+        float total = 0.f;
+        float amplitude = 1.f;
+        float scale = 1.f;
+
+        for (unsigned i = 0; i < octaves; i++) {
+            int octavePeriod = period > 0 ? int(std::lroundf(float(period) * scale)) : 0;
+            sum = sum + splat(amplitude) * perlinNoise(x * splat(scale), y * splat(scale), octavePeriod);
+            total += amplitude;
+
+            amplitude *= gain;
+            scale *= lacunarity;
+        }
+
+        return total > 0.f ? sum * splat(1.f / total) : splat(0.f);
+    }
+
+    void bakeTile(const NoiseTile& tile) {
+        F scaleX = splat(tile.scaleX);
+
+        alignas(32) float lanes[kWidth];
+        for (unsigned i = 0; i < kWidth; i++) {
+            lanes[i] = float(i) + 0.5f;
+        }
+        F offsets = load(lanes);
+
+        for (unsigned y = tile.y0; y < tile.y1; y++) {
+            F py = splat((float(y) + 0.5f) * tile.scaleY);
+            float *row = tile.out + size_t(y) * tile.width;
+
+            for (unsigned x = tile.x0; x < tile.x1; x += kWidth) {
+                F px = (splat(float(x)) + offsets) * scaleX;
+
+                F noise;
+                switch (tile.kind) {
+                case NoiseKind::eShader: noise = shaderNoise(px, py); break;
+                case NoiseKind::ePerlin: noise = perlinNoise(px, py, tile.period); break;
+                default: noise = fbmNoise(px, py, tile.period, tile.octaves, tile.lacunarity, tile.gain); break;
+                }
+
+                // the last few texels of a row go through a scratch buffer
+                if (x + kWidth <= tile.x1) {
+                    store(row + x, noise);
+                } else {
+                    store(lanes, noise);
+                    for (unsigned i = 0; i < tile.x1 - x; i++) {
+                        row[x + i] = lanes[i];
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "noise.h"
+
+// one tile of a bake with the parameters already worked out, shared by the
+// sse2 and avx2 kernels
+struct NoiseTile {
+    float *out;
+    unsigned width;
+
+    // texels [x0, x1) x [y0, y1)
+    unsigned x0 = 0;
+    unsigned y0 = 0;
+    unsigned x1 = 0;
+    unsigned y1 = 0;
+
+    NoiseKind kind;
+    float scaleX;
+    float scaleY;
+    int period;
+
+    unsigned octaves;
+    float lacunarity;
+    float gain;
+};
+
+// in noiseavx2.cpp, only call it when noiseAvx2Supported()
+void bakeTileAvx2(const NoiseTile& tile);
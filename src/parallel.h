@@ -0,0 +1,51 @@
+#pragma once
+
+#include "jobs.h"
+
+#include <algorithm>
+#include <vector>
+
+// split [0, count) into `threads` contiguous chunks and run fn(chunk, begin, end)
+// for each one on the shared job system. the split only depends on count and
+// threads so results are reproducible as long as fn only depends on its
+// arguments, chunks may run in any order and on any thread
+template<typename F>
+void parallelFor(size_t count, unsigned threads, F&& fn) {
+    threads = std::max(threads, 1u);
+
+    auto chunkRange = [&](unsigned chunk) {
+        size_t begin = count * chunk / threads;
+        size_t end = count * (chunk + 1) / threads;
+        return std::pair(begin, end);
+    };
+
+    struct Chunk {
+        F *fn;
+        unsigned index;
+        size_t begin;
+        size_t end;
+    };
+
+    JobSystem& jobs = jobSystem();
+    JobCounter counter;
+
+    std::vector<Chunk> chunks(threads);
+    std::vector<Job> queued(threads);
+    for (unsigned chunk = 1; chunk < threads; chunk++) {
+        auto [begin, end] = chunkRange(chunk);
+        chunks[chunk] = { &fn, chunk, begin, end };
+        queued[chunk] = {
+            [](void *data) {
+                auto *it = static_cast<Chunk*>(data);
+                (*it->fn)(it->index, it->begin, it->end);
+            },
+            &chunks[chunk]
+        };
+        jobs.spawn(queued[chunk], counter);
+    }
+
+    // the calling thread takes the first chunk, then helps with the rest
+    auto [begin, end] = chunkRange(0);
+    fn(0u, begin, end);
+    jobs.wait(counter);
+}
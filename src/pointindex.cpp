@@ -0,0 +1,160 @@
+#include "pointindex.h"
+
+#include "hash.h"
+#include "parallel.h"
+#include "profile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+    // points are bucketed into a 256x256 grid in morton order, a single
+    // counting sort pass. chunks only need to be compact, not exactly sorted
+    constexpr unsigned kCellBits = 8;
+    constexpr size_t kBuckets = size_t(1) << (kCellBits * 2);
+
+    // the fewest points drawn from a visible chunk
+    constexpr uint32_t kMinLod = 16;
+
+    constexpr uint32_t spreadBits(uint32_t x) {
+        x = (x | (x << 4)) & 0x0f0f;
+        x = (x | (x << 2)) & 0x3333;
+        x = (x | (x << 1)) & 0x5555;
+        return x;
+    }
+
+    constexpr uint32_t morton(uint32_t x, uint32_t y) {
+        return spreadBits(x) | (spreadBits(y) << 1);
+    }
+
+    Bounds2 pointBounds(std::span<const Vertex2> points, unsigned threads) {
+        std::vector<Bounds2> partial(std::max(threads, 1u), { INFINITY, INFINITY, -INFINITY, -INFINITY });
+        parallelFor(points.size(), threads, [&](unsigned chunk, size_t begin, size_t end) {
+            auto& bounds = partial[chunk];
+            for (size_t i = begin; i < end; i++) {
+                bounds.minX = std::min(bounds.minX, points[i].position.x);
+                bounds.minY = std::min(bounds.minY, points[i].position.y);
+                bounds.maxX = std::max(bounds.maxX, points[i].position.x);
+                bounds.maxY = std::max(bounds.maxY, points[i].position.y);
+            }
+        });
+
+        Bounds2 result = partial[0];
+        for (const auto& bounds : partial) {
+            result = {
+                std::min(result.minX, bounds.minX), std::min(result.minY, bounds.minY),
+                std::max(result.maxX, bounds.maxX), std::max(result.maxY, bounds.maxY)
+            };
+        }
+        return result;
+    }
+}
+
+std::vector<PointChunk> buildPointChunks(std::span<Vertex2> points, unsigned threads, size_t chunkSize) {
+    PROFILE_SCOPE("Build Point Chunks");
+
+    if (points.empty()) { return {}; }
+
+    threads = std::max(threads, 1u);
+    chunkSize = std::max<size_t>(chunkSize, 1);
+
+    Bounds2 bounds = pointBounds(points, threads);
+    float cells = float(1 << kCellBits);
+    float scaleX = cells / std::max(bounds.maxX - bounds.minX, 1e-12f);
+    float scaleY = cells / std::max(bounds.maxY - bounds.minY, 1e-12f);
+
+    auto bucketOf = [&](const Vertex2& point) {
+        auto cell = [&](float value, float min, float scale) {
+            return uint32_t(std::clamp((value - min) * scale, 0.f, cells - 1.f));
+        };
+        return morton(cell(point.position.x, bounds.minX, scaleX), cell(point.position.y, bounds.minY, scaleY));
+    };
+
+    // count per thread, then turn the counts into where each thread writes
+    // its points for every bucket. the split matches between both passes
+    // so the sort is stable
+    std::vector<std::vector<uint32_t>> offsets(threads, std::vector<uint32_t>(kBuckets));
+    parallelFor(points.size(), threads, [&](unsigned chunk, size_t begin, size_t end) {
+        auto& counts = offsets[chunk];
+        for (size_t i = begin; i < end; i++) {
+            counts[bucketOf(points[i])] += 1;
+        }
+    });
+
+    uint32_t running = 0;
+    for (size_t bucket = 0; bucket < kBuckets; bucket++) {
+        for (unsigned thread = 0; thread < threads; thread++) {
+            running += std::exchange(offsets[thread][bucket], running);
+        }
+    }
+
+    std::vector<Vertex2> sorted(points.size());
+    parallelFor(points.size(), threads, [&](unsigned chunk, size_t begin, size_t end) {
+        auto& next = offsets[chunk];
+        for (size_t i = begin; i < end; i++) {
+            sorted[next[bucketOf(points[i])]++] = points[i];
+        }
+    });
+
+    std::vector<PointChunk> chunks((points.size() + chunkSize - 1) / chunkSize);
+    parallelFor(chunks.size(), threads, [&](unsigned, size_t begin, size_t end) {
+        for (size_t index = begin; index < end; index++) {
+            size_t first = index * chunkSize;
+            size_t count = std::min(chunkSize, points.size() - first);
+            auto source = std::span(sorted).subspan(first, count);
+            auto dest = points.subspan(first, count);
+            std::copy(source.begin(), source.end(), dest.begin());
+
+            // fisher yates with a fixed stream so rebuilding gives the same order
+            auto stream = makeCounterStream(0, index);
+            for (size_t i = count - 1; i > 0; i--) {
+                size_t j = size_t((uint64_t(stream.at(uint32_t(i))) * (i + 1)) >> 32);
+                std::swap(dest[i], dest[j]);
+            }
+
+            Bounds2 chunkBounds = { INFINITY, INFINITY, -INFINITY, -INFINITY };
+            for (const auto& point : dest) {
+                chunkBounds.minX = std::min(chunkBounds.minX, point.position.x);
+                chunkBounds.minY = std::min(chunkBounds.minY, point.position.y);
+                chunkBounds.maxX = std::max(chunkBounds.maxX, point.position.x);
+                chunkBounds.maxY = std::max(chunkBounds.maxY, point.position.y);
+            }
+
+            chunks[index] = { chunkBounds, uint32_t(first), uint32_t(count) };
+        }
+    });
+
+    return chunks;
+}
+
+void selectPointChunks(std::span<const PointChunk> chunks, const LodParams& params, ChunkSelection& out) {
+    out.firsts.clear();
+    out.counts.clear();
+    out.chunks = 0;
+    out.points = 0;
+
+    for (const auto& chunk : chunks) {
+        if (!chunk.bounds.intersects(params.view)) { continue; }
+
+        uint32_t count = chunk.count;
+        if (params.pointsPerPixel > 0.f) {
+            // at least a pixel on each side so lines of points still show up
+            float width = std::max((chunk.bounds.maxX - chunk.bounds.minX) * params.pixelsX, 1.f);
+            float height = std::max((chunk.bounds.maxY - chunk.bounds.minY) * params.pixelsY, 1.f);
+            float wanted = std::ceil(width * height * params.pointsPerPixel);
+            count = uint32_t(std::min(float(chunk.count), std::max(wanted, float(kMinLod))));
+        }
+
+        out.chunks += 1;
+        out.points += count;
+
+        bool contiguous = !out.firsts.empty() && uint32_t(out.firsts.back() + out.counts.back()) == chunk.first;
+        if (contiguous) {
+            out.counts.back() += int(count);
+        } else {
+            out.firsts.push_back(int(chunk.first));
+            out.counts.push_back(int(count));
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "vertex.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// spatial index over a point cloud. points are reordered along a morton
+// curve and cut into fixed size chunks, each with a bounding box, so whole
+// chunks can be culled against the view. points inside a chunk are
+// shuffled so that any prefix is an even sample of the chunk, drawing a
+// shorter prefix when a chunk is small on screen is the level of detail
+
+struct PointChunk {
+    Bounds2 bounds;
+    uint32_t first;
+    uint32_t count;
+};
+
+constexpr size_t kDefaultChunkSize = 4096;
+
+// reorders `points` in place and returns the chunks covering them
+std::vector<PointChunk> buildPointChunks(std::span<Vertex2> points, unsigned threads, size_t chunkSize = kDefaultChunkSize);
+
+struct LodParams {
+    Bounds2 view;
+
+    // pixels per world unit on each axis
+    float pixelsX;
+    float pixelsY;
+
+    // points drawn per pixel of a chunk's bounds on screen, 0 draws every point
+    float pointsPerPixel;
+};
+
+// ranges ready for glMultiDrawArrays
+struct ChunkSelection {
+    std::vector<int> firsts;
+    std::vector<int> counts;
+    size_t chunks = 0;
+    size_t points = 0;
+};
+
+// pick the chunks that intersect the view and how much of each to draw,
+// neighbouring chunks drawn in full are merged into one range
+void selectPointChunks(std::span<const PointChunk> chunks, const LodParams& params, ChunkSelection& out);
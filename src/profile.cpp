@@ -0,0 +1,276 @@
+#include "profile.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace {
+    constexpr size_t kRingSize = 1 << 14;
+    constexpr size_t kDefaultHistory = 240;
+
+    // single producer ring, only the owning thread writes and only
+    // profileEndFrame reads. a thread that laps the reader loses its oldest zones
+    struct ThreadRing {
+        std::array<ProfileZone, kRingSize> zones;
+        std::atomic<uint64_t> write = 0;
+        uint64_t read = 0;
+
+        uint32_t id;
+        uint32_t depth = 0;
+        std::atomic<bool> owned = false;
+        std::string name;
+    };
+
+    std::atomic<bool> gEnabled = true;
+
+    std::mutex gRingLock;
+    std::vector<std::unique_ptr<ThreadRing>> gRings;
+
+    uint64_t gFrameIndex = 0;
+    uint64_t gFrameBegin = 0;
+    std::deque<ProfileFrame> gHistory;
+    size_t gHistoryLength = kDefaultHistory;
+
+    // gpu zones waiting to be attached to the history by the main thread
+    struct PendingZones {
+        uint64_t frame;
+        std::vector<ProfileZone> zones;
+    };
+
+    std::mutex gPendingLock;
+    std::vector<PendingZones> gPending;
+
+    // rings outlive their threads and get handed to the next thread that
+    // needs one, benchmarks make and drop whole job systems
+    ThreadRing *acquireRing() {
+        std::lock_guard guard(gRingLock);
+        for (auto& ring : gRings) {
+            bool owned = false;
+            if (ring->owned.compare_exchange_strong(owned, true)) {
+                ring->name.clear();
+                return ring.get();
+            }
+        }
+
+        auto& ring = gRings.emplace_back(std::make_unique<ThreadRing>());
+        ring->id = uint32_t(gRings.size() - 1);
+        ring->owned = true;
+        return ring.get();
+    }
+
+    struct RingHandle {
+        ThreadRing *ring = acquireRing();
+        ~RingHandle() { ring->owned = false; }
+    };
+
+    ThreadRing& threadRing() {
+        thread_local RingHandle handle;
+        return *handle.ring;
+    }
+
+    // zones for frames that havent ended yet wait for the next call
+    void attachPendingZones() {
+        std::lock_guard guard(gPendingLock);
+        if (gPending.empty()) { return; }
+
+        std::vector<PendingZones> later;
+        for (auto& pending : gPending) {
+            if (pending.frame >= gFrameIndex) {
+                later.push_back(std::move(pending));
+                continue;
+            }
+
+            for (auto& it : gHistory) {
+                if (it.index == pending.frame) {
+                    it.gpu.insert(it.gpu.end(), pending.zones.begin(), pending.zones.end());
+                    break;
+                }
+            }
+        }
+        gPending = std::move(later);
+    }
+
+    std::string escapeJson(const char *text) {
+        std::string out;
+        for (const char *it = text; *it; it++) {
+            if (*it == '"' || *it == '\\') { out += '\\'; }
+            out += *it;
+        }
+        return out;
+    }
+}
+
+uint64_t profileNow() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+bool profileEnabled() {
+    return gEnabled.load(std::memory_order_relaxed);
+}
+
+void profileSetEnabled(bool enabled) {
+    gEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void profileNameThread(const char *name) {
+    auto& ring = threadRing();
+    std::lock_guard guard(gRingLock);
+    ring.name = name;
+}
+
+const char *profileThreadName(uint32_t thread) {
+    std::lock_guard guard(gRingLock);
+    if (thread >= gRings.size() || gRings[thread]->name.empty()) {
+        return nullptr;
+    }
+
+    return gRings[thread]->name.c_str();
+}
+
+ProfileScope::ProfileScope(const char *name)
+    : name(profileEnabled() ? name : nullptr)
+    , begin(0)
+{
+    if (this->name == nullptr) { return; }
+
+    threadRing().depth++;
+    begin = profileNow();
+}
+
+ProfileScope::~ProfileScope() {
+    if (name == nullptr) { return; }
+
+    uint64_t end = profileNow();
+    auto& ring = threadRing();
+    ring.depth--;
+
+    uint64_t index = ring.write.load(std::memory_order_relaxed);
+    ring.zones[index % kRingSize] = { name, begin, end, ring.id, ring.depth };
+    ring.write.store(index + 1, std::memory_order_release);
+}
+
+void profileEndFrame() {
+    uint64_t now = profileNow();
+
+    ProfileFrame frame = { gFrameIndex, gFrameBegin, now, {}, {} };
+
+    {
+        std::lock_guard guard(gRingLock);
+        for (auto& ring : gRings) {
+            uint64_t write = ring->write.load(std::memory_order_acquire);
+            if (write - ring->read > kRingSize) {
+                ring->read = write - kRingSize;
+            }
+
+            for (; ring->read < write; ring->read++) {
+                frame.cpu.push_back(ring->zones[ring->read % kRingSize]);
+            }
+        }
+    }
+
+    // keep draining while disabled so stale zones dont show up once the
+    // profiler is turned back on
+    if (profileEnabled()) {
+        gHistory.push_back(std::move(frame));
+        while (gHistory.size() > gHistoryLength) {
+            gHistory.pop_front();
+        }
+    }
+
+    gFrameIndex += 1;
+    gFrameBegin = now;
+    attachPendingZones();
+}
+
+uint64_t profileFrameIndex() {
+    return gFrameIndex;
+}
+
+const std::deque<ProfileFrame>& profileHistory() {
+    attachPendingZones();
+    return gHistory;
+}
+
+void profileSetHistoryLength(size_t frames) {
+    gHistoryLength = std::max<size_t>(frames, 1);
+    while (gHistory.size() > gHistoryLength) {
+        gHistory.pop_front();
+    }
+}
+
+void profileSubmitGpuZones(uint64_t frame, const std::vector<ProfileZone>& zones) {
+    if (zones.empty()) { return; }
+
+    std::lock_guard guard(gPendingLock);
+    gPending.push_back({ frame, zones });
+}
+
+bool profileExportCsv(const char *path) {
+    std::ofstream out(path);
+    if (!out.is_open()) { return false; }
+
+    out << std::fixed << std::setprecision(3);
+    out << "frame,source,thread,depth,name,begin_us,duration_us\n";
+
+    auto write = [&](const ProfileFrame& frame, const char *source, const ProfileZone& zone) {
+        out << frame.index << ',' << source << ',' << zone.thread << ',' << zone.depth << ','
+            << '"' << zone.name << "\"," << double(zone.begin) / 1000.0 << ','
+            << double(zone.end - zone.begin) / 1000.0 << '\n';
+    };
+
+    for (const auto& frame : gHistory) {
+        for (const auto& zone : frame.cpu) { write(frame, "cpu", zone); }
+        for (const auto& zone : frame.gpu) { write(frame, "gpu", zone); }
+    }
+
+    return out.good();
+}
+
+bool profileExportChromeTrace(const char *path) {
+    std::ofstream out(path);
+    if (!out.is_open()) { return false; }
+
+    // loads in chrome://tracing and perfetto, gpu zones get their own process
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[\n";
+
+    bool first = true;
+    auto write = [&](int pid, const ProfileZone& zone) {
+        if (!first) { out << ",\n"; }
+        first = false;
+
+        out << "{\"name\":\"" << escapeJson(zone.name) << "\",\"ph\":\"X\""
+            << ",\"pid\":" << pid << ",\"tid\":" << zone.thread
+            << ",\"ts\":" << double(zone.begin) / 1000.0
+            << ",\"dur\":" << double(zone.end - zone.begin) / 1000.0 << '}';
+    };
+
+    uint32_t threads = 0;
+    for (const auto& frame : gHistory) {
+        for (const auto& zone : frame.cpu) {
+            write(0, zone);
+            threads = std::max(threads, zone.thread + 1);
+        }
+        for (const auto& zone : frame.gpu) { write(1, zone); }
+    }
+
+    for (uint32_t thread = 0; thread < threads; thread++) {
+        const char *name = profileThreadName(thread);
+        if (name == nullptr) { continue; }
+
+        if (!first) { out << ",\n"; }
+        first = false;
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread
+            << ",\"args\":{\"name\":\"" << escapeJson(name) << "\"}}";
+    }
+
+    out << "\n]}\n";
+    return out.good();
+}
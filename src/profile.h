@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// frame profiler
+//
+// cpu zones are recorded into a ring buffer per thread and gathered once per
+// frame by profileEndFrame. gpu zones use timestamp queries that are read
+// back a few frames late so they never stall the pipeline. with HELLO_PROFILE
+// set to 0 the macros compile to nothing, otherwise a disabled profiler costs
+// one relaxed atomic load per zone
+
+#ifndef HELLO_PROFILE
+#   define HELLO_PROFILE 1
+#endif
+
+struct ProfileZone {
+    // must outlive the profiler, string literals in practice
+    const char *name;
+
+    // nanoseconds on the profileNow clock
+    uint64_t begin;
+    uint64_t end;
+
+    uint32_t thread;
+    uint32_t depth;
+};
+
+struct ProfileFrame {
+    uint64_t index;
+    uint64_t begin;
+    uint64_t end;
+
+    std::vector<ProfileZone> cpu;
+
+    // filled in a few frames after the frame itself ended
+    std::vector<ProfileZone> gpu;
+};
+
+uint64_t profileNow();
+
+bool profileEnabled();
+void profileSetEnabled(bool enabled);
+
+// name shown for the calling thread in the timeline and in exports
+void profileNameThread(const char *name);
+const char *profileThreadName(uint32_t thread);
+
+// close the current frame, gathering every zone threads finished since the last call
+void profileEndFrame();
+
+uint64_t profileFrameIndex();
+
+// the most recent frames, oldest first
+const std::deque<ProfileFrame>& profileHistory();
+
+// how many frames the history keeps, 240 by default
+void profileSetHistoryLength(size_t frames);
+
+// attach gpu zones to a frame still in the history. safe from any thread,
+// the zones show up once the main thread ends a frame or reads the history
+void profileSubmitGpuZones(uint64_t frame, const std::vector<ProfileZone>& zones);
+
+// write every frame in the history, returns false if the file couldnt be written
+bool profileExportCsv(const char *path);
+bool profileExportChromeTrace(const char *path);
+
+// gpu zones, these need a current context
+
+void profileGpuInit();
+void profileGpuShutdown();
+
+// resolve the queries of frames the gpu has finished. `frame` is the
+// profileFrameIndex the gpu work was recorded in, which is behind the
+// current one when a render thread submits it
+void profileGpuEndFrame(uint64_t frame);
+
+// wait for the gpu and resolve every outstanding query
+void profileGpuFlush();
+
+uint32_t profileGpuBegin(const char *name);
+void profileGpuEnd(uint32_t zone);
+
+// the profiler window, drawn with imgui
+void profileDrawWindow(bool *open);
+
+struct ProfileScope {
+    ProfileScope(const char *name);
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char *name;
+    uint64_t begin;
+};
+
+struct GpuProfileScope {
+    GpuProfileScope(const char *name) : zone(profileGpuBegin(name)) { }
+    ~GpuProfileScope() { profileGpuEnd(zone); }
+
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+    uint32_t zone;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if HELLO_PROFILE
+#   define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#   define PROFILE_GPU_SCOPE(name) GpuProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+#else
+#   define PROFILE_SCOPE(name) (void)0
+#   define PROFILE_GPU_SCOPE(name) (void)0
+#endif
@@ -0,0 +1,209 @@
+#include "profile.h"
+
+#include "hash.h"
+
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <map>
+#include <string>
+
+namespace {
+    constexpr float kRowHeight = 18.f;
+    constexpr float kLabelWidth = 90.f;
+
+    bool gPaused = false;
+    std::deque<ProfileFrame> gFrozen;
+
+    // frames back from the newest, gpu zones only arrive a few frames late
+    int gSelected = 4;
+    std::string gStatus;
+
+    ImU32 zoneColour(const char *name) {
+        uint32_t hash = uint32_t(fnv1a(name));
+        return ImColor::HSV(float(hash % 360) / 360.f, 0.55f, 0.75f);
+    }
+
+    double toMs(uint64_t ns) {
+        return double(ns) / 1'000'000.0;
+    }
+
+    // one row per thread, zones stacked by depth
+    void drawRow(const char *label, const std::vector<ProfileZone>& zones, uint32_t thread, bool gpu, uint64_t begin, uint64_t end) {
+        uint32_t depth = 0;
+        for (const auto& zone : zones) {
+            if (gpu || zone.thread == thread) {
+                depth = std::max(depth, zone.depth + 1);
+            }
+        }
+        if (depth == 0) { return; }
+
+        ImDrawList *draw = ImGui::GetWindowDrawList();
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        float width = std::max(ImGui::GetContentRegionAvail().x - kLabelWidth, 1.f);
+        float height = kRowHeight * float(depth);
+        double scale = double(width) / double(std::max<uint64_t>(end - begin, 1));
+
+        draw->AddText(origin, ImGui::GetColorU32(ImGuiCol_Text), label);
+
+        float left = origin.x + kLabelWidth;
+        float right = left + width;
+        ImVec2 mouse = ImGui::GetIO().MousePos;
+
+        for (const auto& zone : zones) {
+            if (!gpu && zone.thread != thread) { continue; }
+            if (zone.end < begin || zone.begin > end) { continue; }
+
+            float x0 = std::max(left + float(double(int64_t(zone.begin - begin)) * scale), left);
+            float x1 = std::min(left + float(double(int64_t(zone.end - begin)) * scale), right);
+            float y0 = origin.y + kRowHeight * float(zone.depth);
+            float y1 = y0 + kRowHeight - 1.f;
+            x1 = std::max(x1, x0 + 1.f);
+
+            draw->AddRectFilled({ x0, y0 }, { x1, y1 }, zoneColour(zone.name));
+            if (x1 - x0 > 24.f) {
+                ImVec4 clip = { x0 + 2.f, y0, x1 - 2.f, y1 };
+                draw->AddText(nullptr, 0.f, { x0 + 3.f, y0 + 2.f }, IM_COL32(255, 255, 255, 255), zone.name, nullptr, 0.f, &clip);
+            }
+
+            if (ImGui::IsWindowHovered() && mouse.x >= x0 && mouse.x < x1 && mouse.y >= y0 && mouse.y < y1) {
+                ImGui::SetTooltip("%s\n%.3f ms", zone.name, toMs(zone.end - zone.begin));
+            }
+        }
+
+        ImGui::Dummy({ width + kLabelWidth, height + 4.f });
+    }
+
+    void drawTimeline(const ProfileFrame& frame) {
+        uint32_t threads = 0;
+        for (const auto& zone : frame.cpu) {
+            threads = std::max(threads, zone.thread + 1);
+        }
+
+        for (uint32_t thread = 0; thread < threads; thread++) {
+            const char *name = profileThreadName(thread);
+            std::string label = name ? name : "Thread " + std::to_string(thread);
+            drawRow(label.c_str(), frame.cpu, thread, false, frame.begin, frame.end);
+        }
+
+        drawRow("GPU", frame.gpu, 0, true, frame.begin, frame.end);
+    }
+
+    void drawTotals(const ProfileFrame& frame) {
+        struct Total {
+            uint32_t count = 0;
+            uint64_t time = 0;
+        };
+
+        std::map<std::pair<std::string, bool>, Total> totals;
+        for (const auto& zone : frame.cpu) {
+            auto& total = totals[{ zone.name, false }];
+            total.count += 1;
+            total.time += zone.end - zone.begin;
+        }
+        for (const auto& zone : frame.gpu) {
+            auto& total = totals[{ zone.name, true }];
+            total.count += 1;
+            total.time += zone.end - zone.begin;
+        }
+
+        std::vector<std::pair<std::pair<std::string, bool>, Total>> sorted(totals.begin(), totals.end());
+        std::sort(sorted.begin(), sorted.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.second.time > rhs.second.time;
+        });
+
+        if (!ImGui::BeginTable("Totals", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders)) {
+            return;
+        }
+
+        ImGui::TableSetupColumn("Zone");
+        ImGui::TableSetupColumn("Source");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("Total (ms)");
+        ImGui::TableHeadersRow();
+
+        for (const auto& [key, total] : sorted) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(key.first.c_str());
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(key.second ? "gpu" : "cpu");
+            ImGui::TableNextColumn(); ImGui::Text("%u", total.count);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", toMs(total.time));
+        }
+
+        ImGui::EndTable();
+    }
+}
+
+void profileDrawWindow(bool *open) {
+    if (!ImGui::Begin("Profiler", open)) {
+        ImGui::End();
+        return;
+    }
+
+#if !HELLO_PROFILE
+    ImGui::TextUnformatted("Built without zones, reconfigure with -Dprofiler=true");
+#endif
+
+    bool enabled = profileEnabled();
+    if (ImGui::Checkbox("Enabled", &enabled)) {
+        profileSetEnabled(enabled);
+    }
+    ImGui::SameLine();
+    if (ImGui::Checkbox("Pause", &gPaused) && gPaused) {
+        gFrozen = profileHistory();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button(ImGuiLiteralID("Export CSV"))) {
+        gStatus = profileExportCsv("profile.csv") ? "Wrote profile.csv" : "Failed to write profile.csv";
+    }
+    ImGui::SameLine();
+    if (ImGui::Button(ImGuiLiteralID("Export Trace"))) {
+        gStatus = profileExportChromeTrace("profile.json") ? "Wrote profile.json" : "Failed to write profile.json";
+    }
+    if (!gStatus.empty()) {
+        ImGui::TextUnformatted(gStatus.c_str());
+    }
+
+    const auto& history = gPaused ? gFrozen : profileHistory();
+    if (history.empty()) {
+        ImGui::TextUnformatted("No frames recorded");
+        ImGui::End();
+        return;
+    }
+
+    std::vector<float> times;
+    times.reserve(history.size());
+    double sum = 0.0;
+    for (const auto& frame : history) {
+        times.push_back(float(toMs(frame.end - frame.begin)));
+        sum += times.back();
+    }
+
+    char overlay[64];
+    snprintf(overlay, sizeof(overlay), "avg %.2f ms", sum / double(times.size()));
+    ImGui::PlotHistogram("##Frames", times.data(), int(times.size()), 0, overlay, 0.f, FLT_MAX, { -1.f, 60.f });
+
+    // click a bar to look at that frame
+    if (ImGui::IsItemHovered() && ImGui::IsMouseDown(ImGuiMouseButton_Left)) {
+        float t = (ImGui::GetIO().MousePos.x - ImGui::GetItemRectMin().x) / ImGui::GetItemRectSize().x;
+        int index = int(t * float(times.size()));
+        gSelected = int(times.size()) - 1 - std::clamp(index, 0, int(times.size()) - 1);
+    }
+
+    gSelected = std::clamp(gSelected, 0, int(history.size()) - 1);
+    ImGui::SliderInt("Frames Back", &gSelected, 0, int(history.size()) - 1);
+
+    const auto& frame = history[history.size() - 1 - size_t(gSelected)];
+    ImGui::Text("Frame %llu: %.3f ms", (unsigned long long)frame.index, toMs(frame.end - frame.begin));
+
+    if (ImGui::BeginChild("Timeline", { 0.f, 0.f }, false, ImGuiWindowFlags_HorizontalScrollbar)) {
+        drawTimeline(frame);
+        ImGui::Separator();
+        drawTotals(frame);
+    }
+    ImGui::EndChild();
+
+    ImGui::End();
+}
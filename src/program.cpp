@@ -1,9 +1,17 @@
 #include "program.h"
 
+#include "hash.h"
+
 #include "glad/glad.h"
 
-#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
 #include <fstream>
+#include <iostream>
+#include <vector>
 
 std::string loadFile(const char *path) {
     std::ifstream fd(path);
@@ -41,33 +49,311 @@ namespace {
             [](auto shader, auto len, auto* info) { return glGetShaderInfoLog(shader, len, nullptr, info); }
         );
     }
+
+    unsigned compileShader(unsigned type, const char *source, const char *name) {
+        auto shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+
+        checkShader(shader, name);
+
+        return shader;
+    }
+
+    void checkProgram(unsigned program) {
+        checkError(program, "shader program",
+            [](auto shader, auto* ok) { return glGetProgramiv(shader, GL_LINK_STATUS, ok); },
+            [](auto shader, auto len, auto* info) { return glGetProgramInfoLog(shader, len, nullptr, info); }
+        );
+    }
+
+    // program binary cache
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t kCacheMagic = 0x50524f47; // PROG
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t format;
+        uint32_t length;
+    };
+
+    struct ProgramCache {
+        bool enabled = false;
+        std::filesystem::path directory;
+        ProgramCacheStats stats;
+    };
+
+    ProgramCache gProgramCache;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // hash every part with a separator so ("ab", "c") and ("a", "bc") differ
+    uint64_t hashParts(std::span<const char *const> parts) {
+        uint64_t hash = kFnvBasis;
+        for (const char *part : parts) {
+            hash = fnv1a(part ? part : "", hash);
+            hash = fnv1a(std::string_view("", 1), hash);
+        }
+
+        return hash;
+    }
+
+    uint64_t programKey(const char *vs, const char *fs, std::span<const char *const> varyings) {
+        auto driver = [](GLenum name) { return (const char*)glGetString(name); };
+
+        std::vector<const char*> parts = { vs, fs, driver(GL_VENDOR), driver(GL_RENDERER), driver(GL_VERSION) };
+        parts.insert(parts.end(), varyings.begin(), varyings.end());
+
+        return hashParts(parts);
+    }
+
+    std::filesystem::path cachePath(uint64_t key) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return gProgramCache.directory / name;
+    }
+
+    // returns 0 on a miss or if the driver rejected the binary
+    unsigned loadCachedProgram(uint64_t key) {
+        if (!gProgramCache.enabled) { return 0; }
+
+        auto start = Clock::now();
+
+        std::ifstream fd(cachePath(key), std::ios::binary);
+        if (!fd.is_open()) {
+            gProgramCache.stats.misses += 1;
+            return 0;
+        }
+
+        CacheHeader header;
+        std::vector<char> binary;
+        if (fd.read((char*)&header, sizeof(header)) && header.magic == kCacheMagic) {
+            binary.resize(header.length);
+            fd.read(binary.data(), binary.size());
+        }
+
+        if (binary.empty() || !fd) {
+            gProgramCache.stats.misses += 1;
+            gProgramCache.stats.rejected += 1;
+            return 0;
+        }
+
+        auto program = glCreateProgram();
+        glProgramBinary(program, header.format, binary.data(), GLsizei(binary.size()));
+
+        int ok = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            // usually a driver update the version string didnt catch
+            glDeleteProgram(program);
+            gProgramCache.stats.misses += 1;
+            gProgramCache.stats.rejected += 1;
+            return 0;
+        }
+
+        gProgramCache.stats.hits += 1;
+        gProgramCache.stats.loadSeconds += secondsSince(start);
+        return program;
+    }
+
+    void storeProgram(uint64_t key, unsigned program) {
+        if (!gProgramCache.enabled) { return; }
+
+        int length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) { return; }
+
+        CacheHeader header = { kCacheMagic, 0, uint32_t(length) };
+        std::vector<char> binary(size_t(length), 0);
+
+        GLenum format = 0;
+        glGetProgramBinary(program, length, nullptr, &format, binary.data());
+        header.format = format;
+
+        std::ofstream fd(cachePath(key), std::ios::binary | std::ios::trunc);
+        if (!fd.is_open()) {
+            std::cout << "Failed to write program cache entry: " << cachePath(key).string() << std::endl;
+            return;
+        }
+
+        fd.write((const char*)&header, sizeof(header));
+        fd.write(binary.data(), binary.size());
+    }
+
+    // the hint has to be set before linking for the binary to be retrievable
+    void markRetrievable(unsigned program) {
+        if (gProgramCache.enabled) {
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+    }
 }
 
-unsigned createShader(const char *vs, const char *fs) {
-    auto vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vs, NULL);
-    glCompileShader(vertexShader);
+void enableProgramCache(const char *directory) {
+    int formats = 0;
+    if (glGetProgramBinary != nullptr && glProgramBinary != nullptr && glProgramParameteri != nullptr) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    }
+
+    if (formats <= 0) {
+        std::cout << "Program binaries are not supported, shaders will always be compiled" << std::endl;
+        return;
+    }
 
-    checkShader(vertexShader, "vertex shader");
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cout << "Failed to create program cache " << directory << ": " << error.message() << std::endl;
+        return;
+    }
 
-    auto fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fs, NULL);
-    glCompileShader(fragmentShader);
+    gProgramCache.enabled = true;
+    gProgramCache.directory = directory;
+}
 
-    checkShader(fragmentShader, "fragment shader");
+ProgramCacheStats getProgramCacheStats() {
+    return gProgramCache.stats;
+}
+
+unsigned createShader(const char *vs, const char *fs) {
+    auto key = programKey(vs, fs, {});
+    if (auto program = loadCachedProgram(key)) {
+        return program;
+    }
+
+    auto start = Clock::now();
+
+    auto vertexShader = compileShader(GL_VERTEX_SHADER, vs, "vertex shader");
+    auto fragmentShader = compileShader(GL_FRAGMENT_SHADER, fs, "fragment shader");
 
     auto shaderProgram = glCreateProgram();
     glAttachShader(shaderProgram, vertexShader);
     glAttachShader(shaderProgram, fragmentShader);
+    markRetrievable(shaderProgram);
     glLinkProgram(shaderProgram);
 
-    checkError(shaderProgram, "shader program",
-        [](auto shader, auto* ok) { return glGetProgramiv(shader, GL_LINK_STATUS, ok); },
-        [](auto shader, auto len, auto* info) { return glGetProgramInfoLog(shader, len, nullptr, info); }
-    );
+    checkProgram(shaderProgram);
 
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
 
+    gProgramCache.stats.compileSeconds += secondsSince(start);
+    storeProgram(key, shaderProgram);
+
+    return shaderProgram;
+}
+
+unsigned createFeedbackShader(const char *vs, std::span<const char *const> varyings) {
+    auto key = programKey(vs, nullptr, varyings);
+    if (auto program = loadCachedProgram(key)) {
+        return program;
+    }
+
+    auto start = Clock::now();
+
+    auto vertexShader = compileShader(GL_VERTEX_SHADER, vs, "vertex shader");
+
+    auto shaderProgram = glCreateProgram();
+    glAttachShader(shaderProgram, vertexShader);
+
+    // has to happen before linking
+    glTransformFeedbackVaryings(shaderProgram, GLsizei(varyings.size()), varyings.data(), GL_INTERLEAVED_ATTRIBS);
+    markRetrievable(shaderProgram);
+    glLinkProgram(shaderProgram);
+
+    checkProgram(shaderProgram);
+
+    glDeleteShader(vertexShader);
+
+    gProgramCache.stats.compileSeconds += secondsSince(start);
+    storeProgram(key, shaderProgram);
+
     return shaderProgram;
 }
+
+// shader variants
+
+namespace {
+    constexpr std::string_view kVariantPragma = "#pragma variant ";
+
+    void findVariantKeys(std::string_view source, std::vector<std::string>& keys) {
+        size_t pos = 0;
+        while ((pos = source.find(kVariantPragma, pos)) != std::string_view::npos) {
+            pos += kVariantPragma.size();
+
+            size_t end = source.find_first_of(" \t\r\n", pos);
+            auto name = std::string(source.substr(pos, end - pos));
+            if (std::find(keys.begin(), keys.end(), name) == keys.end()) {
+                keys.push_back(std::move(name));
+            }
+        }
+    }
+
+    // the #version line has to stay first so the defines go right after it
+    std::string specialise(std::string_view source, std::string_view preamble) {
+        size_t split = 0;
+        if (size_t version = source.find("#version"); version != std::string_view::npos) {
+            size_t lineEnd = source.find('\n', version);
+            split = lineEnd == std::string_view::npos ? source.size() : lineEnd + 1;
+        }
+
+        std::string result;
+        result.reserve(source.size() + preamble.size());
+        result.append(source.substr(0, split));
+        result.append(preamble);
+        result.append(source.substr(split));
+        return result;
+    }
+}
+
+ShaderVariants::ShaderVariants(std::string_view vs, std::string_view fs)
+    : vs(vs)
+    , fs(fs)
+{
+    findVariantKeys(vs, keys);
+    findVariantKeys(fs, keys);
+
+    if (keys.size() > 32) {
+        std::cout << "Too many shader variant keys: " << keys.size() << std::endl;
+        std::abort();
+    }
+}
+
+ShaderVariants::~ShaderVariants() {
+    for (auto [mask, program] : programs) {
+        glDeleteProgram(program);
+    }
+}
+
+uint32_t ShaderVariants::key(std::string_view name) const {
+    auto it = std::find(keys.begin(), keys.end(), name);
+    if (it == keys.end()) {
+        std::cout << "Unknown shader variant key: " << name << std::endl;
+        std::abort();
+    }
+
+    return uint32_t(1) << (it - keys.begin());
+}
+
+unsigned ShaderVariants::get(uint32_t mask) {
+    if (auto it = programs.find(mask); it != programs.end()) {
+        return it->second;
+    }
+
+    std::string preamble;
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (mask & (uint32_t(1) << i)) {
+            preamble += "#define " + keys[i] + " 1\n";
+        }
+    }
+
+    auto vertex = specialise(vs, preamble);
+    auto fragment = specialise(fs, preamble);
+
+    unsigned program = createShader(vertex.c_str(), fragment.c_str());
+    programs.emplace(mask, program);
+    return program;
+}
@@ -1,7 +1,66 @@
 #pragma once
 
+#include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 std::string loadFile(const char *path);
 
 unsigned createShader(const char *vs, const char *fs);
+
+// a vertex only program whose outputs are captured with transform feedback,
+// `varyings` are written interleaved in the order given
+unsigned createFeedbackShader(const char *vs, std::span<const char *const> varyings);
+
+// program binary cache
+
+struct ProgramCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+
+    // binaries the driver refused to load, counted as misses as well
+    size_t rejected = 0;
+
+    double loadSeconds = 0.0;
+    double compileSeconds = 0.0;
+};
+
+// persist linked programs in `directory` and load them on later runs rather
+// than compiling from source. entries are keyed on the shader sources and the
+// driver so updating either invalidates them. needs a current context, and
+// does nothing if the driver has no program binary formats
+void enableProgramCache(const char *directory);
+
+ProgramCacheStats getProgramCacheStats();
+
+// shader permutations
+//
+// shaders declare the keys they can be specialised on with
+//   #pragma variant NAME
+// and test them with #if defined(NAME). each requested combination of keys
+// is compiled once with the matching #defines injected after the #version
+// line and cached by its key mask
+struct ShaderVariants {
+    ShaderVariants(std::string_view vs, std::string_view fs);
+    ~ShaderVariants();
+
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    // the mask bit for a key declared by either shader
+    uint32_t key(std::string_view name) const;
+
+    // the program for a combination of keys, compiled on first use
+    unsigned get(uint32_t mask);
+
+    size_t compiled() const { return programs.size(); }
+
+private:
+    std::string vs;
+    std::string fs;
+    std::vector<std::string> keys;
+    std::unordered_map<uint32_t, unsigned> programs;
+};
@@ -0,0 +1,88 @@
+#include "quads.h"
+
+#include "mesh.h"
+
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr auto kCorners = std::to_array<Point2>({
+        { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 }
+    });
+
+    constexpr auto kCornerIndices = std::to_array<unsigned>({ 0, 1, 2, 2, 3, 0 });
+
+    constexpr auto kCornerAttribs = std::to_array<VertexAttrib>({
+        { 0, 2, AttribType::eFloat, 0 }
+    });
+}
+
+QuadBatch::QuadBatch(size_t initialCapacity)
+    : instances(std::max<size_t>(initialCapacity, 1) * sizeof(QuadInstance))
+{
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    glGenBuffers(1, &corners);
+    glBindBuffer(GL_ARRAY_BUFFER, corners);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(kCorners), kCorners.data(), GL_STATIC_DRAW);
+    setupAttribs({ sizeof(Point2), kCornerAttribs });
+
+    glGenBuffers(1, &ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(kCornerIndices), kCornerIndices.data(), GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+}
+
+QuadBatch::~QuadBatch() {
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &corners);
+    glDeleteBuffers(1, &ebo);
+}
+
+std::span<QuadInstance> QuadBatch::map(size_t count) {
+    numInstances = 0;
+    numMapped = 0;
+
+    auto bytes = instances.map(count * sizeof(QuadInstance));
+    if (bytes.empty()) { return {}; }
+
+    numMapped = count;
+    return { reinterpret_cast<QuadInstance*>(bytes.data()), count };
+}
+
+void QuadBatch::unmap() {
+    // the contents can be lost on some platforms, nothing gets drawn that frame
+    if (!instances.unmap()) { return; }
+
+    numInstances = numMapped;
+
+    // instanced attributes cant be offset by a first vertex, so they are
+    // pointed at whichever region was just written
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, instances.buffer());
+    setupAttribs(kVertexLayout<QuadInstance>, instances.offset());
+    glBindVertexArray(0);
+}
+
+void QuadBatch::upload(std::span<const QuadInstance> data) {
+    auto mapped = map(data.size());
+    if (mapped.empty()) { return; }
+
+    std::memcpy(mapped.data(), data.data(), data.size_bytes());
+    unmap();
+}
+
+void QuadBatch::bind() {
+    glBindVertexArray(vao);
+}
+
+void QuadBatch::draw() {
+    if (numInstances == 0) { return; }
+
+    glDrawElementsInstanced(GL_TRIANGLES, GLsizei(kCornerIndices.size()), GL_UNSIGNED_INT, nullptr, GLsizei(numInstances));
+    instances.fence();
+}
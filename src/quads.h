@@ -0,0 +1,41 @@
+#pragma once
+
+#include "stream.h"
+#include "vertex.h"
+
+#include <span>
+
+// unit quads drawn with a single instanced call. each instance carries its
+// own position, rotation, scale and colour and data/quad.vs.glsl does the
+// rotating, so the cpu only writes 16 bytes per quad. instances are streamed
+// through a StreamBuffer so rewriting them never waits on the last frames
+struct QuadBatch {
+    QuadBatch(size_t initialCapacity = 1024);
+    ~QuadBatch();
+
+    QuadBatch(const QuadBatch&) = delete;
+    QuadBatch& operator=(const QuadBatch&) = delete;
+
+    // map room for `count` instances, the previous instances are discarded.
+    // the span can be filled from any thread until unmap. an empty span
+    // means nothing was mapped and unmap must not be called
+    std::span<QuadInstance> map(size_t count);
+    void unmap();
+
+    // replace every instance with a copy of `instances`
+    void upload(std::span<const QuadInstance> instances);
+
+    size_t size() const { return numInstances; }
+    const StreamBuffer& stream() const { return instances; }
+
+    void bind();
+    void draw();
+
+private:
+    size_t numInstances = 0;
+    size_t numMapped = 0;
+    unsigned vao;
+    unsigned corners;
+    unsigned ebo;
+    StreamBuffer instances;
+};
@@ -0,0 +1,159 @@
+#include "renderthread.h"
+
+#include "allocator.h"
+#include "profile.h"
+
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+    constexpr size_t kBlockSize = 64 * 1024;
+}
+
+// command buffer
+
+void *CommandBuffer::allocate(size_t size, size_t align) {
+    for (;; current++) {
+        if (current == blocks.size()) {
+            size_t blockSize = std::max(kBlockSize, size + align);
+            blocks.push_back({ std::make_unique<std::byte[]>(blockSize), blockSize, 0 });
+        }
+
+        auto& block = blocks[current];
+        auto base = reinterpret_cast<uintptr_t>(block.data.get());
+        size_t offset = ((base + block.used + align - 1) & ~uintptr_t(align - 1)) - base;
+        if (offset + size <= block.size) {
+            block.used = offset + size;
+            return block.data.get() + offset;
+        }
+    }
+}
+
+void CommandBuffer::execute() {
+    for (const auto& command : commands) {
+        command.run(command.object);
+    }
+    clear();
+}
+
+void CommandBuffer::clear() {
+    for (const auto& command : commands) {
+        command.destroy(command.object);
+    }
+    commands.clear();
+
+    for (auto& block : blocks) {
+        block.used = 0;
+    }
+    current = 0;
+}
+
+// draw data snapshot
+
+DrawDataSnapshot::DrawDataSnapshot()
+    : data(std::make_unique<ImDrawData>())
+{ }
+
+DrawDataSnapshot::~DrawDataSnapshot() {
+    clear();
+}
+
+void DrawDataSnapshot::capture(const ImDrawData& source) {
+    clear();
+
+    AllocTagScope tag(AllocTag::eDrawLists);
+
+    *data = source;
+    for (auto& list : data->CmdLists) {
+        list = list->CloneOutput();
+    }
+}
+
+void DrawDataSnapshot::clear() {
+    for (ImDrawList *list : data->CmdLists) {
+        IM_DELETE(list);
+    }
+    data->Clear();
+}
+
+// render thread
+
+RenderThread::RenderThread(std::function<void(bool)> makeCurrent, bool threaded)
+    : makeCurrent(std::move(makeCurrent))
+{
+    if (!threaded) { return; }
+
+    this->makeCurrent(false);
+    worker = std::thread([this] { run(); });
+}
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+void RenderThread::wait() {
+    std::unique_lock guard(lock);
+    changed.wait(guard, [this] { return pending == nullptr && !busy; });
+}
+
+void RenderThread::submit() {
+    if (!threaded()) {
+        buffers[recording].execute();
+        recording ^= 1;
+        return;
+    }
+
+    wait();
+
+    {
+        std::lock_guard guard(lock);
+        pending = &buffers[recording];
+    }
+    changed.notify_all();
+
+    recording ^= 1;
+}
+
+void RenderThread::stop() {
+    if (!threaded()) { return; }
+
+    wait();
+
+    {
+        std::lock_guard guard(lock);
+        stopping = true;
+    }
+    changed.notify_all();
+
+    worker.join();
+    makeCurrent(true);
+}
+
+void RenderThread::run() {
+    profileNameThread("Render");
+    makeCurrent(true);
+
+    for (;;) {
+        CommandBuffer *frame = nullptr;
+        {
+            std::unique_lock guard(lock);
+            changed.wait(guard, [this] { return pending != nullptr || stopping; });
+            if (pending == nullptr) { break; }
+
+            frame = std::exchange(pending, nullptr);
+            busy = true;
+        }
+
+        frame->execute();
+
+        {
+            std::lock_guard guard(lock);
+            busy = false;
+        }
+        changed.notify_all();
+    }
+
+    makeCurrent(false);
+}
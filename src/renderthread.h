@@ -0,0 +1,135 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+struct ImDrawData;
+
+// commands recorded on one thread to run later on another. each command is
+// a closure placed back to back in blocks that are kept between frames, so
+// once the blocks are big enough recording a frame doesnt allocate
+struct CommandBuffer {
+    CommandBuffer() = default;
+    ~CommandBuffer() { clear(); }
+
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+    template<typename F>
+    void record(F&& fn) {
+        using T = std::decay_t<F>;
+        void *object = allocate(sizeof(T), alignof(T));
+        new (object) T(std::forward<F>(fn));
+
+        commands.push_back({
+            object,
+            [](void *it) { (*static_cast<T*>(it))(); },
+            [](void *it) { static_cast<T*>(it)->~T(); }
+        });
+    }
+
+    // run every command in the order recorded, then forget them
+    void execute();
+
+    // forget every command without running it
+    void clear();
+
+    size_t size() const { return commands.size(); }
+
+private:
+    struct Command {
+        void *object;
+        void (*run)(void*);
+        void (*destroy)(void*);
+    };
+
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+        size_t used;
+    };
+
+    void *allocate(size_t size, size_t align);
+
+    std::vector<Command> commands;
+    std::vector<Block> blocks;
+    size_t current = 0;
+};
+
+// a copy of imgui's draw data that stays valid after the next NewFrame, for
+// rendering on another thread. the lists are cloned with
+// ImDrawList::CloneOutput and freed on the thread that took the snapshot,
+// imgui's allocator counts allocations on the context without a lock
+struct DrawDataSnapshot {
+    DrawDataSnapshot();
+    ~DrawDataSnapshot();
+
+    DrawDataSnapshot(const DrawDataSnapshot&) = delete;
+    DrawDataSnapshot& operator=(const DrawDataSnapshot&) = delete;
+
+    void capture(const ImDrawData& data);
+    void clear();
+
+    ImDrawData *get() { return data.get(); }
+
+private:
+    std::unique_ptr<ImDrawData> data;
+};
+
+// a thread that owns the gl context and runs recorded frames. the main thread
+// records frame n while frame n - 1 executes, so the two overlap and a
+// blocking swap only holds up the render thread. with `threaded` off frames
+// run on the calling thread as soon as they are submitted
+struct RenderThread {
+    // `makeCurrent(true)` makes the context current on the calling thread and
+    // `makeCurrent(false)` releases it. the context must be current when this
+    // is called, it moves to the render thread until stop
+    RenderThread(std::function<void(bool)> makeCurrent, bool threaded = true);
+    ~RenderThread();
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // the frame being recorded
+    CommandBuffer& commands() { return buffers[recording]; }
+
+    // hand the recorded frame to the render thread. waits for the frame before
+    // it to finish first, so once this returns the commands of that frame have
+    // all run and anything they referenced is free to change
+    void submit();
+
+    // frame data that commands point at rather than copy goes in one of two
+    // slots, the slot of a frame is only reused two submits later
+    size_t slot() const { return recording; }
+
+    // wait for every submitted frame, then stop the thread and make the
+    // context current on the calling thread again
+    void stop();
+
+    bool threaded() const { return worker.joinable(); }
+
+private:
+    void run();
+    void wait();
+
+    std::function<void(bool)> makeCurrent;
+
+    CommandBuffer buffers[2];
+    size_t recording = 0;
+
+    std::mutex lock;
+    std::condition_variable changed;
+    CommandBuffer *pending = nullptr;
+    bool busy = false;
+    bool stopping = false;
+
+    std::thread worker;
+};
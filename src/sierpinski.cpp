@@ -0,0 +1,112 @@
+#include "sierpinski.h"
+
+#include "archive.h"
+#include "chaos.h"
+#include "program.h"
+
+#include "glad/glad.h"
+
+#include <array>
+
+namespace {
+    // a float mantissa is used up after ~24 halvings, anything past that
+    // doesnt move the point any more
+    constexpr int kGpuIterations = 32;
+
+    constexpr auto kFeedbackVaryings = std::to_array<const char*>({ "outPosition", "outColour" });
+}
+
+Sierpinski::Sierpinski(bool blending, unsigned seed)
+    : seed(seed)
+    , blending(blending)
+{
+    restart();
+}
+
+void Sierpinski::restart() {
+    rng.seed(seed);
+    last = kSierpinskiCorners.back();
+
+    points.clear();
+    points.append(kSierpinskiCorners);
+}
+
+Vertex2 Sierpinski::next() {
+    std::uniform_int_distribution<size_t> dist(0, kSierpinskiCorners.size() - 1);
+    last = sierpinskiStep(kSierpinskiCorners[dist(rng)], last, blending);
+    return last;
+}
+
+void Sierpinski::setSteps(size_t newSteps) {
+    steps = newSteps;
+
+    size_t required = kSierpinskiCorners.size() + steps;
+    if (required <= points.size()) { return; }
+
+    scratch.resize(required - points.size());
+    for (auto& point : scratch) {
+        point = next();
+    }
+
+    points.append(scratch);
+}
+
+void Sierpinski::setBlending(bool newBlending) {
+    if (blending == newBlending) { return; }
+
+    blending = newBlending;
+    restart();
+    setSteps(steps);
+}
+
+void Sierpinski::draw() {
+    points.bind();
+    points.draw(kSierpinskiCorners.size() + steps);
+}
+
+// gpu sierpinski
+
+GpuSierpinski::GpuSierpinski() {
+    auto vs = loadAsset("data/chaos.vs.glsl");
+    program = createFeedbackShader(vs.data(), kFeedbackVaryings);
+
+    seedUniform = glGetUniformLocation(program, "seed");
+    iterationsUniform = glGetUniformLocation(program, "iterations");
+    blendingUniform = glGetUniformLocation(program, "blending");
+
+    // the walkers have no inputs but core profile still wants a vao bound
+    glGenVertexArrays(1, &vao);
+}
+
+GpuSierpinski::~GpuSierpinski() {
+    glDeleteVertexArrays(1, &vao);
+    glDeleteProgram(program);
+}
+
+void GpuSierpinski::generate(size_t count, unsigned seed, bool blending) {
+    // nothing worth keeping, clear first so growing doesnt copy old points
+    points.clear();
+    points.resize(count);
+
+    glUseProgram(program);
+    glUniform1ui(seedUniform, seed);
+    glUniform1i(iterationsUniform, kGpuIterations);
+    glUniform1i(blendingUniform, blending);
+
+    glBindVertexArray(vao);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, points.buffer());
+
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, GLsizei(count));
+    glEndTransformFeedback();
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glBindVertexArray(0);
+}
+
+void GpuSierpinski::draw() {
+    points.bind();
+    points.draw(points.size());
+}
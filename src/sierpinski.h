@@ -0,0 +1,63 @@
+#pragma once
+
+#include "mesh.h"
+
+#include <random>
+#include <vector>
+
+// incremental chaos game generator. keeps its rng and last point between
+// calls so raising the step count only generates the new points, and lowering
+// it only changes how many of the already uploaded points get drawn
+struct Sierpinski {
+    Sierpinski(bool blending, unsigned seed = 0);
+
+    // make `steps` points visible, generating only the ones we dont have yet
+    void setSteps(size_t steps);
+
+    // changing the colouring invalidates every point, so this starts over
+    // from the same seed
+    void setBlending(bool blending);
+
+    size_t generated() const { return points.size(); }
+
+    void draw();
+
+private:
+    void restart();
+    Vertex2 next();
+
+    unsigned seed;
+    bool blending;
+    size_t steps = 0;
+
+    std::minstd_rand rng;
+    Vertex2 last;
+
+    std::vector<Vertex2> scratch;
+    PointBuffer points;
+};
+
+// generates the triangle entirely on the gpu. every point is its own walker
+// in data/chaos.vs.glsl and the results are captured with transform feedback
+// straight into the point buffer, so nothing is uploaded from the cpu
+struct GpuSierpinski {
+    GpuSierpinski();
+    ~GpuSierpinski();
+
+    GpuSierpinski(const GpuSierpinski&) = delete;
+    GpuSierpinski& operator=(const GpuSierpinski&) = delete;
+
+    void generate(size_t count, unsigned seed, bool blending);
+
+    void draw();
+
+private:
+    unsigned program;
+    unsigned vao;
+
+    int seedUniform;
+    int iterationsUniform;
+    int blendingUniform;
+
+    PointBuffer points;
+};
@@ -0,0 +1,145 @@
+#include "stream.h"
+
+#include "glad/glad.h"
+
+#include <algorithm>
+
+namespace {
+    constexpr GLbitfield kPersistentFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    // glBufferStorage is only loaded when the context is 4.4 or newer
+    bool hasBufferStorage() {
+        return GLAD_GL_VERSION_4_4 && glBufferStorage != nullptr;
+    }
+}
+
+StreamBuffer::StreamBuffer(size_t regionBytes, StreamMode requested)
+    : mode(requested)
+{
+    if (mode == StreamMode::eAuto || (mode == StreamMode::ePersistent && !hasBufferStorage())) {
+        mode = hasBufferStorage() ? StreamMode::ePersistent : StreamMode::eUnsynchronized;
+    }
+
+    allocate(std::max<size_t>(regionBytes, 1));
+}
+
+StreamBuffer::~StreamBuffer() {
+    release();
+}
+
+void StreamBuffer::allocate(size_t regionBytes) {
+    release();
+
+    numRegionBytes = regionBytes;
+    next = 0;
+
+    auto size = GLsizeiptr(numRegionBytes * kStreamRegions);
+
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if (mode == StreamMode::ePersistent) {
+        glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, kPersistentFlags);
+        mapped = static_cast<std::byte*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, kPersistentFlags));
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    }
+}
+
+void StreamBuffer::release() {
+    for (auto& fence : fences) {
+        glDeleteSync(GLsync(fence));
+        fence = nullptr;
+    }
+
+    // gl keeps the storage alive until draws already queued are done with it
+    if (mapped != nullptr) {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        mapped = nullptr;
+    }
+
+    glDeleteBuffers(1, &vbo);
+    vbo = 0;
+}
+
+void StreamBuffer::wait(size_t region) {
+    auto fence = GLsync(fences[region]);
+    if (fence == nullptr) { return; }
+
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        numStalls += 1;
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000);
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+
+    glDeleteSync(fence);
+    fences[region] = nullptr;
+}
+
+std::span<std::byte> StreamBuffer::map(size_t bytes) {
+    written = 0;
+    if (bytes == 0) { return {}; }
+
+    if (bytes > numRegionBytes) {
+        size_t regionBytes = numRegionBytes;
+        while (regionBytes < bytes) {
+            regionBytes *= 2;
+        }
+        allocate(regionBytes);
+    }
+
+    size_t region = next;
+    regionOffset = region * numRegionBytes;
+
+    if (mode == StreamMode::ePersistent) {
+        if (mapped == nullptr) { return {}; }
+
+        wait(region);
+        written = bytes;
+        return { mapped + regionOffset, bytes };
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // rather than wait for the gpu, hand the old storage back to the driver
+    // and start over in fresh storage that nothing is reading
+    auto fence = GLsync(fences[region]);
+    if (fence != nullptr && glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        numOrphans += 1;
+        for (auto& other : fences) {
+            glDeleteSync(GLsync(other));
+            other = nullptr;
+        }
+        glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(numRegionBytes * kStreamRegions), nullptr, GL_STREAM_DRAW);
+    } else if (fence != nullptr) {
+        glDeleteSync(fence);
+        fences[region] = nullptr;
+    }
+
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    void *data = glMapBufferRange(GL_ARRAY_BUFFER, GLintptr(regionOffset), GLsizeiptr(bytes), access);
+    if (data == nullptr) { return {}; }
+
+    written = bytes;
+    return { static_cast<std::byte*>(data), bytes };
+}
+
+bool StreamBuffer::unmap() {
+    next = (next + 1) % kStreamRegions;
+
+    // coherent mappings need no flushing
+    if (mode == StreamMode::ePersistent) { return written > 0; }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    return glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE && written > 0;
+}
+
+void StreamBuffer::fence() {
+    size_t region = regionOffset / numRegionBytes;
+
+    // a later draw from the same region replaces the fence of an earlier one
+    glDeleteSync(GLsync(fences[region]));
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+// how a StreamBuffer gets what the cpu writes to gl
+enum class StreamMode {
+    // persistent when the context has buffer storage, unsynchronized otherwise
+    eAuto,
+
+    // mapped once for the life of the buffer, needs gl 4.4
+    ePersistent,
+
+    // each region mapped unsynchronized on its own, the whole buffer is
+    // orphaned rather than waited on when the region is still being read
+    eUnsynchronized
+};
+
+constexpr size_t kStreamRegions = 3;
+
+// a buffer for data that is rewritten every frame. it is split into
+// kStreamRegions regions written round robin, each guarded by a fence placed
+// after the last draw that reads it, so the cpu only waits when it gets that
+// many frames ahead of the gpu and writing is a plain memcpy
+struct StreamBuffer {
+    StreamBuffer(size_t regionBytes = 1 << 16, StreamMode mode = StreamMode::eAuto);
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // the next region, with room for at least `bytes`. it can be written from
+    // any thread until unmap. an empty span means nothing was mapped and
+    // unmap must not be called
+    std::span<std::byte> map(size_t bytes);
+
+    // hand the region to gl, false if the platform lost its contents
+    bool unmap();
+
+    // call after the draws that read the last region unmapped
+    void fence();
+
+    // where the last region unmapped starts in buffer()
+    size_t offset() const { return regionOffset; }
+
+    // changes when the regions have to grow, anything pointing at the
+    // old buffer needs pointing at the new one
+    unsigned buffer() const { return vbo; }
+
+    size_t regionBytes() const { return numRegionBytes; }
+    bool persistent() const { return mode == StreamMode::ePersistent; }
+
+    // how often map waited on the gpu, and how often the buffer was orphaned instead
+    size_t stalls() const { return numStalls; }
+    size_t orphans() const { return numOrphans; }
+
+private:
+    void allocate(size_t regionBytes);
+    void release();
+    void wait(size_t region);
+
+    StreamMode mode;
+    size_t numRegionBytes = 0;
+    size_t next = 0;
+    size_t written = 0;
+    size_t regionOffset = 0;
+
+    size_t numStalls = 0;
+    size_t numOrphans = 0;
+
+    unsigned vbo = 0;
+    std::byte *mapped = nullptr;
+
+    // GLsync, kept opaque so gl stays out of the header
+    void *fences[kStreamRegions] = {};
+};
@@ -0,0 +1,51 @@
+#include "texture.h"
+
+#include "glad/glad.h"
+
+namespace {
+    struct FormatInfo {
+        GLint internal;
+        GLenum format;
+        GLenum type;
+        GLint alignment;
+    };
+
+    FormatInfo formatInfo(TextureFormat format) {
+        switch (format) {
+        case TextureFormat::eR8: return { GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1 };
+        case TextureFormat::eR16: return { GL_R16, GL_RED, GL_UNSIGNED_SHORT, 2 };
+        case TextureFormat::eRgba8: return { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 };
+        }
+
+        return { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 };
+    }
+}
+
+unsigned createTexture(unsigned width, unsigned height, TextureFormat format, const void *data) {
+    auto info = formatInfo(format);
+
+    unsigned texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    // rows of single channel textures arent 4 byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, info.alignment);
+    glTexImage2D(GL_TEXTURE_2D, 0, info.internal, GLsizei(width), GLsizei(height), 0, info.format, info.type, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    return texture;
+}
+
+void updateTexture(unsigned texture, unsigned width, unsigned height, TextureFormat format, const void *data) {
+    auto info = formatInfo(format);
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, info.alignment);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, GLsizei(width), GLsizei(height), info.format, info.type, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
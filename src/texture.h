@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+enum class TextureFormat {
+    eR8,
+    eR16,
+    eRgba8
+};
+
+// a 2d texture with linear filtering and repeat wrapping
+unsigned createTexture(unsigned width, unsigned height, TextureFormat format, const void *data);
+
+// replace the whole contents of a texture made by createTexture
+void updateTexture(unsigned texture, unsigned width, unsigned height, TextureFormat format, const void *data);
@@ -0,0 +1,208 @@
+#include "tlsf.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+
+// every block starts with a header that stays put, free blocks also keep
+// their list links in what would be the payload
+struct TlsfHeap::Block {
+    // the block just before this one in its pool, nullptr for the first
+    Block *prevPhys;
+
+    // the whole block including the header, the low bit is set while free
+    size_t size;
+
+    Block *nextFree;
+    Block *prevFree;
+};
+
+namespace {
+    constexpr size_t kHeader = 16;
+    constexpr size_t kMinBlock = 32;
+    constexpr size_t kFree = 1;
+
+    constexpr size_t roundUp(size_t size, size_t align) {
+        return (size + align - 1) & ~(align - 1);
+    }
+
+    template<typename Block>
+    size_t sizeOf(const Block *block) {
+        return block->size & ~(size_t(15));
+    }
+
+    template<typename Block>
+    Block *nextPhys(Block *block) {
+        return reinterpret_cast<Block*>(reinterpret_cast<std::byte*>(block) + sizeOf(block));
+    }
+
+    // which list a free block of `size` lives in
+    template<unsigned kSlLog2, unsigned kFlShift>
+    void mapping(size_t size, unsigned& fl, unsigned& sl) {
+        if (size < (size_t(1) << kFlShift)) {
+            fl = 0;
+            sl = unsigned(size >> (kFlShift - kSlLog2));
+            return;
+        }
+
+        unsigned top = unsigned(std::bit_width(size)) - 1;
+        sl = unsigned(size >> (top - kSlLog2)) ^ (1u << kSlLog2);
+        fl = top - kFlShift + 1;
+    }
+}
+
+TlsfHeap::TlsfHeap(size_t poolSize)
+    : poolSize(poolSize)
+{
+    static_assert(sizeof(Block) == kMinBlock);
+}
+
+TlsfHeap::~TlsfHeap() {
+    for (void *pool : pools) {
+        std::free(pool);
+    }
+}
+
+TlsfHeap::Block *TlsfHeap::addPool(size_t size) {
+    // room for a zero sized block at the end that is never free, so merging
+    // never walks off the pool
+    size_t bytes = roundUp(size + kHeader, 4096);
+    void *memory = std::aligned_alloc(16, bytes);
+    if (memory == nullptr) { return nullptr; }
+
+    pools.push_back(memory);
+    numReserved += bytes;
+
+    auto *block = static_cast<Block*>(memory);
+    block->prevPhys = nullptr;
+    block->size = (bytes - kHeader) | kFree;
+
+    Block *sentinel = nextPhys(block);
+    sentinel->prevPhys = block;
+    sentinel->size = 0;
+
+    return block;
+}
+
+void TlsfHeap::insert(Block *block) {
+    unsigned fl, sl;
+    mapping<kSlLog2, kFlShift>(sizeOf(block), fl, sl);
+
+    Block *&head = heads[fl][sl];
+    block->prevFree = nullptr;
+    block->nextFree = head;
+    if (head != nullptr) {
+        head->prevFree = block;
+    }
+    head = block;
+
+    flBitmap |= uint64_t(1) << fl;
+    slBitmaps[fl] |= 1u << sl;
+}
+
+void TlsfHeap::remove(Block *block) {
+    unsigned fl, sl;
+    mapping<kSlLog2, kFlShift>(sizeOf(block), fl, sl);
+
+    if (block->prevFree != nullptr) {
+        block->prevFree->nextFree = block->nextFree;
+    } else {
+        heads[fl][sl] = block->nextFree;
+    }
+    if (block->nextFree != nullptr) {
+        block->nextFree->prevFree = block->prevFree;
+    }
+
+    if (heads[fl][sl] == nullptr) {
+        slBitmaps[fl] &= ~(1u << sl);
+        if (slBitmaps[fl] == 0) {
+            flBitmap &= ~(uint64_t(1) << fl);
+        }
+    }
+}
+
+TlsfHeap::Block *TlsfHeap::findFree(size_t size) {
+    // round up to the next list so any block in it is big enough
+    if (size >= (size_t(1) << kFlShift)) {
+        size += (size_t(1) << (std::bit_width(size) - 1 - kSlLog2)) - 1;
+    }
+
+    unsigned fl, sl;
+    mapping<kSlLog2, kFlShift>(size, fl, sl);
+    if (fl >= kFlCount) { return nullptr; }
+
+    uint32_t slMap = slBitmaps[fl] & (~0u << sl);
+    if (slMap == 0) {
+        uint64_t flMap = fl + 1 < 64 ? flBitmap & (~uint64_t(0) << (fl + 1)) : 0;
+        if (flMap == 0) { return nullptr; }
+
+        fl = unsigned(std::countr_zero(flMap));
+        slMap = slBitmaps[fl];
+    }
+
+    return heads[fl][std::countr_zero(slMap)];
+}
+
+void *TlsfHeap::allocate(size_t size) {
+    size_t need = std::max(roundUp(size + kHeader, 16), kMinBlock);
+
+    Block *block = findFree(need);
+    if (block != nullptr) {
+        remove(block);
+    } else {
+        block = addPool(std::max(poolSize, need));
+        if (block == nullptr) { return nullptr; }
+    }
+
+    // give back whatever is left over when it is big enough to be a block
+    size_t blockSize = sizeOf(block);
+    if (blockSize - need >= kMinBlock) {
+        auto *rest = reinterpret_cast<Block*>(reinterpret_cast<std::byte*>(block) + need);
+        rest->prevPhys = block;
+        rest->size = (blockSize - need) | kFree;
+        nextPhys(rest)->prevPhys = rest;
+        insert(rest);
+        blockSize = need;
+    }
+
+    block->size = blockSize;
+    numUsed += blockSize;
+    return reinterpret_cast<std::byte*>(block) + kHeader;
+}
+
+void TlsfHeap::free(void *ptr) {
+    if (ptr == nullptr) { return; }
+
+    auto *block = reinterpret_cast<Block*>(static_cast<std::byte*>(ptr) - kHeader);
+    numUsed -= sizeOf(block);
+
+    Block *prev = block->prevPhys;
+    if (prev != nullptr && (prev->size & kFree) != 0) {
+        remove(prev);
+        prev->size = sizeOf(prev) + sizeOf(block);
+        block = prev;
+    }
+
+    Block *next = nextPhys(block);
+    if ((next->size & kFree) != 0) {
+        remove(next);
+        block->size = sizeOf(block) + sizeOf(next);
+    }
+
+    block->size |= kFree;
+    nextPhys(block)->prevPhys = block;
+    insert(block);
+}
+
+size_t TlsfHeap::largestFree() const {
+    if (flBitmap == 0) { return 0; }
+
+    unsigned fl = unsigned(std::bit_width(flBitmap)) - 1;
+    unsigned sl = unsigned(std::bit_width(slBitmaps[fl])) - 1;
+
+    size_t largest = 0;
+    for (Block *it = heads[fl][sl]; it != nullptr; it = it->nextFree) {
+        largest = std::max(largest, sizeOf(it));
+    }
+    return largest - kHeader;
+}
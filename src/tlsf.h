@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// two level segregated fit heap. free blocks are kept in lists indexed by
+// the top bit of their size and the next four bits below it, with a bitmap
+// per level, so finding a block that fits and freeing one (merging it with
+// free neighbours) are both a handful of bit operations whatever the heap
+// size. memory comes from the system in pools that are kept until the heap
+// goes away. not thread safe
+struct TlsfHeap {
+    TlsfHeap(size_t poolSize = size_t(1) << 20);
+    ~TlsfHeap();
+
+    TlsfHeap(const TlsfHeap&) = delete;
+    TlsfHeap& operator=(const TlsfHeap&) = delete;
+
+    // 16 byte aligned, nullptr only when the system is out of memory
+    void *allocate(size_t size);
+    void free(void *ptr);
+
+    // bytes taken from the system, and how many of them are in live blocks
+    // including their headers
+    size_t reserved() const { return numReserved; }
+    size_t used() const { return numUsed; }
+
+    // the biggest block that could be handed out without a new pool
+    size_t largestFree() const;
+
+private:
+    struct Block;
+
+    static constexpr unsigned kSlLog2 = 4;
+    static constexpr unsigned kSlCount = 1 << kSlLog2;
+    static constexpr unsigned kAlignLog2 = 4;
+    static constexpr unsigned kFlShift = kSlLog2 + kAlignLog2;
+    static constexpr unsigned kFlCount = 40;
+
+    Block *addPool(size_t size);
+    void insert(Block *block);
+    void remove(Block *block);
+    Block *findFree(size_t size);
+
+    size_t poolSize;
+    size_t numReserved = 0;
+    size_t numUsed = 0;
+
+    uint64_t flBitmap = 0;
+    uint32_t slBitmaps[kFlCount] = {};
+    Block *heads[kFlCount][kSlCount] = {};
+
+    std::vector<void*> pools;
+};
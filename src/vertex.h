@@ -0,0 +1,251 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// vertex formats and the compile time layouts that describe them to gl
+
+struct Vec3 {
+    float x, y, z;
+};
+
+struct Vec2 {
+    float u, v;
+};
+
+struct Point2 {
+    float x, y;
+};
+
+struct Bounds2 {
+    float minX, minY;
+    float maxX, maxY;
+
+    constexpr bool intersects(const Bounds2& other) const {
+        return minX <= other.maxX && other.minX <= maxX
+            && minY <= other.maxY && other.minY <= maxY;
+    }
+};
+
+struct Colour {
+    float r, g, b;
+};
+
+struct Vertex {
+    Vec3 position;
+    Vec2 texcoord;
+    Colour colour;
+};
+
+struct Vertex2 {
+    Vec3 position;
+    Colour colour;
+};
+
+// packed components
+
+struct Snorm16x2 {
+    int16_t x, y;
+};
+
+struct Rgba8 {
+    uint8_t r, g, b, a;
+};
+
+struct Half2 {
+    uint16_t u, v;
+};
+
+// 2d point with a packed colour, 8 bytes rather than the 24 of Vertex2
+struct PointVertex {
+    Snorm16x2 position;
+    Rgba8 colour;
+};
+
+// 2d point whose colour is looked up from a palette uniform, see data/palette.vs.glsl
+struct PaletteVertex {
+    Snorm16x2 position;
+    uint16_t index;
+};
+
+// Vertex with half float uvs and a packed colour, 20 bytes rather than 32
+struct PackedVertex {
+    Vec3 position;
+    Half2 texcoord;
+    Rgba8 colour;
+};
+
+// per instance data for QuadBatch, 16 bytes
+struct QuadInstance {
+    Point2 position;
+
+    // fraction of a full turn, unorm16
+    uint16_t rotation;
+
+    // half float, the quad spans [-scale, scale] before rotating
+    uint16_t scale;
+
+    Rgba8 colour;
+};
+
+// layout description
+
+enum class AttribType {
+    eFloat,
+    eHalf,
+    eShort,
+    eUnsignedByte,
+    eUnsignedShort
+};
+
+struct VertexAttrib {
+    unsigned location;
+    int components;
+    AttribType type;
+    size_t offset;
+
+    // map integer types onto [-1, 1] or [0, 1]
+    bool normalized = false;
+
+    // read as an integer in the shader rather than converted to float
+    bool integer = false;
+
+    // advance once every `divisor` instances rather than once per vertex
+    unsigned divisor = 0;
+};
+
+struct VertexLayout {
+    size_t stride;
+    std::span<const VertexAttrib> attribs;
+};
+
+// specialise with a `static constexpr std::array<VertexAttrib, N> kAttribs`
+// to make a vertex type usable by Mesh and PointBuffer
+template<typename T>
+struct VertexFormat;
+
+template<typename T>
+constexpr VertexLayout kVertexLayout = { sizeof(T), VertexFormat<T>::kAttribs };
+
+// locations match data/perlin.vs.glsl
+template<>
+struct VertexFormat<Vertex> {
+    static constexpr auto kAttribs = std::to_array<VertexAttrib>({
+        { 0, 3, AttribType::eFloat, offsetof(Vertex, position) },
+        { 1, 2, AttribType::eFloat, offsetof(Vertex, texcoord) },
+        { 2, 3, AttribType::eFloat, offsetof(Vertex, colour) }
+    });
+};
+
+template<>
+struct VertexFormat<PackedVertex> {
+    static constexpr auto kAttribs = std::to_array<VertexAttrib>({
+        { 0, 3, AttribType::eFloat, offsetof(PackedVertex, position) },
+        { 1, 2, AttribType::eHalf, offsetof(PackedVertex, texcoord) },
+        { 2, 4, AttribType::eUnsignedByte, offsetof(PackedVertex, colour), true }
+    });
+};
+
+// locations match data/square.vs.glsl
+template<>
+struct VertexFormat<Vertex2> {
+    static constexpr auto kAttribs = std::to_array<VertexAttrib>({
+        { 0, 3, AttribType::eFloat, offsetof(Vertex2, position) },
+        { 1, 3, AttribType::eFloat, offsetof(Vertex2, colour) }
+    });
+};
+
+// z is left out and defaults to 0 in the shader
+template<>
+struct VertexFormat<PointVertex> {
+    static constexpr auto kAttribs = std::to_array<VertexAttrib>({
+        { 0, 2, AttribType::eShort, offsetof(PointVertex, position), true },
+        { 1, 4, AttribType::eUnsignedByte, offsetof(PointVertex, colour), true }
+    });
+};
+
+// locations match data/palette.vs.glsl
+template<>
+struct VertexFormat<PaletteVertex> {
+    static constexpr auto kAttribs = std::to_array<VertexAttrib>({
+        { 0, 2, AttribType::eShort, offsetof(PaletteVertex, position), true },
+        { 1, 1, AttribType::eUnsignedShort, offsetof(PaletteVertex, index), false, true }
+    });
+};
+
+// locations match data/quad.vs.glsl, the corners come from a separate
+// buffer at location 0
+template<>
+struct VertexFormat<QuadInstance> {
+    static constexpr auto kAttribs = std::to_array<VertexAttrib>({
+        { 1, 2, AttribType::eFloat, offsetof(QuadInstance, position), false, false, 1 },
+        { 2, 1, AttribType::eUnsignedShort, offsetof(QuadInstance, rotation), true, false, 1 },
+        { 3, 1, AttribType::eHalf, offsetof(QuadInstance, scale), false, false, 1 },
+        { 4, 4, AttribType::eUnsignedByte, offsetof(QuadInstance, colour), true, false, 1 }
+    });
+};
+
+// packing helpers
+
+constexpr int16_t packSnorm16(float value) {
+    float clamped = value < -1.f ? -1.f : value > 1.f ? 1.f : value;
+    return int16_t(clamped * 32767.f + (clamped < 0.f ? -0.5f : 0.5f));
+}
+
+constexpr uint8_t packUnorm8(float value) {
+    float clamped = value < 0.f ? 0.f : value > 1.f ? 1.f : value;
+    return uint8_t(clamped * 255.f + 0.5f);
+}
+
+constexpr uint16_t packUnorm16(float value) {
+    float clamped = value < 0.f ? 0.f : value > 1.f ? 1.f : value;
+    return uint16_t(clamped * 65535.f + 0.5f);
+}
+
+// round to nearest even float to half conversion, flushes half denormals to zero
+constexpr uint16_t packHalf(float value) {
+    uint32_t bits = std::bit_cast<uint32_t>(value);
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = int32_t((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    // nan stays nan, inf and overflow become inf
+    if (((bits >> 23) & 0xff) == 0xff) {
+        return uint16_t(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    }
+    if (exponent >= 31) {
+        return uint16_t(sign | 0x7c00);
+    }
+    if (exponent <= 0) {
+        return uint16_t(sign);
+    }
+
+    uint32_t half = sign | (uint32_t(exponent) << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+        half++;
+    }
+    return uint16_t(half);
+}
+
+constexpr Rgba8 packColour(const Colour& colour) {
+    return { packUnorm8(colour.r), packUnorm8(colour.g), packUnorm8(colour.b), 255 };
+}
+
+constexpr PointVertex packPoint(const Vertex2& vertex) {
+    return {
+        { packSnorm16(vertex.position.x), packSnorm16(vertex.position.y) },
+        packColour(vertex.colour)
+    };
+}
+
+constexpr PackedVertex packVertex(const Vertex& vertex) {
+    return {
+        vertex.position,
+        { packHalf(vertex.texcoord.u), packHalf(vertex.texcoord.v) },
+        packColour(vertex.colour)
+    };
+}
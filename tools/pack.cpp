@@ -0,0 +1,110 @@
+#include "archive.h"
+#include "hash.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// packs files into an archive for Archive to map at runtime
+// usage: pack <output> <root> <files...>
+// names are stored relative to <root> with forward slashes
+
+namespace fs = std::filesystem;
+
+namespace {
+    struct Input {
+        std::string name;
+        std::vector<char> contents;
+    };
+
+    size_t alignUp(size_t value, size_t align) {
+        return (value + align - 1) / align * align;
+    }
+}
+
+int main(int argc, const char **argv) {
+    if (argc < 3) {
+        std::cout << "usage: " << argv[0] << " <output> <root> <files...>" << std::endl;
+        return 1;
+    }
+
+    fs::path root = fs::absolute(argv[2]);
+
+    std::vector<Input> inputs;
+    for (int i = 3; i < argc; i++) {
+        fs::path path = fs::absolute(argv[i]);
+
+        std::ifstream fd(path, std::ios::binary);
+        if (!fd.is_open()) {
+            std::cout << "Failed to open file: " << path.string() << std::endl;
+            return 1;
+        }
+
+        Input input = { fs::relative(path, root).generic_string(), {} };
+        input.contents.assign(std::istreambuf_iterator<char>(fd), {});
+        inputs.push_back(std::move(input));
+    }
+
+    // the reader binary searches the index
+    std::sort(inputs.begin(), inputs.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.name < rhs.name;
+    });
+
+    ArchiveHeader header = { kArchiveMagic, kArchiveVersion, uint32_t(inputs.size()), 0 };
+    std::vector<ArchiveEntry> entries(inputs.size());
+
+    size_t offset = sizeof(ArchiveHeader) + inputs.size() * sizeof(ArchiveEntry);
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+        entries[i].nameOffset = uint32_t(offset);
+        entries[i].nameLength = uint32_t(inputs[i].name.size());
+        offset += inputs[i].name.size();
+    }
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+        const auto& contents = inputs[i].contents;
+
+        offset = alignUp(offset, kArchiveAlign);
+        entries[i].offset = offset;
+        entries[i].size = contents.size();
+        entries[i].hash = fnv1a(std::as_bytes(std::span(contents)));
+
+        // plus the null terminator
+        offset += contents.size() + 1;
+    }
+
+    std::ofstream out(argv[1], std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cout << "Failed to open output: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)entries.data(), entries.size() * sizeof(ArchiveEntry));
+
+    for (const auto& input : inputs) {
+        out.write(input.name.data(), input.name.size());
+    }
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+        const auto& contents = inputs[i].contents;
+
+        // pad up to the aligned offset
+        size_t position = size_t(out.tellp());
+        std::string padding(entries[i].offset - position, '\0');
+        out.write(padding.data(), padding.size());
+
+        out.write(contents.data(), contents.size());
+        out.put('\0');
+    }
+
+    if (!out) {
+        std::cout << "Failed to write output: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    return 0;
+}